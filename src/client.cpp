@@ -1,41 +1,144 @@
 #include "client.h"
-#include <sstream>
+#include "headless/headlessFrontend.h"
+#include "metrics/metrics.h"
+#include "ui/ui.h"
+#include "util/displayText.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+std::unique_ptr<Frontend> createFrontend(const ClientOptions& options) {
+	if (options.headless) return std::make_unique<HeadlessFrontend>(options.output);
+
+	auto ui = std::make_unique<UI>();
+	ui->setFrameRate(options.frameRate);
+	ui->setInputHistory(options.inputHistoryFile);
+	return ui;
+}
+
+} // namespace
 
-Client::Client(const std::string& url)
-  : ui(std::make_unique<UI>())
+Client::Client(const ClientOptions& options)
+  : options(options)
   , commandProcessor(std::make_unique<CommandProcessor>())
-  , webSocketManager(std::make_unique<WebSocketManager>(url)) {
+  , ui(createFrontend(options))
+  , connectionPool(options.url, options.connection, options.warmConnections)
+  , activeSession(0)
+  , reportedDrops(0) {
 
 	// Initialize command handlers
 	initCommandHandlers();
 
-	// Set up WebSocket callbacks
-	webSocketManager->setMessageCallback([this](const json& msg) { processMessage(msg); });
-	webSocketManager->setStatusCallback([this](const std::string& status) { handleSystemEvent(status); });
+	if (!options.metricsFile.empty())
+		metricsExporter = std::make_unique<MetricsExporter>(options.metricsFile, options.metricsInterval);
 }
 
-Client::~Client() = default;
+Client::~Client() {
+	// Stop every network thread before the UI goes away
+	sessions.clear();
+}
 
 void Client::initCommandHandlers() {
-	commandProcessor->registerCommand("/join", [this](const std::string& args) {
-		std::istringstream iss(args);
-		std::string room, username;
-		iss >> room >> username;
+	commandProcessor->registerCommand("/join", [this](CommandArgs& args) {
+		std::string_view room, username = lastUsername;
+		args.next(room);
+		args.next(username);
 
 		if (room.empty() || username.empty()) {
 			ui->addSystemMessage("Usage: /join <room> <username>");
 			return;
 		}
 
-		joinRoom(room, username);
+		joinRoom(std::string(room), std::string(username));
+	});
+
+	commandProcessor->registerCommand("/leave", [this](CommandArgs&) { leaveRoom(); });
+
+	commandProcessor->registerCommand("/switch", [this](CommandArgs& args) {
+		std::string_view target;
+		if (!args.next(target)) {
+			ui->addSystemMessage("Usage: /switch <number|room|+1|-1>");
+			return;
+		}
+
+		size_t count = sessions.size();
+		if (target == "+1" || target == "-1") {
+			switchSession((activeSession + (target == "+1" ? 1 : count - 1)) % count);
+			return;
+		}
+
+		size_t number = 0;
+		CommandArgs(target).next(number);
+		for (size_t i = 0; i < count; ++i)
+			if (sessions[i]->getRoom() == target || number == i + 1) {
+				switchSession(i);
+				return;
+			}
+		ui->addSystemMessage("No such room tab: " + std::string(target));
+	});
+
+	commandProcessor->registerCommand("/rooms", [this](CommandArgs&) { requestRooms(); });
+
+	commandProcessor->registerCommand("/search", [this](CommandArgs& args) {
+		SearchIndex::Query query;
+		std::string error;
+		if (!SearchIndex::Query::parse(args.rest(), query, error)) {
+			ui->showStatus(error);
+			return;
+		}
+
+		uint64_t start = Metrics::nowNs();
+		std::vector<int64_t> ids = active().getHistory().search(query, searchResultLimit);
+		double elapsedMs = (Metrics::nowNs() - start) / 1e6;
+
+		if (ids.empty()) {
+			ui->showStatus("No matches for: " + std::string(args.rest()));
+			return;
+		}
+
+		char summary[64];
+		std::snprintf(summary, sizeof(summary), " (%zu%s in %.1f ms)", ids.size(),
+					  ids.size() == searchResultLimit ? "+" : "", elapsedMs);
+		ui->showSearchResults(ids, "Search: " + std::string(args.rest()) + summary);
 	});
 
-	commandProcessor->registerCommand("/rooms", [this](const std::string&) { requestRooms(); });
+	commandProcessor->registerCommand("/users", [this](CommandArgs& args) { ui->filterUsers(std::string(args.rest())); });
+
+	commandProcessor->registerCommand("/stats", [this](CommandArgs&) {
+		for (const std::string& line : Metrics::get().summary())
+			ui->addSystemMessage(line);
+
+		// Scrollback tiers, summed over all rooms
+		ChatHistory::Stats total;
+		for (auto& session : sessions) {
+			ChatHistory::Stats stats = session->getHistory().getStats();
+			total.hotLines += stats.hotLines;
+			total.hotBytes += stats.hotBytes;
+			total.coldLines += stats.coldLines;
+			total.coldBlocks += stats.coldBlocks;
+			total.coldBytes += stats.coldBytes;
+			total.coldRawBytes += stats.coldRawBytes;
+			total.droppedLines += stats.droppedLines;
+			total.archivedLines += stats.archivedLines;
+		}
+		ui->addSystemMessage("History: hot " + std::to_string(total.hotLines) + " lines (" +
+							 std::to_string(total.hotBytes / 1024) + " KiB), cold " + std::to_string(total.coldLines) +
+							 " lines in " + std::to_string(total.coldBlocks) + " blocks (" +
+							 std::to_string(total.coldBytes / 1024) + " KiB from " +
+							 std::to_string(total.coldRawBytes / 1024) + " KiB), dropped " +
+							 std::to_string(total.droppedLines) + ", from logs " + std::to_string(total.archivedLines));
+	});
 
-	commandProcessor->registerCommand("/help", [this](const std::string&) {
+	commandProcessor->registerCommand("/help", [this](CommandArgs&) {
 		ui->addSystemMessage("Available commands:");
-		ui->addSystemMessage("/join <room> <username> - Join a room");
+		ui->addSystemMessage("/join <room> [username] - Join a room (opens a new tab when already in one)");
+		ui->addSystemMessage("/leave - Leave the current room");
+		ui->addSystemMessage("/switch <number|room|+1|-1> - Show another room (also F1-F10, Ctrl+N, Ctrl+P)");
 		ui->addSystemMessage("/rooms - Show available rooms on the server");
+		ui->addSystemMessage("/search [from:user] [after:HH:MM|30m] [before:HH:MM|1h] <words> - Find lines in this room");
+		ui->addSystemMessage("/users [prefix] - Only list members starting with prefix (none: everyone)");
+		ui->addSystemMessage("/stats - Show network, parsing and drawing statistics");
 		ui->addSystemMessage("/exit - Exit the application");
 		ui->addSystemMessage("/help - Show this help");
 	});
@@ -44,19 +147,46 @@ void Client::initCommandHandlers() {
 void Client::run() {
 	// Initialize UI
 	ui->init();
+	ui->setCommands(commandProcessor->getCommands());
+	ui->setInputReady([this]() { return sendQueueReady(); });
 
-	// Connect to server
-	ui->showStatus("Connecting to server...");
-	if (!webSocketManager->connect()) {
-		ui->showStatus("Failed to connect");
-		std::this_thread::sleep_for(std::chrono::seconds(3));
-		return;
-	}
-
-	ui->showStatus("Connected! Please enter your username and room: /join <room> <username>");
+	// Connect in the background; the UI is usable (and queues messages) meanwhile
+	ui->showStatus("Connecting to server... Join a room with: /join <room> <username>");
+	switchSession(openSession());
 
 	// Main UI loop
-	ui->run([this](const std::string& input) { handleUserInput(input); });
+	ui->run([this](const std::string& input) { handleUserInput(input); }, [this]() { drainInbound(); },
+			inboundReady.fd());
+}
+
+void Client::drainInbound() {
+	// UI thread: apply everything the network threads queued since the last wakeup.
+	// Clear first so events pushed while draining trigger another wakeup.
+	inboundReady.clear();
+
+	uint64_t dropped = 0;
+	size_t depth = 0, highWater = 0, sendDepth = 0;
+	for (auto& session : sessions) {
+		depth += session->getQueueDepth();
+		session->drain();
+		dropped += session->getDroppedEvents();
+		highWater = std::max(highWater, session->getQueueHighWater());
+		sendDepth += session->getConnection().getSendStats().queueDepth;
+	}
+
+	Metrics& metrics = Metrics::get();
+	metrics.inboundQueueDepth.store(depth, std::memory_order_relaxed);
+	metrics.inboundQueueHighWater.store(highWater, std::memory_order_relaxed);
+	metrics.inboundDropped.store(dropped, std::memory_order_relaxed);
+	metrics.sendQueueDepth.store(sendDepth, std::memory_order_relaxed);
+
+	if (dropped > reportedDrops) {
+		RoomSession& session = active();
+		ui->showStatus("Inbound queue full: " + std::to_string(dropped) + " events dropped (high water " +
+					   std::to_string(session.getQueueHighWater()) + "/" +
+					   std::to_string(session.getQueueCapacity()) + ")");
+	}
+	reportedDrops = dropped;
 }
 
 void Client::handleUserInput(const std::string& input) {
@@ -67,112 +197,150 @@ void Client::handleUserInput(const std::string& input) {
 	}
 
 	// Regular message - send to current room
-	if (!currentRoom.empty() && !username.empty()) {
-		json msgJson;
-		msgJson["type"] = "sendMessage";
-		msgJson["data"] = input;
-		webSocketManager->sendMessage(msgJson);
+	if (!active().getRoom().empty()) {
+		reportSendResult(active().getConnection().sendMessage(OutboundMessage::chat(input)));
 	} else {
 		ui->addSystemMessage("You must join a room first: /join <room> <username>");
 	}
 }
 
+void Client::reportSendResult(WebSocketManager::SendResult result) {
+	WebSocketManager& connection = active().getConnection();
+
+	switch (result) {
+		case WebSocketManager::SendResult::Queued: break;
+		case WebSocketManager::SendResult::Backpressure:
+			ui->showStatus("Server is slow: " + std::to_string(connection.getSendStats().queueDepth) +
+						   " messages waiting to be sent");
+			break;
+		case WebSocketManager::SendResult::Rejected:
+			ui->addSystemMessage(connection.isConnected() ? "Send queue is full, message not sent"
+														  : "Offline and outbox is full, message not sent");
+			break;
+		case WebSocketManager::SendResult::Offline:
+			ui->showStatus("Offline: " + std::to_string(connection.getSendStats().queueDepth) +
+						   " messages will be sent after reconnecting");
+			break;
+	}
+}
+
+bool Client::sendQueueReady() {
+	// Below the high-water mark, whether sending or holding messages until reconnected
+	return active().getConnection().getSendStats().queueDepth < options.connection.sendHighWaterMark;
+}
+
 void Client::handleCommand(const std::string& command) {
 	if (command == "/exit")
 		// This will be handled in the UI's run method
 		return;
 
-	// Extract command and arguments
-	std::string cmd = command;
-	std::string args;
-
-	size_t spacePos = command.find(' ');
-	if (spacePos != std::string::npos) {
-		cmd = command.substr(0, spacePos);
-		args = command.substr(spacePos + 1);
-	}
-
-	// Process via command processor
-	if (!commandProcessor->processCommand(cmd, args)) ui->addSystemMessage("Unknown command: " + cmd);
+	// Process via command processor, which splits off the arguments
+	if (!commandProcessor->processCommand(command))
+		ui->addSystemMessage("Unknown command: " + command.substr(0, command.find(' ')));
 }
 
-void Client::processMessage(const json& message) {
-	if (!message.contains("type")) return;
+void Client::joinRoom(const std::string& roomName, const std::string& username) {
+	// Already open: just show it
+	for (size_t i = 0; i < sessions.size(); ++i)
+		if (sessions[i]->getRoom() == roomName && sessions[i]->getUsername() == username) {
+			switchSession(i);
+			return;
+		}
 
-	std::string type = message["type"];
+	// The lobby turns into the room, otherwise the room gets its own tab and connection
+	size_t index = active().getRoom().empty() ? activeSession : openSession();
+	RoomSession& session = *sessions[index];
+	session.join(roomName, username);
+	lastUsername = username;
+	switchSession(index);
+
+	if (session.getConnection().isConnected())
+		ui->showStatus("Joining room: " + roomName + " as " + username);
+	else
+		ui->showStatus("Offline: will join " + roomName + " as " + username + " once connected");
+}
 
-	if (type == "roomList") {
-		std::vector<std::string> rooms;
-		for (auto& room : message["data"])
-			rooms.push_back(room);
-		handleRoomListUpdate(rooms);
-	} else if (type == "message") {
-		std::string messageText = message["data"];
+void Client::leaveRoom() {
+	if (active().getRoom().empty()) {
+		ui->addSystemMessage("Not in a room");
+		return;
+	}
 
-		// Check if it's a user message (username: message format)
-		size_t colonPos = messageText.find(": ");
-		if (colonPos != std::string::npos) {
-			std::string username = messageText.substr(0, colonPos);
-			std::string content = messageText.substr(colonPos + 2);
-			handleChatMessage(username, content);
-		} else {
-			handleSystemEvent(messageText);
-		}
-	} else if (type == "userList") {
-		std::vector<std::string> users;
-		for (auto& user : message["data"])
-			users.push_back(user);
-		handleUserListUpdate(users);
+	// The last room turns back into a lobby on a fresh connection
+	if (sessions.size() == 1) {
+		size_t lobby = openSession();
+		switchSession(lobby);
+		closeSession(0);
+	} else {
+		closeSession(activeSession);
 	}
+	ui->showStatus("Left the room");
 }
 
-void Client::joinRoom(const std::string& roomName, const std::string& username) {
-	if (!webSocketManager->isConnected()) {
-		ui->addSystemMessage("Not connected to server");
-		return;
-	}
+void Client::requestRooms() {
+	reportSendResult(active().getConnection().sendMessage(OutboundMessage::roomListRequest()));
+}
+
+size_t Client::openSession() {
+	sessions.push_back(std::make_unique<RoomSession>(connectionPool.acquire(), options.inboundQueueCapacity,
+													 options.inboundOverflow, options.history, options.log, inboundReady,
+													 *this));
+	return sessions.size() - 1;
+}
 
-	this->username = username;
-	currentRoom = roomName;
-	ui->updateRoomName(roomName);
+void Client::switchSession(size_t index) {
+	if (index >= sessions.size()) return;
 
-	// Send join room message
-	json joinMsg = { { "type", "joinRoom" }, { "data", { { "username", username }, { "room", roomName } } } };
+	if (activeSession < sessions.size()) sessions[activeSession]->setActive(false);
+	activeSession = index;
 
-	webSocketManager->sendMessage(joinMsg);
-	ui->showStatus("Joining room: " + roomName + " as " + username);
+	RoomSession& session = active();
+	session.setActive(true);
+	ui->showHistory(&session.getHistory());
+	ui->showUsers(&session.getUsers());
+	ui->updateRoomName(session.getRoom());
+	updateTabs();
 }
 
-void Client::requestRooms() {
-	if (!webSocketManager->isConnected()) return;
+void Client::closeSession(size_t index) {
+	// Never leave the chat window pointing at a history that is about to be destroyed
+	if (index == activeSession) switchSession(index + 1 < sessions.size() ? index + 1 : index - 1);
 
-	json roomsMsg;
-	roomsMsg["type"] = "getRoomList";
-	webSocketManager->sendMessage(roomsMsg);
+	connectionPool.release(sessions[index]->releaseConnection());
+	sessions.erase(sessions.begin() + index);
+	if (activeSession > index) activeSession--;
+	updateTabs();
 }
 
-void Client::handleChatMessage(const std::string& username, const std::string& message) {
-	ui->addMessage(username, message);
+void Client::updateTabs() {
+	std::vector<ChatElement::Tab> tabs;
+	tabs.reserve(sessions.size());
+	for (size_t i = 0; i < sessions.size(); ++i)
+		tabs.push_back({ sessions[i]->getRoom(), sessions[i]->getUnread(), i == activeSession });
+	ui->updateTabs(tabs);
 }
 
-void Client::handleSystemEvent(const std::string& event) {
-	ui->addSystemMessage(event);
+void Client::onHistoryAppended(RoomSession& session, size_t count) {
+	ui->historyAppended(session.getRoom(), session.getHistory(), count, session.isActive());
+
+	// Inactive rooms are not redrawn; the tab bar only changes when a room first gets unread lines
+	if (!session.isActive() && session.getUnread() == count) updateTabs();
 }
 
-void Client::handleUserListUpdate(const std::vector<std::string>& users) {
-	ui->updateUsers(users);
+void Client::onUsersChanged(RoomSession& session) {
+	ui->usersChanged(session.getRoom(), session.getUsers(), session.isActive());
 }
 
-void Client::handleRoomListUpdate(const std::vector<std::string>& rooms) {
-	// Display available rooms
-	std::string roomsStr = "Available rooms: ";
-	if (rooms.empty()) {
-		roomsStr += "none (create a new one)";
-	} else {
-		for (size_t i = 0; i < rooms.size(); ++i) {
-			if (i > 0) roomsStr += ", ";
-			roomsStr += rooms[i];
-		}
-	}
-	ui->addSystemMessage(roomsStr);
-}
\ No newline at end of file
+void Client::onRoomList(RoomSession&, const InboundEvent::ItemList& rooms) {
+	// For completion; the session adds the list to the room as a line
+	std::vector<std::string> names;
+	std::string buffer;
+	names.reserve(rooms.size());
+	for (std::string_view room : rooms)
+		names.emplace_back(DisplayText::sanitize(room, buffer));
+	ui->setRooms(names);
+}
+
+void Client::onStatus(RoomSession& session, std::string_view status) {
+	if (session.isActive()) ui->showStatus(std::string(status));
+}
@@ -1,44 +1,73 @@
 #pragma once
 
+#include "clientOptions.h"
 #include "command/commandProcessor.h"
-#include "message/messageHandler.h"
-#include "network/webSocketManager.h"
-#include "ui/ui.h"
+#include "frontend.h"
+#include "metrics/metricsExporter.h"
+#include "network/connectionPool.h"
+#include "session/roomSession.h"
+#include "util/eventFd.h"
 #include <memory>
 #include <string>
 #include <vector>
 
-class Client : public MessageHandler {
+class Client : public SessionListener {
   public:
-	Client(const std::string& url);
+	Client(const ClientOptions& options);
 	~Client();
 
 	// Run the client
 	void run();
 
-	// MessageHandler implementation
-	void processMessage(const json& message) override;
-	void handleChatMessage(const std::string& username, const std::string& message) override;
-	void handleSystemEvent(const std::string& event) override;
-	void handleUserListUpdate(const std::vector<std::string>& users) override;
-	void handleRoomListUpdate(const std::vector<std::string>& rooms) override;
+	// SessionListener implementation (UI thread)
+	void onHistoryAppended(RoomSession& session, size_t count) override;
+	void onUsersChanged(RoomSession& session) override;
+	void onRoomList(RoomSession& session, const InboundEvent::ItemList& rooms) override;
+	void onStatus(RoomSession& session, std::string_view status) override;
 
   private:
-	std::string username;
-	std::string currentRoom;
+	ClientOptions options;
+	std::string lastUsername;
 
-	std::unique_ptr<UI> ui;
+	// Declared first so the frontend, which keeps the command trie, is destroyed before it
 	std::unique_ptr<CommandProcessor> commandProcessor;
-	std::unique_ptr<WebSocketManager> webSocketManager;
+	std::unique_ptr<Frontend> ui; // Terminal UI, or stdin/stdout when headless
+	ConnectionPool connectionPool;
+
+	// Open rooms; the first one starts as the room-less lobby. Never empty while running.
+	std::vector<std::unique_ptr<RoomSession>> sessions;
+	size_t activeSession;
+
+	// Signalled by every session's network thread
+	EventFd inboundReady;
+	uint64_t reportedDrops;
+
+	std::unique_ptr<MetricsExporter> metricsExporter;
+
+	// Most recent matches listed by /search
+	static constexpr size_t searchResultLimit = 1000;
+
+	// Inbound event handoff
+	void drainInbound();
 
 	// Input handling
 	void handleUserInput(const std::string& input);
 	void handleCommand(const std::string& command);
+	void reportSendResult(WebSocketManager::SendResult result);
+	bool sendQueueReady();
 
 	// Room operations
 	void joinRoom(const std::string& roomName, const std::string& username);
+	void leaveRoom();
 	void requestRooms();
 
+	// Session management
+	RoomSession& active() { return *sessions[activeSession]; }
+	size_t openSession();
+	void switchSession(size_t index);
+	void closeSession(size_t index);
+	void updateTabs();
+
 	// Initialize command handlers
 	void initCommandHandlers();
-};
\ No newline at end of file
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "headless/headlessOptions.h"
+#include "network/connectionOptions.h"
+#include "storage/roomLogOptions.h"
+#include "ui/chatHistory.h"
+#include "util/spscRing.h"
+#include <cstddef>
+#include <string>
+
+// Runtime configuration, filled from the command line in main()
+struct ClientOptions {
+	std::string url = "wss://chat.nasiadka.pl/ws";
+
+	// Network -> UI event ring
+	size_t inboundQueueCapacity = 4096;
+	OverflowPolicy inboundOverflow = OverflowPolicy::DropNewest;
+
+	ConnectionOptions connection;
+
+	// Idle connections kept open so joining another room skips the handshake
+	size_t warmConnections = 0;
+
+	// Scrollback kept per room: recent lines in memory, older ones compressed up to a budget
+	ChatHistory::Limits history;
+
+	// Per-room chat logs on disk, disabled unless log.directory is set
+	RoomLogOptions log;
+
+	// Screen updates per second at most; typing is echoed immediately regardless. 0 disables the cap.
+	unsigned frameRate = 60;
+
+	// Sent lines recalled with Up/Down, kept across runs in this file (mode 0600); empty, the default,
+	// keeps them in memory only.
+	std::string inputHistoryFile;
+
+	// No terminal UI: commands and messages are read from stdin, events written to stdout
+	bool headless = false;
+	HeadlessOptions output;
+
+	// Prometheus text file rewritten every metricsInterval seconds; empty disables it
+	std::string metricsFile;
+	unsigned metricsInterval = 10;
+};
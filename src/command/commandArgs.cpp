@@ -0,0 +1,26 @@
+#include "commandArgs.h"
+#include <algorithm>
+
+std::string_view CommandArgs::peek(size_t& end) const {
+	size_t start = text.find_first_not_of(' ', position);
+	if (start == std::string_view::npos) {
+		end = text.size();
+		return std::string_view();
+	}
+	end = std::min(text.find(' ', start), text.size());
+	return text.substr(start, end - start);
+}
+
+bool CommandArgs::next(std::string_view& word) {
+	size_t end;
+	std::string_view found = peek(end);
+	position = end;
+	if (found.empty()) return false;
+	word = found;
+	return true;
+}
+
+std::string_view CommandArgs::rest() const {
+	size_t start = text.find_first_not_of(' ', position);
+	return start == std::string_view::npos ? std::string_view() : text.substr(start);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <charconv>
+#include <string_view>
+#include <type_traits>
+
+// Arguments of a command, read word by word as views into the command line; nothing is
+// copied or allocated. Words are separated by spaces.
+class CommandArgs {
+  public:
+	explicit CommandArgs(std::string_view text)
+	  : text(text)
+	  , position(0) {}
+
+	// Next word; false, leaving word as it was (e.g. a default), when none is left
+	bool next(std::string_view& word);
+
+	// Next word as a number; false, reading nothing, unless the whole word is one that fits T
+	template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+	bool next(T& number);
+
+	// Everything not read yet, without leading spaces (e.g. free text after the fixed arguments)
+	std::string_view rest() const;
+
+	bool empty() const { return rest().empty(); }
+
+  private:
+	std::string_view text;
+	size_t position;
+
+	std::string_view peek(size_t& end) const;
+};
+
+template <typename T, typename>
+bool CommandArgs::next(T& number) {
+	size_t end;
+	std::string_view word = peek(end);
+	T value;
+	auto [parsed, error] = std::from_chars(word.data(), word.data() + word.size(), value);
+	if (word.empty() || error != std::errc() || parsed != word.data() + word.size()) return false;
+
+	number = value;
+	position = end;
+	return true;
+}
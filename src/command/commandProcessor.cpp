@@ -1,19 +1,28 @@
 #include "commandProcessor.h"
+#include <algorithm>
 
 CommandProcessor::CommandProcessor() {}
 
-void CommandProcessor::registerCommand(const std::string& command, CommandHandler handler) {
-	commandHandlers[command] = handler;
+void CommandProcessor::registerCommand(std::string_view command, CommandHandler handler) {
+	uint32_t index = commands.find(command);
+	if (index != PrefixTrie::none) {
+		handlers[index] = std::move(handler);
+		return;
+	}
+	commands.insert(command, static_cast<uint32_t>(handlers.size()));
+	handlers.push_back(std::move(handler));
 }
 
-bool CommandProcessor::processCommand(const std::string& command, const std::string& args) {
-	auto it = commandHandlers.find(command);
-	if (it == commandHandlers.end()) return false;
+bool CommandProcessor::processCommand(std::string_view line) {
+	size_t nameEnd = std::min(line.find(' '), line.size());
+	uint32_t index = commands.find(line.substr(0, nameEnd));
+	if (index == PrefixTrie::none) return false;
 
-	it->second(args);
+	CommandArgs args(line.substr(nameEnd));
+	handlers[index](args);
 	return true;
 }
 
-bool CommandProcessor::isCommand(const std::string& input) const {
+bool CommandProcessor::isCommand(std::string_view input) const {
 	return !input.empty() && input[0] == '/';
-}
\ No newline at end of file
+}
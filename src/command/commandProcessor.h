@@ -1,24 +1,30 @@
 #pragma once
 
+#include "../util/prefixTrie.h"
+#include "commandArgs.h"
 #include <functional>
-#include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
 
 class CommandProcessor {
   public:
-	using CommandHandler = std::function<void(const std::string&)>;
+	using CommandHandler = std::function<void(CommandArgs& args)>;
 
 	CommandProcessor();
 
-	// Register a command handler
-	void registerCommand(const std::string& command, CommandHandler handler);
+	// Register a command handler ("/join"...)
+	void registerCommand(std::string_view command, CommandHandler handler);
 
-	// Process a command
-	bool processCommand(const std::string& command, const std::string& args);
+	// Run the command line starts with, passing it the rest of the line; false if it is unknown
+	bool processCommand(std::string_view line);
 
 	// Check if input is a command
-	bool isCommand(const std::string& input) const;
+	bool isCommand(std::string_view input) const;
+
+	// Registered command names, for completion
+	const PrefixTrie& getCommands() const { return commands; }
 
   private:
-	std::unordered_map<std::string, CommandHandler> commandHandlers;
-};
\ No newline at end of file
+	PrefixTrie commands; // Name -> index into handlers
+	std::vector<CommandHandler> handlers;
+};
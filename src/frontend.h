@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ui/chatHistory.h"
+#include "ui/elements/chatElement.h"
+#include "ui/userList.h"
+#include "util/prefixTrie.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// What the client shows its rooms on and reads input from: the terminal UI, or stdin and stdout
+// when running headless. Called on the UI thread only.
+class Frontend {
+  public:
+	virtual ~Frontend() = default;
+
+	virtual void init() = 0;
+
+	// Main loop. Blocks in poll() on the input and wakeFd; eventPump applies queued network
+	// events whenever wakeFd becomes readable (or every iteration if wakeFd is -1). Every line of
+	// input goes to inputHandler; returns after "/exit".
+	virtual void run(std::function<void(const std::string&)> inputHandler, std::function<void()> eventPump,
+					 int wakeFd = -1) = 0;
+
+	// Lines were appended to a room's history; shown is set for the room on screen
+	virtual void historyAppended(const std::string& room, ChatHistory& history, size_t count, bool shown) = 0;
+
+	// Members joined or left a room
+	virtual void usersChanged(const std::string& room, const UserList& users, bool shown) = 0;
+
+	// The server's room list
+	virtual void setRooms(const std::vector<std::string>& rooms) = 0;
+
+	// Output of the client itself (command results, errors) and status updates
+	virtual void addSystemMessage(std::string_view message) = 0;
+	virtual void showStatus(const std::string& status) = 0;
+
+	// Another room is shown
+	virtual void showHistory(ChatHistory* history) = 0;
+	virtual void showUsers(UserList* users) = 0;
+	virtual void updateRoomName(const std::string& roomName) = 0;
+	virtual void updateTabs(const std::vector<ChatElement::Tab>& tabs) = 0;
+
+	// /search results (line ids in the shown history) and /users
+	virtual void showSearchResults(const std::vector<int64_t>& ids, const std::string& title) = 0;
+	virtual void filterUsers(const std::string& prefix) = 0;
+
+	// Commands the input may complete; the trie must outlive the frontend
+	virtual void setCommands(const PrefixTrie& commands) = 0;
+
+	// Input lines are handed over only while ready() holds, so a writer faster than the server is
+	// held back instead of having lines rejected. The terminal UI reads keys regardless.
+	virtual void setInputReady(std::function<bool()>) {}
+};
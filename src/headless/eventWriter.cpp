@@ -0,0 +1,143 @@
+#include "eventWriter.h"
+#include "../message/jsonCodec.h"
+#include "../metrics/metrics.h"
+#include <cerrno>
+#include <charconv>
+#include <poll.h>
+#include <unistd.h>
+
+EventWriter::EventWriter(int fd, const HeadlessOptions& options)
+  : fd(fd)
+  , options(options)
+  , oldestNs(0)
+  , closed(false) {
+
+	buffer.reserve(options.flushBytes + 4096);
+}
+
+EventWriter::~EventWriter() {
+	flush();
+}
+
+void EventWriter::appendField(std::string_view value) {
+	if (options.format == HeadlessOptions::Format::Json) {
+		JsonCodec::appendString(buffer, value);
+		return;
+	}
+
+	// TSV: a field must not contain the separators
+	size_t runStart = 0;
+	for (size_t i = 0; i < value.size(); ++i) {
+		char c = value[i];
+		if (c != '\t' && c != '\n' && c != '\r' && c != '\\') continue;
+		buffer.append(value.data() + runStart, i - runStart);
+		buffer += '\\';
+		buffer += c == '\t' ? 't' : c == '\n' ? 'n' : c == '\r' ? 'r' : '\\';
+		runStart = i + 1;
+	}
+	buffer.append(value.data() + runStart, value.size() - runStart);
+}
+
+void EventWriter::begin(std::string_view type, time_t time, std::string_view room) {
+	char digits[24];
+	char* digitsEnd = std::to_chars(digits, digits + sizeof(digits), static_cast<int64_t>(time)).ptr;
+
+	bool json = options.format == HeadlessOptions::Format::Json;
+	buffer += json ? "{\"type\":" : "";
+	appendField(type);
+	buffer += json ? ",\"time\":" : "\t";
+	buffer.append(digits, digitsEnd);
+	buffer += json ? ",\"room\":" : "\t";
+	appendField(room);
+}
+
+void EventWriter::end() {
+	buffer += options.format == HeadlessOptions::Format::Json ? "}\n" : "\n";
+	if (oldestNs == 0) oldestNs = Metrics::nowNs();
+	if (buffer.size() >= options.flushBytes) flush();
+}
+
+void EventWriter::text(std::string_view type, time_t time, std::string_view room, std::string_view user,
+					   std::string_view text) {
+	begin(type, time, room);
+	if (options.format == HeadlessOptions::Format::Json) {
+		if (!user.empty()) {
+			buffer += ",\"user\":";
+			appendField(user);
+		}
+		buffer += ",\"text\":";
+	} else {
+		buffer += '\t';
+		appendField(user);
+		buffer += '\t';
+	}
+	appendField(text);
+	end();
+}
+
+void EventWriter::count(std::string_view type, time_t time, std::string_view room, size_t count) {
+	char digits[24];
+	char* digitsEnd = std::to_chars(digits, digits + sizeof(digits), count).ptr;
+
+	begin(type, time, room);
+	buffer += options.format == HeadlessOptions::Format::Json ? ",\"count\":" : "\t\t";
+	buffer.append(digits, digitsEnd);
+	end();
+}
+
+void EventWriter::names(std::string_view type, time_t time, std::string_view room,
+						const std::vector<std::string_view>& names) {
+	if (options.format == HeadlessOptions::Format::Tsv) {
+		// A line per name; an empty list still gets one, with no name
+		for (size_t i = 0; i == 0 || i < names.size(); ++i) {
+			begin(type, time, room);
+			buffer += "\t\t";
+			if (i < names.size()) appendField(names[i]);
+			end();
+		}
+		return;
+	}
+
+	begin(type, time, room);
+	buffer += ",\"names\":[";
+	for (size_t i = 0; i < names.size(); ++i) {
+		if (i > 0) buffer += ',';
+		appendField(names[i]);
+	}
+	buffer += ']';
+	end();
+}
+
+void EventWriter::batchDone() {
+	if (buffer.empty()) return;
+	if (options.flushIntervalMs == 0 || flushTimeout() == 0) flush();
+}
+
+int EventWriter::flushTimeout() const {
+	if (buffer.empty() || options.flushIntervalMs == 0) return -1;
+
+	uint64_t dueNs = oldestNs + options.flushIntervalMs * 1000000ULL;
+	uint64_t now = Metrics::nowNs();
+	return now >= dueNs ? 0 : static_cast<int>((dueNs - now + 999999) / 1000000);
+}
+
+void EventWriter::flush() {
+	size_t written = 0;
+	while (!closed && written < buffer.size()) {
+		ssize_t result = write(fd, buffer.data() + written, buffer.size() - written);
+		if (result >= 0) {
+			written += result;
+		} else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+			// A non-blocking output that is full: wait for the reader
+			pollfd out = { fd, POLLOUT, 0 };
+			poll(&out, 1, -1);
+		} else if (errno != EINTR) {
+			closed = true;
+		}
+	}
+	buffer.clear();
+	oldestNs = 0;
+
+	// Events written out count as shown for the message-to-screen latency
+	Metrics::get().screenUpdated();
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "headlessOptions.h"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Events written to a file descriptor one per line, as NDJSON or TSV. Lines are collected in a
+// buffer and written with a single write() when the flush policy says so, so a busy room costs
+// a system call per batch rather than per line.
+//
+// NDJSON: {"type":..,"time":..,"room":..} plus "user" and "text", "count" or "names".
+// TSV: type, time, room, user and text columns; a count is the text, and a list of names is
+// one line per name. Tabs, line breaks and backslashes in TSV fields are escaped.
+class EventWriter {
+  public:
+	EventWriter(int fd, const HeadlessOptions& options);
+	~EventWriter();
+
+	EventWriter(const EventWriter&) = delete;
+	EventWriter& operator=(const EventWriter&) = delete;
+
+	// An event with text, e.g. a chat line (user may be empty)
+	void text(std::string_view type, time_t time, std::string_view room, std::string_view user, std::string_view text);
+
+	// An event carrying a number, e.g. a member count
+	void count(std::string_view type, time_t time, std::string_view room, size_t count);
+
+	// An event listing names, e.g. rooms
+	void names(std::string_view type, time_t time, std::string_view room, const std::vector<std::string_view>& names);
+
+	// A batch of events is complete: written now unless an interval asks to wait for more
+	void batchDone();
+
+	// Milliseconds until buffered events are due, -1 if nothing is waiting for the interval
+	int flushTimeout() const;
+
+	// Write everything buffered
+	void flush();
+
+	// The output was closed (e.g. the reading end of a pipe exited); nothing more can be written
+	bool failed() const { return closed; }
+
+  private:
+	int fd;
+	HeadlessOptions options;
+	std::string buffer;
+	uint64_t oldestNs; // When the first buffered event was added, 0 if none
+	bool closed;
+
+	void begin(std::string_view type, time_t time, std::string_view room);
+	void end();
+	void appendField(std::string_view value);
+};
@@ -0,0 +1,151 @@
+#include "headlessFrontend.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <stdexcept>
+#include <unistd.h>
+
+volatile std::sig_atomic_t HeadlessFrontend::stopRequested = 0;
+
+namespace {
+
+// How often a paused input checks whether the send queue drained
+const int pausedPollMs = 20;
+
+} // namespace
+
+HeadlessFrontend::HeadlessFrontend(const HeadlessOptions& options)
+  : writer(STDOUT_FILENO, options)
+  , shownHistory(nullptr)
+  , shownUsers(nullptr)
+  , consumedInput(0)
+  , inputOpen(true) {}
+
+void HeadlessFrontend::init() {
+	// A closed stdout is seen as a failed write instead of killing the process; a signal ends
+	// the loop, so buffered events are still written
+	std::signal(SIGPIPE, SIG_IGN);
+	std::signal(SIGINT, [](int) { stopRequested = 1; });
+	std::signal(SIGTERM, [](int) { stopRequested = 1; });
+}
+
+void HeadlessFrontend::run(std::function<void(const std::string&)> inputHandler, std::function<void()> eventPump,
+						   int wakeFd) {
+	bool running = true;
+	pollfd fds[2] = { { STDIN_FILENO, POLLIN, 0 }, { wakeFd, POLLIN, 0 } };
+	nfds_t fdCount = wakeFd >= 0 ? 2 : 1;
+
+	// Events queued before the loop started
+	if (eventPump) eventPump();
+	writer.batchDone();
+
+	while (running && !stopRequested && !writer.failed()) {
+		try {
+			// Sleep until input or network events arrive, or buffered output is due; a closed or
+			// paused stdin is left out (poll() skips negative descriptors)
+			bool waiting = paused();
+			fds[0].fd = inputOpen && !waiting ? STDIN_FILENO : -1;
+			fds[0].revents = fds[1].revents = 0;
+			int timeout = writer.flushTimeout();
+			if (waiting && (timeout < 0 || timeout > pausedPollMs)) timeout = pausedPollMs;
+			if (poll(fds, fdCount, timeout) < 0 && errno != EINTR)
+				throw std::runtime_error("poll failed: " + std::string(std::strerror(errno)));
+
+			if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) readInput();
+			running = handleLines(inputHandler);
+
+			// Apply events received from the network thread
+			if (eventPump && (fdCount == 1 || (fds[1].revents & POLLIN))) eventPump();
+
+			writer.batchDone();
+		} catch (const std::exception& e) {
+			addSystemMessage("Error occurred: " + std::string(e.what()));
+		}
+	}
+	writer.flush();
+}
+
+void HeadlessFrontend::readInput() {
+	char chunk[64 * 1024];
+	ssize_t length = read(STDIN_FILENO, chunk, sizeof(chunk));
+	if (length < 0) return; // EINTR, EAGAIN
+
+	pendingInput.erase(0, consumedInput);
+	consumedInput = 0;
+	if (length == 0) {
+		// A last line without a newline still counts
+		inputOpen = false;
+		if (!pendingInput.empty() && pendingInput.back() != '\n') pendingInput += '\n';
+	}
+	pendingInput.append(chunk, length);
+}
+
+bool HeadlessFrontend::handleLines(const std::function<void(const std::string&)>& inputHandler) {
+	size_t newline;
+	while (!paused() && (newline = pendingInput.find('\n', consumedInput)) != std::string::npos) {
+		size_t lineStart = consumedInput;
+		size_t lineEnd = newline > lineStart && pendingInput[newline - 1] == '\r' ? newline - 1 : newline;
+		// Consumed before handling, so a line that throws is not handled again
+		consumedInput = newline + 1;
+		if (lineEnd == lineStart) continue;
+
+		std::string line = pendingInput.substr(lineStart, lineEnd - lineStart);
+		if (line == "/exit") return false;
+		inputHandler(line);
+	}
+	return true;
+}
+
+void HeadlessFrontend::historyAppended(const std::string& room, ChatHistory& history, size_t count, bool) {
+	for (size_t index = history.size() - std::min(count, history.size()); index < history.size(); ++index) {
+		const ChatHistory::Record& record = history.record(index);
+		if (record.kind == ChatHistory::Kind::User)
+			writer.text("message", record.time, room, history.username(record), history.body(record));
+		else
+			writer.text("system", record.time, room, std::string_view(), history.body(record));
+	}
+}
+
+void HeadlessFrontend::usersChanged(const std::string& room, const UserList& users, bool) {
+	writer.count("users", std::time(nullptr), room, users.size());
+}
+
+void HeadlessFrontend::setRooms(const std::vector<std::string>& rooms) {
+	names.assign(rooms.begin(), rooms.end());
+	writer.names("rooms", std::time(nullptr), std::string_view(), names);
+}
+
+void HeadlessFrontend::addSystemMessage(std::string_view message) {
+	writer.text("info", std::time(nullptr), shownRoom, std::string_view(), message);
+}
+
+void HeadlessFrontend::showStatus(const std::string& status) {
+	writer.text("status", std::time(nullptr), shownRoom, std::string_view(), status);
+}
+
+void HeadlessFrontend::showSearchResults(const std::vector<int64_t>& ids, const std::string& title) {
+	addSystemMessage(title);
+	if (!shownHistory) return;
+
+	// Newest first, as listed by the UI
+	for (int64_t id : ids) {
+		size_t index;
+		if (!shownHistory->find(id, index)) continue;
+		const ChatHistory::Record& record = shownHistory->record(index);
+		bool user = record.kind == ChatHistory::Kind::User;
+		writer.text("found", record.time, shownRoom, user ? shownHistory->username(record) : std::string_view(),
+					shownHistory->body(record));
+	}
+}
+
+void HeadlessFrontend::filterUsers(const std::string& prefix) {
+	names.clear();
+	if (shownUsers) {
+		size_t first, last;
+		shownUsers->prefixRange(prefix, first, last);
+		for (size_t position = first; position < last; ++position)
+			names.push_back((*shownUsers)[position]);
+	}
+	writer.names("members", std::time(nullptr), shownRoom, names);
+}
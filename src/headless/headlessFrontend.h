@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../frontend.h"
+#include "eventWriter.h"
+#include "headlessOptions.h"
+#include <csignal>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Runs the client without a terminal, for bots and archivers: each line of stdin is handled as
+// if typed (commands or messages), and what the UI would show is written to stdout as events.
+// Lines of every open room are written, not only the shown one's; commands such as /search and
+// /users answer for the shown room. Closing stdin leaves the client running until /exit,
+// SIGINT or SIGTERM. While the send queue is backed up, stdin is not read, so a fast writer
+// blocks on the pipe instead of losing lines.
+class HeadlessFrontend : public Frontend {
+  public:
+	explicit HeadlessFrontend(const HeadlessOptions& options);
+
+	void init() override;
+	void run(std::function<void(const std::string&)> inputHandler, std::function<void()> eventPump,
+			 int wakeFd = -1) override;
+
+	void historyAppended(const std::string& room, ChatHistory& history, size_t count, bool shown) override;
+	void usersChanged(const std::string& room, const UserList& users, bool shown) override;
+	void setRooms(const std::vector<std::string>& rooms) override;
+	void addSystemMessage(std::string_view message) override;
+	void showStatus(const std::string& status) override;
+	void showHistory(ChatHistory* history) override { shownHistory = history; }
+	void showUsers(UserList* users) override { shownUsers = users; }
+	void updateRoomName(const std::string& roomName) override { shownRoom = roomName; }
+	void updateTabs(const std::vector<ChatElement::Tab>&) override {}
+	void showSearchResults(const std::vector<int64_t>& ids, const std::string& title) override;
+	void filterUsers(const std::string& prefix) override;
+	void setCommands(const PrefixTrie&) override {}
+	void setInputReady(std::function<bool()> ready) override { inputReady = std::move(ready); }
+
+  private:
+	EventWriter writer;
+	ChatHistory* shownHistory;
+	UserList* shownUsers;
+	std::string shownRoom;
+
+	// Input read but not yet handed over from consumedInput on: lines held back while paused,
+	// then a partial line
+	std::string pendingInput;
+	size_t consumedInput;
+	bool inputOpen;
+	std::function<bool()> inputReady;
+	std::vector<std::string_view> names; // Reused for list events
+
+	static volatile std::sig_atomic_t stopRequested;
+
+	bool paused() const { return inputReady && !inputReady(); }
+
+	// Append what stdin has to pendingInput
+	void readInput();
+
+	// Hand over complete lines until paused; false after "/exit"
+	bool handleLines(const std::function<void(const std::string&)>& inputHandler);
+};
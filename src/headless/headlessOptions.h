@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+// Output of headless mode (--headless), tuned for latency or throughput
+struct HeadlessOptions {
+	enum class Format { Json, Tsv };
+	Format format = Format::Json; // NDJSON objects or tab-separated lines
+
+	// Buffered events are written once this many bytes are waiting...
+	size_t flushBytes = 64 * 1024;
+
+	// ...or this many milliseconds after the oldest of them was buffered. With 0 they are written at the
+	// end of every batch of network events, which adds no delay and still batches under load.
+	unsigned flushIntervalMs = 0;
+};
@@ -0,0 +1,136 @@
+#include "loadGenerator.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+static std::string formatLatency(uint64_t us) {
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(us < 10000 ? 2 : 0) << us / 1000.0 << "ms";
+	return out.str();
+}
+
+static std::string formatMiB(double bytes) {
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(1) << bytes / (1024 * 1024) << " MiB";
+	return out.str();
+}
+
+LoadGenerator::LoadGenerator(const LoadOptions& options)
+  : options(options)
+  , stopping(false)
+  , sent(0)
+  , rejected(0)
+  , offline(0) {}
+
+LoadGenerator::~LoadGenerator() {
+	users.clear();
+}
+
+void LoadGenerator::run() {
+	size_t baselineRss = residentBytes();
+
+	std::cout << "Connecting " << options.users << " users to " << options.rooms << " rooms at " << options.url
+			  << std::endl;
+	users.reserve(options.users);
+	for (size_t i = 0; i < options.users && !stopping; ++i)
+		users.push_back(std::make_unique<SimulatedUser>(options.url, options.connection,
+														"loadgen-" + std::to_string(i % options.rooms),
+														"user" + std::to_string(i), latencies));
+
+	Clock::time_point start = Clock::now();
+	Clock::time_point nextReport = start + std::chrono::seconds(options.reportInterval);
+	Clock::time_point end = start + std::chrono::seconds(options.duration);
+
+	Totals lastTotals;
+	LatencyHistogram::Snapshot lastLatencies = latencies.snapshot();
+	Clock::time_point lastReport = start;
+	size_t nextUser = 0;
+
+	while (!stopping && !users.empty()) {
+		Clock::time_point now = Clock::now();
+		if (options.duration > 0 && now >= end) break;
+
+		// Send everything that is due by now, round-robin over the users
+		double elapsed = std::chrono::duration<double>(now - start).count();
+		uint64_t due = static_cast<uint64_t>(elapsed * options.rate);
+		while (sent < due) {
+			switch (users[nextUser]->send(options.messageSize)) {
+				case WebSocketManager::SendResult::Rejected: rejected++; break;
+				case WebSocketManager::SendResult::Offline: offline++; break;
+				default: break;
+			}
+			sent++;
+			nextUser = (nextUser + 1) % users.size();
+		}
+
+		if (now >= nextReport) {
+			Totals totals = collect();
+			LatencyHistogram::Snapshot snapshot = latencies.snapshot();
+			report("interval", std::chrono::duration<double>(now - lastReport).count(), totals, lastTotals,
+				   snapshot - lastLatencies, residentBytes(), baselineRss);
+			lastTotals = totals;
+			lastLatencies = snapshot;
+			lastReport = now;
+			nextReport += std::chrono::seconds(options.reportInterval);
+		}
+
+		// Sleep until the next message is due, but wake regularly to notice stop()
+		auto nextSend = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(
+								  (sent + 1) / options.rate));
+		std::this_thread::sleep_until(std::min({ nextSend, nextReport, now + std::chrono::milliseconds(100) }));
+	}
+
+	// Let in-flight messages arrive before the summary; rates cover the sending period only
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+	report("total", seconds, collect(), Totals(), latencies.snapshot(), residentBytes(), baselineRss);
+}
+
+LoadGenerator::Totals LoadGenerator::collect() const {
+	Totals totals;
+	totals.sent = sent;
+	totals.rejected = rejected;
+	totals.offline = offline;
+
+	for (const auto& user : users) {
+		totals.received += user->getReceived();
+		totals.errors += user->getErrors();
+		WebSocketManager::ConnectionStats stats = user->getConnection().getConnectionStats();
+		totals.reconnects += stats.reconnects;
+		totals.drops += stats.drops;
+		if (user->getConnection().isConnected()) totals.connected++;
+	}
+	return totals;
+}
+
+void LoadGenerator::report(const char* label, double seconds, const Totals& now, const Totals& before,
+						   const LatencyHistogram::Snapshot& window, size_t rss, size_t baselineRss) const {
+	if (seconds <= 0) seconds = 1;
+
+	std::cout << std::fixed << std::setprecision(0) << "[" << label << " " << seconds << "s] "
+			  << "connected " << now.connected << "/" << users.size() << ", "
+			  << "sent " << now.sent - before.sent << " (" << (now.sent - before.sent) / seconds << "/s), "
+			  << "received " << now.received - before.received << " ("
+			  << (now.received - before.received) / seconds << "/s)";
+	if (now.rejected > before.rejected) std::cout << ", rejected " << now.rejected - before.rejected;
+	if (now.offline > before.offline) std::cout << ", queued offline " << now.offline - before.offline;
+	if (now.errors > before.errors) std::cout << ", malformed " << now.errors - before.errors;
+	std::cout << "\n  latency p50 " << formatLatency(window.percentile(0.5)) << " p90 "
+			  << formatLatency(window.percentile(0.9)) << " p99 " << formatLatency(window.percentile(0.99))
+			  << " p99.9 " << formatLatency(window.percentile(0.999)) << " max " << formatLatency(window.max)
+			  << ", reconnects " << now.reconnects - before.reconnects << ", drops " << now.drops - before.drops
+			  << ", rss " << formatMiB(rss) << " (" << (rss >= baselineRss ? "+" : "-")
+			  << formatMiB(rss >= baselineRss ? rss - baselineRss : baselineRss - rss) << ")" << std::endl;
+}
+
+size_t LoadGenerator::residentBytes() {
+	// Second field of /proc/self/statm is the resident set in pages
+	std::ifstream statm("/proc/self/statm");
+	size_t pages = 0, resident = 0;
+	statm >> pages >> resident;
+	return resident * sysconf(_SC_PAGESIZE);
+}
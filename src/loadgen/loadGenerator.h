@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../metrics/latencyHistogram.h"
+#include "loadOptions.h"
+#include "simulatedUser.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+// Drives SimulatedUsers at a fixed message rate and prints periodic and final reports:
+// send-to-receive latency percentiles, throughput, reconnects and resident memory growth.
+class LoadGenerator {
+  public:
+	LoadGenerator(const LoadOptions& options);
+	~LoadGenerator();
+
+	// Connect the users and send until the duration elapses or stop() is called
+	void run();
+
+	// Async-signal-safe
+	void stop() { stopping.store(true); }
+
+  private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Totals {
+		uint64_t sent = 0;
+		uint64_t rejected = 0; // Dropped by a full send queue
+		uint64_t offline = 0;  // Queued while disconnected
+		uint64_t received = 0;
+		uint64_t errors = 0; // Malformed frames
+		uint64_t reconnects = 0;
+		uint64_t drops = 0;
+		size_t connected = 0;
+	};
+
+	LoadOptions options;
+	LatencyHistogram latencies; // Send-to-receive, microseconds
+	std::vector<std::unique_ptr<SimulatedUser>> users;
+	std::atomic<bool> stopping;
+
+	// Pacer thread counters
+	uint64_t sent;
+	uint64_t rejected;
+	uint64_t offline;
+
+	Totals collect() const;
+	void report(const char* label, double seconds, const Totals& now, const Totals& before,
+				const LatencyHistogram::Snapshot& window, size_t rss, size_t baselineRss) const;
+
+	static size_t residentBytes();
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../network/connectionOptions.h"
+#include <cstddef>
+#include <string>
+
+struct LoadOptions {
+	std::string url = "ws://localhost:8080/ws";
+
+	// Simulated users, spread round-robin over the rooms
+	size_t users = 100;
+	size_t rooms = 10;
+
+	// Chat messages per second across all users
+	double rate = 100;
+	size_t messageSize = 64;
+
+	// Seconds to run; 0 runs until interrupted (soak test)
+	unsigned duration = 60;
+	unsigned reportInterval = 5;
+
+	ConnectionOptions connection;
+};
@@ -0,0 +1,80 @@
+#include "loadGenerator.h"
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+static LoadGenerator* activeGenerator = nullptr;
+
+static void printUsage(const char* program) {
+	std::cout << "Usage: " << program << " [options] [url]\n"
+			  << "  --users=N                  Simulated users, one connection each (default 100)\n"
+			  << "  --rooms=N                  Rooms the users are spread over (default 10)\n"
+			  << "  --rate=N                   Chat messages per second across all users (default 100)\n"
+			  << "  --size=N                   Message size in bytes (default 64)\n"
+			  << "  --duration=N               Seconds to run, 0 until interrupted (default 60)\n"
+			  << "  --report=N                 Seconds between reports (default 5)\n"
+			  << "  --codec=NAME               Wire format: json (default) or msgpack\n"
+			  << "  --send-queue=N             Maximum queued outbound messages per user (default 1024)\n"
+			  << "  --help                     Show this help\n";
+}
+
+// Returns the value of "--name=value" if arg matches name, nullptr otherwise
+static const char* optionValue(const char* arg, const char* name) {
+	size_t len = std::strlen(name);
+	if (std::strncmp(arg, name, len) != 0 || arg[len] != '=') return nullptr;
+	return arg + len + 1;
+}
+
+static bool parseOptions(int argc, char** argv, LoadOptions& options) {
+	for (int i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+		const char* value;
+
+		if (std::strcmp(arg, "--help") == 0) {
+			printUsage(argv[0]);
+			std::exit(0);
+		} else if ((value = optionValue(arg, "--users"))) {
+			options.users = std::strtoul(value, nullptr, 10);
+		} else if ((value = optionValue(arg, "--rooms"))) {
+			options.rooms = std::strtoul(value, nullptr, 10);
+			if (options.rooms == 0) return false;
+		} else if ((value = optionValue(arg, "--rate"))) {
+			options.rate = std::strtod(value, nullptr);
+			if (options.rate <= 0) return false;
+		} else if ((value = optionValue(arg, "--size"))) {
+			options.messageSize = std::strtoul(value, nullptr, 10);
+		} else if ((value = optionValue(arg, "--duration"))) {
+			options.duration = std::strtoul(value, nullptr, 10);
+		} else if ((value = optionValue(arg, "--report"))) {
+			options.reportInterval = std::strtoul(value, nullptr, 10);
+			if (options.reportInterval == 0) return false;
+		} else if ((value = optionValue(arg, "--codec"))) {
+			if (!WireCodec::create(value)) return false;
+			options.connection.codec = value;
+		} else if ((value = optionValue(arg, "--send-queue"))) {
+			options.connection.sendQueueCapacity = std::strtoul(value, nullptr, 10);
+		} else if (arg[0] != '-') {
+			options.url = arg;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv) {
+	LoadOptions options;
+	if (!parseOptions(argc, argv, options)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	LoadGenerator generator(options);
+	activeGenerator = &generator;
+	std::signal(SIGINT, [](int) { activeGenerator->stop(); });
+	std::signal(SIGTERM, [](int) { activeGenerator->stop(); });
+
+	generator.run();
+	return 0;
+}
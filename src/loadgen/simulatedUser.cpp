@@ -0,0 +1,63 @@
+#include "simulatedUser.h"
+#include <charconv>
+#include <chrono>
+
+static uint64_t steadyNowNs() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+	  .count();
+}
+
+SimulatedUser::SimulatedUser(const std::string& url, const ConnectionOptions& options, const std::string& room,
+							 const std::string& username, LatencyHistogram& latencies)
+  : connection(url, options)
+  , latencies(latencies)
+  , received(0)
+  , errors(0) {
+	connection.setMessageCallback([this](std::string_view frame, WireCodec& codec) { processFrame(frame, codec); });
+	connection.setSessionMessage(OutboundMessage::joinRoom(room, username));
+	connection.connect();
+}
+
+SimulatedUser::~SimulatedUser() {
+	connection.disconnect();
+}
+
+WebSocketManager::SendResult SimulatedUser::send(size_t size) {
+	// Pacer thread only
+	payload = marker + std::to_string(steadyNowNs()) + ' ';
+	if (payload.size() < size) payload.append(size - payload.size(), 'x');
+	return connection.sendMessage(OutboundMessage::chat(payload));
+}
+
+void SimulatedUser::processFrame(std::string_view frame, WireCodec& codec) {
+	switch (codec.decode(frame, event)) {
+		case MessageDecoder::Result::Decoded: handleEvent(event); break;
+		case MessageDecoder::Result::Ignored: break;
+		case MessageDecoder::Result::Malformed: errors.fetch_add(1, std::memory_order_relaxed); break;
+	}
+}
+
+void SimulatedUser::handleEvent(const InboundEvent& event) {
+	switch (event.type) {
+		case InboundEvent::Type::ChatMessage: handleChatMessage(event.username(), event.text()); break;
+		case InboundEvent::Type::SystemEvent: handleSystemEvent(event.text()); break;
+		case InboundEvent::Type::UserList: handleUserListUpdate(event.items()); break;
+		case InboundEvent::Type::RoomList: handleRoomListUpdate(event.items()); break;
+		case InboundEvent::Type::Status: break;
+	}
+}
+
+void SimulatedUser::handleChatMessage(std::string_view, std::string_view message) {
+	received.fetch_add(1, std::memory_order_relaxed);
+	if (message.empty() || message[0] != marker) return;
+
+	uint64_t sentNs = 0;
+	std::from_chars(message.data() + 1, message.data() + message.size(), sentNs);
+	uint64_t now = steadyNowNs();
+	if (sentNs > 0 && sentNs <= now) latencies.record((now - sentNs) / 1000);
+}
+
+// Joins, leaves and lists only matter to a human reader
+void SimulatedUser::handleSystemEvent(std::string_view) {}
+void SimulatedUser::handleUserListUpdate(const InboundEvent::ItemList&) {}
+void SimulatedUser::handleRoomListUpdate(const InboundEvent::ItemList&) {}
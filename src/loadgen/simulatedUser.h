@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../message/messageHandler.h"
+#include "../network/webSocketManager.h"
+#include "../metrics/latencyHistogram.h"
+#include <atomic>
+#include <memory>
+#include <string>
+
+// One headless chat participant on its own WebSocketManager. Inbound frames go through the
+// same codec and MessageHandler dispatch as the client; chat messages sent by the load
+// generator carry their send time, so every delivery yields a latency sample.
+class SimulatedUser : public MessageHandler {
+  public:
+	SimulatedUser(const std::string& url, const ConnectionOptions& options, const std::string& room,
+				  const std::string& username, LatencyHistogram& latencies);
+	~SimulatedUser();
+
+	// Queue a timestamped chat message padded to size bytes
+	WebSocketManager::SendResult send(size_t size);
+
+	WebSocketManager& getConnection() { return connection; }
+	uint64_t getReceived() const { return received.load(std::memory_order_relaxed); }
+	uint64_t getErrors() const { return errors.load(std::memory_order_relaxed); }
+
+	// MessageHandler implementation (network thread)
+	void processFrame(std::string_view frame, WireCodec& codec) override;
+	void handleEvent(const InboundEvent& event) override;
+	void handleChatMessage(std::string_view username, std::string_view message) override;
+	void handleSystemEvent(std::string_view event) override;
+	void handleUserListUpdate(const InboundEvent::ItemList& users) override;
+	void handleRoomListUpdate(const InboundEvent::ItemList& rooms) override;
+
+	// Marker that starts every generated message, followed by the send time in steady-clock ns
+	static constexpr char marker = '#';
+
+  private:
+	WebSocketManager connection;
+	LatencyHistogram& latencies;
+	InboundEvent event; // Reused for every frame, only touched by the network thread
+	std::string payload;
+
+	std::atomic<uint64_t> received;
+	std::atomic<uint64_t> errors;
+};
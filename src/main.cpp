@@ -1,9 +1,149 @@
 #include "client.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
 
-int main() {
+static void printUsage(const char* program) {
+	std::cout << "Usage: " << program << " [options] [url]\n"
+			  << "  --inbound-queue=N          Capacity of the inbound event queue (default 4096)\n"
+			  << "  --inbound-overflow=MODE    drop (default) or block when the queue is full\n"
+			  << "  --send-queue=N             Maximum queued outbound messages (default 1024)\n"
+			  << "  --send-high-water=N        Queued messages before reporting backpressure (default 64)\n"
+			  << "  --warm-connections=N       Idle connections kept open for fast joins (default 0)\n"
+			  << "  --history-lines=N          Recent lines per room kept uncompressed (default 5000, headless 1000)\n"
+			  << "  --history-memory=N         MiB of compressed older lines per room (default 64, headless 0)\n"
+			  << "  --log-dir=PATH             Keep a chat log per room under PATH and show it on join\n"
+			  << "  --log-segment-size=N       MiB per log segment before starting a new one (default 4)\n"
+			  << "  --log-segments=N           Segments kept per room (default 16)\n"
+			  << "  --log-retention-days=N     Also delete segments older than N days (default: keep)\n"
+			  << "  --log-sync-interval=N      Milliseconds between flushes of the log to disk (default 2000)\n"
+			  << "  --fps=N                    Screen updates per second at most, 0 for no cap (default 60)\n"
+			  << "  --input-history=PATH       Keep sent lines for Up/Down across runs in PATH (default: this run only)\n"
+			  << "  --headless                 No terminal UI: read input lines from stdin, write events to stdout\n"
+			  << "  --output=FORMAT            Headless event format: json (NDJSON, default) or tsv\n"
+			  << "  --flush-bytes=N            Write headless output once N bytes are buffered (default 65536)\n"
+			  << "  --flush-interval=N         ...or N ms after the oldest event, 0: after every batch (default 0)\n"
+			  << "  --metrics-file=PATH        Write metrics in Prometheus text format to PATH\n"
+			  << "  --metrics-interval=N       Seconds between metrics file updates (default 10)\n"
+			  << "  --codec=NAME               Wire format: json (default) or msgpack\n"
+			  << "  --deflate                  Offer permessage-deflate compression\n"
+			  << "  --deflate-window-bits=N    LZ77 window for both directions, 9-15 (default 15)\n"
+			  << "  --deflate-no-context       Reset the compression context after every frame\n"
+			  << "  --deflate-min-size=N       Frames below N bytes are reported separately (default 64)\n"
+			  << "  --help                     Show this help\n";
+}
+
+// Returns the value of "--name=value" if arg matches name, nullptr otherwise
+static const char* optionValue(const char* arg, const char* name) {
+	size_t len = std::strlen(name);
+	if (std::strncmp(arg, name, len) != 0 || arg[len] != '=') return nullptr;
+	return arg + len + 1;
+}
+
+// Headless output is written as it arrives, so rooms only keep enough for /search
+static const size_t headlessHistoryLines = 1000;
+
+static bool parseOptions(int argc, char** argv, ClientOptions& options, bool& historySet) {
+	for (int i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+		const char* value;
+
+		if (std::strcmp(arg, "--help") == 0) {
+			printUsage(argv[0]);
+			std::exit(0);
+		} else if ((value = optionValue(arg, "--inbound-queue"))) {
+			options.inboundQueueCapacity = std::strtoul(value, nullptr, 10);
+			if (options.inboundQueueCapacity == 0) return false;
+		} else if ((value = optionValue(arg, "--inbound-overflow"))) {
+			if (std::strcmp(value, "drop") == 0)
+				options.inboundOverflow = OverflowPolicy::DropNewest;
+			else if (std::strcmp(value, "block") == 0)
+				options.inboundOverflow = OverflowPolicy::Block;
+			else
+				return false;
+		} else if ((value = optionValue(arg, "--send-queue"))) {
+			options.connection.sendQueueCapacity = std::strtoul(value, nullptr, 10);
+		} else if ((value = optionValue(arg, "--send-high-water"))) {
+			options.connection.sendHighWaterMark = std::strtoul(value, nullptr, 10);
+		} else if ((value = optionValue(arg, "--warm-connections"))) {
+			options.warmConnections = std::strtoul(value, nullptr, 10);
+		} else if ((value = optionValue(arg, "--history-lines"))) {
+			options.history.hotLines = std::strtoul(value, nullptr, 10);
+			historySet = true;
+		} else if ((value = optionValue(arg, "--history-memory"))) {
+			options.history.coldBytes = std::strtoul(value, nullptr, 10) * 1024 * 1024;
+			historySet = true;
+		} else if ((value = optionValue(arg, "--log-dir"))) {
+			options.log.directory = value;
+		} else if ((value = optionValue(arg, "--log-segment-size"))) {
+			options.log.segmentBytes = std::strtoul(value, nullptr, 10) * 1024 * 1024;
+			if (options.log.segmentBytes == 0) return false;
+		} else if ((value = optionValue(arg, "--log-segments"))) {
+			options.log.maxSegments = std::strtoul(value, nullptr, 10);
+			if (options.log.maxSegments == 0) return false;
+		} else if ((value = optionValue(arg, "--log-retention-days"))) {
+			options.log.retentionDays = std::strtoul(value, nullptr, 10);
+		} else if ((value = optionValue(arg, "--log-sync-interval"))) {
+			options.log.syncIntervalMs = std::strtoul(value, nullptr, 10);
+		} else if ((value = optionValue(arg, "--fps"))) {
+			options.frameRate = std::strtoul(value, nullptr, 10);
+		} else if ((value = optionValue(arg, "--input-history"))) {
+			options.inputHistoryFile = value;
+		} else if (std::strcmp(arg, "--headless") == 0) {
+			options.headless = true;
+		} else if ((value = optionValue(arg, "--output"))) {
+			if (std::strcmp(value, "json") == 0)
+				options.output.format = HeadlessOptions::Format::Json;
+			else if (std::strcmp(value, "tsv") == 0)
+				options.output.format = HeadlessOptions::Format::Tsv;
+			else
+				return false;
+		} else if ((value = optionValue(arg, "--flush-bytes"))) {
+			options.output.flushBytes = std::strtoul(value, nullptr, 10);
+		} else if ((value = optionValue(arg, "--flush-interval"))) {
+			options.output.flushIntervalMs = std::strtoul(value, nullptr, 10);
+		} else if ((value = optionValue(arg, "--metrics-file"))) {
+			options.metricsFile = value;
+		} else if ((value = optionValue(arg, "--metrics-interval"))) {
+			options.metricsInterval = std::strtoul(value, nullptr, 10);
+			if (options.metricsInterval == 0) return false;
+		} else if ((value = optionValue(arg, "--codec"))) {
+			if (!WireCodec::create(value)) return false;
+			options.connection.codec = value;
+		} else if (std::strcmp(arg, "--deflate") == 0) {
+			options.connection.compression = true;
+		} else if ((value = optionValue(arg, "--deflate-window-bits"))) {
+			unsigned long bits = std::strtoul(value, nullptr, 10);
+			if (bits < 9 || bits > 15) return false;
+			options.connection.clientMaxWindowBits = options.connection.serverMaxWindowBits = bits;
+		} else if (std::strcmp(arg, "--deflate-no-context") == 0) {
+			options.connection.clientNoContextTakeover = options.connection.serverNoContextTakeover = true;
+		} else if ((value = optionValue(arg, "--deflate-min-size"))) {
+			options.connection.compressionMinSize = std::strtoul(value, nullptr, 10);
+		} else if (arg[0] != '-') {
+			options.url = arg;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv) {
 	std::setlocale(LC_ALL, "");
 
-	Client client("wss://chat.nasiadka.pl/ws");
+	ClientOptions options;
+	bool historySet = false;
+	if (!parseOptions(argc, argv, options, historySet)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+	if (options.headless && !historySet) {
+		options.history.hotLines = headlessHistoryLines;
+		options.history.coldBytes = 0;
+	}
+
+	Client client(options);
 	client.run();
 	return 0;
-}
\ No newline at end of file
+}
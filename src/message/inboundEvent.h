@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A decoded server message, handed from the network thread to the UI thread.
+// Strings are spans into the event's own copy of the frame, so a reused ring slot decodes
+// the next frame without allocating.
+struct InboundEvent {
+	enum class Type { ChatMessage, SystemEvent, UserList, RoomList, Status };
+
+	struct Span {
+		uint32_t offset = 0;
+		uint32_t length = 0;
+	};
+
+	// Read-only view over UserList / RoomList entries
+	class ItemList {
+	  public:
+		class iterator {
+		  public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::string_view;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const std::string_view*;
+			using reference = std::string_view;
+
+			iterator(const InboundEvent& event, std::vector<Span>::const_iterator it)
+			  : event(&event)
+			  , it(it) {}
+
+			std::string_view operator*() const { return event->view(*it); }
+			iterator& operator++() {
+				++it;
+				return *this;
+			}
+			iterator operator++(int) {
+				iterator old = *this;
+				++it;
+				return old;
+			}
+			bool operator==(const iterator& other) const { return it == other.it; }
+			bool operator!=(const iterator& other) const { return it != other.it; }
+
+		  private:
+			const InboundEvent* event;
+			std::vector<Span>::const_iterator it;
+		};
+
+		explicit ItemList(const InboundEvent& event)
+		  : event(event) {}
+
+		size_t size() const { return event.itemSpans.size(); }
+		bool empty() const { return event.itemSpans.empty(); }
+		std::string_view operator[](size_t i) const { return event.view(event.itemSpans[i]); }
+		iterator begin() const { return iterator(event, event.itemSpans.begin()); }
+		iterator end() const { return iterator(event, event.itemSpans.end()); }
+
+	  private:
+		const InboundEvent& event;
+	};
+
+	Type type = Type::SystemEvent;
+	std::string buffer; // Frame bytes, JSON strings unescaped in place
+	Span usernameSpan;  // ChatMessage only
+	Span textSpan;      // ChatMessage content, SystemEvent or Status text
+	std::vector<Span> itemSpans;
+	uint64_t receivedNs = 0; // Metrics::nowNs() when the frame arrived, 0 for local events
+
+	std::string_view view(Span span) const { return std::string_view(buffer.data() + span.offset, span.length); }
+	std::string_view username() const { return view(usernameSpan); }
+	std::string_view text() const { return view(textSpan); }
+	ItemList items() const { return ItemList(*this); }
+
+	// Fill as a plain text event (locally generated status and system messages)
+	void setText(Type eventType, std::string_view value) {
+		type = eventType;
+		buffer.assign(value.data(), value.size());
+		usernameSpan = Span();
+		textSpan = Span{ 0, static_cast<uint32_t>(value.size()) };
+		itemSpans.clear();
+		receivedNs = 0;
+	}
+};
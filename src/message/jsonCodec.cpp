@@ -0,0 +1,58 @@
+#include "jsonCodec.h"
+
+void JsonCodec::appendString(std::string& out, std::string_view value) {
+	static const char hex[] = "0123456789abcdef";
+
+	out += '"';
+	size_t runStart = 0;
+	for (size_t i = 0; i < value.size(); ++i) {
+		unsigned char c = value[i];
+		if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+		// Flush the unescaped run, then the escape
+		out.append(value.data() + runStart, i - runStart);
+		runStart = i + 1;
+		switch (c) {
+			case '"': out += "\\\""; break;
+			case '\\': out += "\\\\"; break;
+			case '\n': out += "\\n"; break;
+			case '\r': out += "\\r"; break;
+			case '\t': out += "\\t"; break;
+			case '\b': out += "\\b"; break;
+			case '\f': out += "\\f"; break;
+			default:
+				out += "\\u00";
+				out += hex[c >> 4];
+				out += hex[c & 0xF];
+		}
+	}
+	out.append(value.data() + runStart, value.size() - runStart);
+	out += '"';
+}
+
+void JsonCodec::encodeFrame(const OutboundMessage& message, std::string& out) const {
+	out.reserve(32 + message.text.size() + message.room.size() + message.username.size());
+	out += "{\"type\":\"";
+	out += message.typeName();
+	out += '"';
+
+	switch (message.type) {
+		case OutboundMessage::Type::SendMessage:
+			out += ",\"data\":";
+			appendString(out, message.text);
+			break;
+		case OutboundMessage::Type::JoinRoom:
+			out += ",\"data\":{\"username\":";
+			appendString(out, message.username);
+			out += ",\"room\":";
+			appendString(out, message.room);
+			out += '}';
+			break;
+		case OutboundMessage::Type::GetRoomList: break;
+	}
+	out += '}';
+}
+
+MessageDecoder::Result JsonCodec::decodeFrame(std::string_view frame, InboundEvent& event) const {
+	return MessageDecoder::decode(frame, event);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "wireCodec.h"
+
+// The JSON protocol spoken by JS ChatApp. Frames are written directly, without a DOM.
+class JsonCodec : public WireCodec {
+  public:
+	const char* name() const override { return "json"; }
+	bool isBinary() const override { return false; }
+
+	// Append value as a quoted, escaped JSON string
+	static void appendString(std::string& out, std::string_view value);
+
+  protected:
+	void encodeFrame(const OutboundMessage& message, std::string& out) const override;
+	MessageDecoder::Result decodeFrame(std::string_view frame, InboundEvent& event) const override;
+};
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "inboundEvent.h"
+#include <cstdint>
+#include <cstring>
+
+// Minimal on-demand JSON reader over a mutable buffer.
+// Strings come back as spans relative to the start of the buffer.
+class JsonScanner {
+  public:
+	JsonScanner(char* begin, char* end)
+	  : base(begin)
+	  , pos(begin)
+	  , end(end) {}
+
+	void skipSpace() {
+		while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r'))
+			++pos;
+	}
+
+	bool consume(char c) {
+		skipSpace();
+		if (pos == end || *pos != c) return false;
+		++pos;
+		return true;
+	}
+
+	bool peek(char c) {
+		skipSpace();
+		return pos < end && *pos == c;
+	}
+
+	char* position() const { return pos; }
+	void seek(char* p) { pos = p; }
+
+	// Read a string and unescape it in place (the result is never longer than the source)
+	bool readString(InboundEvent::Span& span) {
+		if (!consume('"')) return false;
+
+		char* out = pos;
+		char* start = pos;
+		while (pos < end) {
+			char c = *pos++;
+			if (c == '"') {
+				span.offset = static_cast<uint32_t>(start - base);
+				span.length = static_cast<uint32_t>(out - start);
+				return true;
+			}
+			if (c != '\\') {
+				*out++ = c;
+				continue;
+			}
+
+			if (pos == end) return false;
+			switch (*pos++) {
+				case '"': *out++ = '"'; break;
+				case '\\': *out++ = '\\'; break;
+				case '/': *out++ = '/'; break;
+				case 'b': *out++ = '\b'; break;
+				case 'f': *out++ = '\f'; break;
+				case 'n': *out++ = '\n'; break;
+				case 'r': *out++ = '\r'; break;
+				case 't': *out++ = '\t'; break;
+				case 'u': {
+					uint32_t cp;
+					if (!readHex4(cp)) return false;
+					// Surrogate pair. A lone surrogate becomes U+FFFD, and whatever escape follows
+					// it is left to be read on its own.
+					if (cp >= 0xD800 && cp <= 0xDBFF) {
+						char* next = pos;
+						uint32_t low = 0;
+						bool paired = end - pos >= 6 && pos[0] == '\\' && pos[1] == 'u';
+						if (paired) {
+							pos += 2;
+							paired = readHex4(low) && low >= 0xDC00 && low <= 0xDFFF;
+						}
+						if (paired) {
+							cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+						} else {
+							pos = next;
+							cp = 0xFFFD;
+						}
+					} else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+						cp = 0xFFFD;
+					}
+					out = encodeUtf8(cp, out);
+					break;
+				}
+				default: return false;
+			}
+		}
+		return false;
+	}
+
+	// Skip any value without modifying the buffer
+	bool skipValue(int depth = 0) {
+		if (depth > 64) return false;
+		skipSpace();
+		if (pos == end) return false;
+
+		switch (*pos) {
+			case '"': return skipString();
+			case '{':
+				++pos;
+				if (consume('}')) return true;
+				do {
+					if (!skipString() || !consume(':') || !skipValue(depth + 1)) return false;
+				} while (consume(','));
+				return consume('}');
+			case '[':
+				++pos;
+				if (consume(']')) return true;
+				do {
+					if (!skipValue(depth + 1)) return false;
+				} while (consume(','));
+				return consume(']');
+			default: {
+				// Number or literal
+				char* start = pos;
+				while (pos < end && !std::strchr(",]} \t\r\n", *pos))
+					++pos;
+				return pos != start;
+			}
+		}
+	}
+
+  private:
+	char* base;
+	char* pos;
+	char* end;
+
+	bool skipString() {
+		if (!consume('"')) return false;
+		while (pos < end) {
+			char c = *pos++;
+			if (c == '"') return true;
+			if (c == '\\' && pos < end) ++pos;
+		}
+		return false;
+	}
+
+	bool readHex4(uint32_t& value) {
+		if (end - pos < 4) return false;
+		value = 0;
+		for (int i = 0; i < 4; ++i) {
+			char c = *pos++;
+			value <<= 4;
+			if (c >= '0' && c <= '9')
+				value |= c - '0';
+			else if (c >= 'a' && c <= 'f')
+				value |= c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F')
+				value |= c - 'A' + 10;
+			else
+				return false;
+		}
+		return true;
+	}
+
+	static char* encodeUtf8(uint32_t cp, char* out) {
+		if (cp < 0x80) {
+			*out++ = static_cast<char>(cp);
+		} else if (cp < 0x800) {
+			*out++ = static_cast<char>(0xC0 | (cp >> 6));
+			*out++ = static_cast<char>(0x80 | (cp & 0x3F));
+		} else if (cp < 0x10000) {
+			*out++ = static_cast<char>(0xE0 | (cp >> 12));
+			*out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+			*out++ = static_cast<char>(0x80 | (cp & 0x3F));
+		} else {
+			*out++ = static_cast<char>(0xF0 | (cp >> 18));
+			*out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+			*out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+			*out++ = static_cast<char>(0x80 | (cp & 0x3F));
+		}
+		return out;
+	}
+};
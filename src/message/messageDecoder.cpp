@@ -0,0 +1,85 @@
+#include "messageDecoder.h"
+#include "jsonScanner.h"
+
+MessageDecoder::Result MessageDecoder::decode(std::string_view frame, InboundEvent& event) {
+	event.buffer.assign(frame.data(), frame.size());
+	event.usernameSpan = InboundEvent::Span();
+	event.textSpan = InboundEvent::Span();
+	event.itemSpans.clear();
+
+	char* begin = &event.buffer[0];
+	JsonScanner scanner(begin, begin + event.buffer.size());
+
+	// First pass: find "type" and remember where "data" starts; the keys may come in any order
+	InboundEvent::Span key, typeSpan;
+	char* data = nullptr;
+	bool haveType = false;
+
+	if (!scanner.consume('{')) return Result::Malformed;
+	if (!scanner.consume('}')) {
+		do {
+			if (!scanner.readString(key) || !scanner.consume(':')) return Result::Malformed;
+
+			std::string_view name = event.view(key);
+			if (name == "type" && scanner.peek('"')) {
+				if (!scanner.readString(typeSpan)) return Result::Malformed;
+				haveType = true;
+			} else {
+				if (name == "data") {
+					scanner.skipSpace();
+					data = scanner.position();
+				}
+				if (!scanner.skipValue()) return Result::Malformed;
+			}
+		} while (scanner.consume(','));
+		if (!scanner.consume('}')) return Result::Malformed;
+	}
+
+	if (!haveType || !data) return Result::Ignored;
+
+	// Second pass: decode "data" according to the type
+	std::string_view type = event.view(typeSpan);
+	scanner.seek(data);
+
+	if (type == "message") {
+		InboundEvent::Span text;
+		if (!scanner.readString(text)) return Result::Ignored;
+
+		assignMessageText(event, text);
+		return Result::Decoded;
+	}
+
+	if (type == "userList" || type == "roomList") {
+		event.type = type == "userList" ? InboundEvent::Type::UserList : InboundEvent::Type::RoomList;
+		if (!scanner.consume('[')) return Result::Ignored;
+		if (scanner.consume(']')) return Result::Decoded;
+
+		do {
+			InboundEvent::Span item;
+			if (scanner.peek('"')) {
+				if (!scanner.readString(item)) return Result::Malformed;
+				event.itemSpans.push_back(item);
+			} else if (!scanner.skipValue()) {
+				return Result::Malformed;
+			}
+		} while (scanner.consume(','));
+		return scanner.consume(']') ? Result::Decoded : Result::Malformed;
+	}
+
+	return Result::Ignored;
+}
+
+void MessageDecoder::assignMessageText(InboundEvent& event, InboundEvent::Span text) {
+	// "username: message" is a chat message, anything else is a system event
+	std::string_view messageText = event.view(text);
+	size_t colonPos = messageText.find(": ");
+	if (colonPos != std::string_view::npos) {
+		event.type = InboundEvent::Type::ChatMessage;
+		event.usernameSpan = InboundEvent::Span{ text.offset, static_cast<uint32_t>(colonPos) };
+		event.textSpan = InboundEvent::Span{ static_cast<uint32_t>(text.offset + colonPos + 2),
+											 static_cast<uint32_t>(text.length - colonPos - 2) };
+	} else {
+		event.type = InboundEvent::Type::SystemEvent;
+		event.textSpan = text;
+	}
+}
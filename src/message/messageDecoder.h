@@ -0,0 +1,20 @@
+#pragma once
+
+#include "inboundEvent.h"
+#include <string_view>
+
+// Decodes server frames ({"type": ..., "data": ...}) straight into an InboundEvent.
+// No DOM is built: the frame is copied once into the event and strings are unescaped in place.
+class MessageDecoder {
+  public:
+	enum class Result {
+		Decoded,
+		Ignored,  // Well-formed, but not a message type the client handles
+		Malformed // Not a JSON object
+	};
+
+	static Result decode(std::string_view frame, InboundEvent& event);
+
+	// Classify the text of a "message" (a span of event.buffer) as a chat message or system event
+	static void assignMessageText(InboundEvent& event, InboundEvent::Span text);
+};
@@ -1,28 +1,28 @@
 #pragma once
 
-#include <functional>
-#include <nlohmann/json.hpp>
-#include <string>
-#include <vector>
-
-using json = nlohmann::json;
+#include "inboundEvent.h"
+#include "wireCodec.h"
+#include <string_view>
 
 class MessageHandler {
   public:
 	virtual ~MessageHandler() = default;
 
-	// Process incoming JSON messages
-	virtual void processMessage(const json& message) = 0;
+	// Process an incoming raw frame, decoded with the connection's codec
+	virtual void processFrame(std::string_view frame, WireCodec& codec) = 0;
+
+	// Process a decoded event (typed entry point, dispatches to the handlers below)
+	virtual void handleEvent(const InboundEvent& event) = 0;
 
 	// Handle chat messages
-	virtual void handleChatMessage(const std::string& username, const std::string& message) = 0;
+	virtual void handleChatMessage(std::string_view username, std::string_view message) = 0;
 
 	// Handle system events
-	virtual void handleSystemEvent(const std::string& event) = 0;
+	virtual void handleSystemEvent(std::string_view event) = 0;
 
 	// Handle user list updates
-	virtual void handleUserListUpdate(const std::vector<std::string>& users) = 0;
+	virtual void handleUserListUpdate(const InboundEvent::ItemList& users) = 0;
 
 	// Handle room list updates
-	virtual void handleRoomListUpdate(const std::vector<std::string>& rooms) = 0;
-};
\ No newline at end of file
+	virtual void handleRoomListUpdate(const InboundEvent::ItemList& rooms) = 0;
+};
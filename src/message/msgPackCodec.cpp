@@ -0,0 +1,247 @@
+#include "msgPackCodec.h"
+
+namespace {
+
+void appendBigEndian(std::string& out, uint64_t value, int bytes) {
+	for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8)
+		out += static_cast<char>((value >> shift) & 0xFF);
+}
+
+// Bounds-checked MessagePack reader over the event buffer
+class Reader {
+  public:
+	Reader(const char* begin, const char* end)
+	  : base(begin)
+	  , pos(begin)
+	  , end(end) {}
+
+	bool readString(InboundEvent::Span& span) {
+		uint8_t tag;
+		uint64_t length;
+		if (!readByte(tag)) return false;
+
+		if ((tag & 0xE0) == 0xA0)
+			length = tag & 0x1F;
+		else if (tag == 0xD9 || tag == 0xDA || tag == 0xDB) {
+			if (!readUint(length, 1 << (tag - 0xD9))) return false;
+		} else
+			return false;
+
+		if (static_cast<uint64_t>(end - pos) < length) return false;
+		span.offset = static_cast<uint32_t>(pos - base);
+		span.length = static_cast<uint32_t>(length);
+		pos += length;
+		return true;
+	}
+
+	bool readMapHeader(uint64_t& size) { return readContainerHeader(size, 0x80, 0xDE); }
+	bool readArrayHeader(uint64_t& size) { return readContainerHeader(size, 0x90, 0xDC); }
+
+	bool nextIsString() const {
+		if (pos == end) return false;
+		uint8_t tag = static_cast<uint8_t>(*pos);
+		return (tag & 0xE0) == 0xA0 || tag == 0xD9 || tag == 0xDA || tag == 0xDB;
+	}
+
+	bool skipValue(int depth = 0) {
+		uint8_t tag;
+		if (depth > 64 || !readByte(tag)) return false;
+
+		if (tag <= 0x7F || tag >= 0xE0 || tag == 0xC0 || tag == 0xC2 || tag == 0xC3) return true; // fixint, nil, bool
+		if ((tag & 0xE0) == 0xA0) return skip(tag & 0x1F);                                      // fixstr
+		if ((tag & 0xF0) == 0x80) return skipEntries((tag & 0x0F) * 2ull, depth);               // fixmap
+		if ((tag & 0xF0) == 0x90) return skipEntries(tag & 0x0F, depth);                        // fixarray
+
+		uint64_t length;
+		switch (tag) {
+			case 0xCC: case 0xD0: return skip(1);
+			case 0xCD: case 0xD1: return skip(2);
+			case 0xCA: case 0xCE: case 0xD2: return skip(4);
+			case 0xCB: case 0xCF: case 0xD3: return skip(8);
+			case 0xD4: return skip(2); // fixext 1..16 (type byte + data)
+			case 0xD5: return skip(3);
+			case 0xD6: return skip(5);
+			case 0xD7: return skip(9);
+			case 0xD8: return skip(17);
+			case 0xC4: case 0xD9: return readUint(length, 1) && skip(length);
+			case 0xC5: case 0xDA: return readUint(length, 2) && skip(length);
+			case 0xC6: case 0xDB: return readUint(length, 4) && skip(length);
+			case 0xC7: return readUint(length, 1) && skip(length + 1);
+			case 0xC8: return readUint(length, 2) && skip(length + 1);
+			case 0xC9: return readUint(length, 4) && skip(length + 1);
+			case 0xDC: return readUint(length, 2) && skipEntries(length, depth);
+			case 0xDD: return readUint(length, 4) && skipEntries(length, depth);
+			case 0xDE: return readUint(length, 2) && skipEntries(length * 2, depth);
+			case 0xDF: return readUint(length, 4) && skipEntries(length * 2, depth);
+			default: return false;
+		}
+	}
+
+  private:
+	const char* base;
+	const char* pos;
+	const char* end;
+
+	bool readByte(uint8_t& value) {
+		if (pos == end) return false;
+		value = static_cast<uint8_t>(*pos++);
+		return true;
+	}
+
+	bool readUint(uint64_t& value, int bytes) {
+		if (end - pos < bytes) return false;
+		value = 0;
+		for (int i = 0; i < bytes; ++i)
+			value = (value << 8) | static_cast<uint8_t>(*pos++);
+		return true;
+	}
+
+	bool skip(uint64_t bytes) {
+		if (static_cast<uint64_t>(end - pos) < bytes) return false;
+		pos += bytes;
+		return true;
+	}
+
+	bool skipEntries(uint64_t count, int depth) {
+		for (uint64_t i = 0; i < count; ++i)
+			if (!skipValue(depth + 1)) return false;
+		return true;
+	}
+
+	bool readContainerHeader(uint64_t& size, uint8_t fixBase, uint8_t tag16) {
+		uint8_t tag;
+		if (!readByte(tag)) return false;
+		if ((tag & 0xF0) == fixBase) {
+			size = tag & 0x0F;
+			return true;
+		}
+		if (tag == tag16) return readUint(size, 2);
+		if (tag == tag16 + 1) return readUint(size, 4);
+		return false;
+	}
+};
+
+} // namespace
+
+void MsgPackCodec::appendString(std::string& out, std::string_view value) {
+	size_t size = value.size();
+	if (size < 32) {
+		out += static_cast<char>(0xA0 | size);
+	} else if (size <= 0xFF) {
+		out += static_cast<char>(0xD9);
+		appendBigEndian(out, size, 1);
+	} else if (size <= 0xFFFF) {
+		out += static_cast<char>(0xDA);
+		appendBigEndian(out, size, 2);
+	} else {
+		out += static_cast<char>(0xDB);
+		appendBigEndian(out, size, 4);
+	}
+	out.append(value.data(), size);
+}
+
+void MsgPackCodec::appendMapHeader(std::string& out, uint32_t size) {
+	if (size < 16) {
+		out += static_cast<char>(0x80 | size);
+	} else if (size <= 0xFFFF) {
+		out += static_cast<char>(0xDE);
+		appendBigEndian(out, size, 2);
+	} else {
+		out += static_cast<char>(0xDF);
+		appendBigEndian(out, size, 4);
+	}
+}
+
+void MsgPackCodec::appendArrayHeader(std::string& out, uint32_t size) {
+	if (size < 16) {
+		out += static_cast<char>(0x90 | size);
+	} else if (size <= 0xFFFF) {
+		out += static_cast<char>(0xDC);
+		appendBigEndian(out, size, 2);
+	} else {
+		out += static_cast<char>(0xDD);
+		appendBigEndian(out, size, 4);
+	}
+}
+
+void MsgPackCodec::encodeFrame(const OutboundMessage& message, std::string& out) const {
+	out.reserve(32 + message.text.size() + message.room.size() + message.username.size());
+	bool hasData = message.type != OutboundMessage::Type::GetRoomList;
+
+	appendMapHeader(out, hasData ? 2 : 1);
+	appendString(out, "type");
+	appendString(out, message.typeName());
+	if (!hasData) return;
+
+	appendString(out, "data");
+	if (message.type == OutboundMessage::Type::SendMessage) {
+		appendString(out, message.text);
+	} else {
+		appendMapHeader(out, 2);
+		appendString(out, "username");
+		appendString(out, message.username);
+		appendString(out, "room");
+		appendString(out, message.room);
+	}
+}
+
+MessageDecoder::Result MsgPackCodec::decodeFrame(std::string_view frame, InboundEvent& event) const {
+	event.buffer.assign(frame.data(), frame.size());
+	event.usernameSpan = InboundEvent::Span();
+	event.textSpan = InboundEvent::Span();
+	event.itemSpans.clear();
+
+	const char* begin = event.buffer.data();
+	Reader reader(begin, begin + event.buffer.size());
+
+	// Find "type" and the position of "data"; the keys may come in any order
+	uint64_t entries;
+	if (!reader.readMapHeader(entries)) return MessageDecoder::Result::Malformed;
+
+	InboundEvent::Span key, typeSpan;
+	Reader data = reader;
+	bool haveType = false, haveData = false;
+	for (uint64_t i = 0; i < entries; ++i) {
+		if (!reader.readString(key)) return MessageDecoder::Result::Malformed;
+
+		std::string_view name = event.view(key);
+		if (name == "type" && reader.nextIsString()) {
+			if (!reader.readString(typeSpan)) return MessageDecoder::Result::Malformed;
+			haveType = true;
+			continue;
+		}
+		if (name == "data") {
+			data = reader;
+			haveData = true;
+		}
+		if (!reader.skipValue()) return MessageDecoder::Result::Malformed;
+	}
+	if (!haveType || !haveData) return MessageDecoder::Result::Ignored;
+
+	std::string_view type = event.view(typeSpan);
+	if (type == "message") {
+		InboundEvent::Span text;
+		if (!data.readString(text)) return MessageDecoder::Result::Ignored;
+		MessageDecoder::assignMessageText(event, text);
+		return MessageDecoder::Result::Decoded;
+	}
+
+	if (type == "userList" || type == "roomList") {
+		event.type = type == "userList" ? InboundEvent::Type::UserList : InboundEvent::Type::RoomList;
+
+		uint64_t count;
+		if (!data.readArrayHeader(count)) return MessageDecoder::Result::Ignored;
+		for (uint64_t i = 0; i < count; ++i) {
+			InboundEvent::Span item;
+			if (data.nextIsString()) {
+				if (!data.readString(item)) return MessageDecoder::Result::Malformed;
+				event.itemSpans.push_back(item);
+			} else if (!data.skipValue()) {
+				return MessageDecoder::Result::Malformed;
+			}
+		}
+		return MessageDecoder::Result::Decoded;
+	}
+
+	return MessageDecoder::Result::Ignored;
+}
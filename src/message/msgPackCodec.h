@@ -0,0 +1,19 @@
+#pragma once
+
+#include "wireCodec.h"
+
+// The same {type, data} messages encoded as MessagePack maps in binary frames,
+// for servers that support it. Strings are raw bytes, so decoding needs no unescaping.
+class MsgPackCodec : public WireCodec {
+  public:
+	const char* name() const override { return "msgpack"; }
+	bool isBinary() const override { return true; }
+
+	static void appendString(std::string& out, std::string_view value);
+	static void appendMapHeader(std::string& out, uint32_t size);
+	static void appendArrayHeader(std::string& out, uint32_t size);
+
+  protected:
+	void encodeFrame(const OutboundMessage& message, std::string& out) const override;
+	MessageDecoder::Result decodeFrame(std::string_view frame, InboundEvent& event) const override;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+
+// A client -> server request, serialized by a WireCodec on the sender thread
+struct OutboundMessage {
+	enum class Type { SendMessage, JoinRoom, GetRoomList };
+
+	Type type = Type::SendMessage;
+	std::string text;     // SendMessage
+	std::string room;     // JoinRoom
+	std::string username; // JoinRoom
+
+	static OutboundMessage chat(const std::string& text) {
+		OutboundMessage message;
+		message.type = Type::SendMessage;
+		message.text = text;
+		return message;
+	}
+
+	static OutboundMessage joinRoom(const std::string& room, const std::string& username) {
+		OutboundMessage message;
+		message.type = Type::JoinRoom;
+		message.room = room;
+		message.username = username;
+		return message;
+	}
+
+	static OutboundMessage roomListRequest() {
+		OutboundMessage message;
+		message.type = Type::GetRoomList;
+		return message;
+	}
+
+	// Protocol name of the type
+	const char* typeName() const {
+		switch (type) {
+			case Type::SendMessage: return "sendMessage";
+			case Type::JoinRoom: return "joinRoom";
+			case Type::GetRoomList: return "getRoomList";
+		}
+		return "";
+	}
+
+	bool operator==(const OutboundMessage& other) const {
+		return type == other.type && text == other.text && room == other.room && username == other.username;
+	}
+};
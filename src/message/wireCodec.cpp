@@ -0,0 +1,48 @@
+#include "wireCodec.h"
+#include "jsonCodec.h"
+#include "msgPackCodec.h"
+#include "../metrics/metrics.h"
+#include <chrono>
+
+std::unique_ptr<WireCodec> WireCodec::create(const std::string& name) {
+	if (name == "json") return std::make_unique<JsonCodec>();
+	if (name == "msgpack") return std::make_unique<MsgPackCodec>();
+	return nullptr;
+}
+
+void WireCodec::encode(const OutboundMessage& message, std::string& out) {
+	auto start = std::chrono::steady_clock::now();
+	out.clear();
+	encodeFrame(message, out);
+	uint64_t elapsedNs =
+	  std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	framesEncoded.fetch_add(1, std::memory_order_relaxed);
+	bytesEncoded.fetch_add(out.size(), std::memory_order_relaxed);
+	encodeNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+	Metrics::get().encodeNs.record(elapsedNs);
+}
+
+MessageDecoder::Result WireCodec::decode(std::string_view frame, InboundEvent& event) {
+	auto start = std::chrono::steady_clock::now();
+	MessageDecoder::Result result = decodeFrame(frame, event);
+	uint64_t elapsedNs =
+	  std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	framesDecoded.fetch_add(1, std::memory_order_relaxed);
+	bytesDecoded.fetch_add(frame.size(), std::memory_order_relaxed);
+	decodeNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+	Metrics::get().decodeNs.record(elapsedNs);
+	return result;
+}
+
+WireCodec::Stats WireCodec::getStats() const {
+	Stats stats;
+	stats.framesEncoded = framesEncoded;
+	stats.bytesEncoded = bytesEncoded;
+	stats.encodeNs = encodeNs;
+	stats.framesDecoded = framesDecoded;
+	stats.bytesDecoded = bytesDecoded;
+	stats.decodeNs = decodeNs;
+	return stats;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "inboundEvent.h"
+#include "messageDecoder.h"
+#include "outboundMessage.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Serialization of the chat protocol on the wire. encode() runs on the sender thread and
+// decode() on the network thread; both are timed so codecs can be compared.
+class WireCodec {
+  public:
+	struct Stats {
+		uint64_t framesEncoded = 0;
+		uint64_t bytesEncoded = 0;
+		uint64_t encodeNs = 0;
+		uint64_t framesDecoded = 0;
+		uint64_t bytesDecoded = 0;
+		uint64_t decodeNs = 0;
+	};
+
+	virtual ~WireCodec() = default;
+
+	// "json" or "msgpack"; returns nullptr for an unknown name
+	static std::unique_ptr<WireCodec> create(const std::string& name);
+
+	virtual const char* name() const = 0;
+
+	// Whether frames are sent as binary WebSocket messages
+	virtual bool isBinary() const = 0;
+
+	// Serialize into out (cleared first, capacity reused)
+	void encode(const OutboundMessage& message, std::string& out);
+
+	// Decode a frame into event (see MessageDecoder for the result meaning)
+	MessageDecoder::Result decode(std::string_view frame, InboundEvent& event);
+
+	Stats getStats() const;
+
+  protected:
+	virtual void encodeFrame(const OutboundMessage& message, std::string& out) const = 0;
+	virtual MessageDecoder::Result decodeFrame(std::string_view frame, InboundEvent& event) const = 0;
+
+  private:
+	std::atomic<uint64_t> framesEncoded{ 0 }, bytesEncoded{ 0 }, encodeNs{ 0 };
+	std::atomic<uint64_t> framesDecoded{ 0 }, bytesDecoded{ 0 }, decodeNs{ 0 };
+};
@@ -0,0 +1,60 @@
+#include "latencyHistogram.h"
+
+size_t LatencyHistogram::bucketOf(uint64_t value) {
+	if (value < 16) return value;
+
+	int msb = 63 - __builtin_clzll(value);
+	size_t bucket = (msb - 3) * 16 + ((value >> (msb - 4)) & 15);
+	return bucket < bucketCount ? bucket : bucketCount - 1;
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(size_t bucket) {
+	if (bucket < 16) return bucket;
+
+	int msb = bucket / 16 + 3;
+	return (uint64_t(16 + bucket % 16)) << (msb - 4);
+}
+
+void LatencyHistogram::record(uint64_t value) {
+	counts[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+	sum.fetch_add(value, std::memory_order_relaxed);
+
+	uint64_t previous = max.load(std::memory_order_relaxed);
+	while (value > previous && !max.compare_exchange_weak(previous, value, std::memory_order_relaxed)) {
+	}
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+	Snapshot result;
+	for (size_t i = 0; i < bucketCount; ++i) {
+		result.counts[i] = counts[i].load(std::memory_order_relaxed);
+		result.total += result.counts[i];
+	}
+	result.sum = sum.load(std::memory_order_relaxed);
+	result.max = max.load(std::memory_order_relaxed);
+	return result;
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double fraction) const {
+	if (total == 0) return 0;
+
+	uint64_t target = static_cast<uint64_t>(fraction * total);
+	if (target == 0) target = 1;
+
+	uint64_t seen = 0;
+	for (size_t i = 0; i < bucketCount; ++i) {
+		seen += counts[i];
+		if (seen >= target) return bucketLowerBound(i);
+	}
+	return max;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::Snapshot::operator-(const Snapshot& since) const {
+	Snapshot result;
+	for (size_t i = 0; i < bucketCount; ++i)
+		result.counts[i] = counts[i] - since.counts[i];
+	result.total = total - since.total;
+	result.sum = sum - since.sum;
+	result.max = max;
+	return result;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Log-linear histogram of durations in any integer unit (the name of the metric says which):
+// 16 linear steps per power of two, so any percentile is within ~6% of the recorded value.
+// record() is lock-free and thread-safe.
+class LatencyHistogram {
+  public:
+	static constexpr size_t bucketCount = 16 * 40;
+
+	struct Snapshot {
+		std::array<uint64_t, bucketCount> counts{};
+		uint64_t total = 0;
+		uint64_t sum = 0;
+		uint64_t max = 0;
+
+		// Smallest recorded value with at least fraction of samples at or below it
+		uint64_t percentile(double fraction) const;
+
+		// Samples recorded between since and this snapshot (max covers the whole run)
+		Snapshot operator-(const Snapshot& since) const;
+	};
+
+	void record(uint64_t value);
+	Snapshot snapshot() const;
+
+  private:
+	std::array<std::atomic<uint64_t>, bucketCount> counts{};
+	std::atomic<uint64_t> sum{ 0 };
+	std::atomic<uint64_t> max{ 0 };
+
+	static size_t bucketOf(uint64_t value);
+	static uint64_t bucketLowerBound(size_t bucket);
+};
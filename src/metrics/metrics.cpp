@@ -0,0 +1,169 @@
+#include "metrics.h"
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+std::string formatNs(uint64_t ns) {
+	std::ostringstream out;
+	out << std::fixed;
+	if (ns < 1000)
+		out << ns << "ns";
+	else if (ns < 1000000)
+		out << std::setprecision(1) << ns / 1e3 << "us";
+	else
+		out << std::setprecision(1) << ns / 1e6 << "ms";
+	return out.str();
+}
+
+std::string formatBytes(uint64_t bytes) {
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(1);
+	if (bytes < 1024)
+		out << bytes << " B";
+	else if (bytes < 1024 * 1024)
+		out << bytes / 1024.0 << " KiB";
+	else
+		out << bytes / (1024.0 * 1024) << " MiB";
+	return out.str();
+}
+
+// "p50 X p99 Y max Z" of a histogram in nanoseconds
+std::string formatPercentiles(const LatencyHistogram::Snapshot& snapshot, uint64_t scaleToNs) {
+	if (snapshot.total == 0) return "no samples";
+	return "p50 " + formatNs(snapshot.percentile(0.5) * scaleToNs) + " p99 " +
+		   formatNs(snapshot.percentile(0.99) * scaleToNs) + " max " + formatNs(snapshot.max * scaleToNs) + " (" +
+		   std::to_string(snapshot.total) + ")";
+}
+
+void writeHeader(std::ostream& out, const char* name, const char* type, const char* help) {
+	out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n';
+}
+
+void writeValue(std::ostream& out, const char* name, const char* type, const char* help, uint64_t value) {
+	writeHeader(out, name, type, help);
+	out << name << ' ' << value << '\n';
+}
+
+// Histogram as a Prometheus summary in seconds; labels is empty or "name=\"value\","
+void writeSummary(std::ostream& out, const char* name, const std::string& labels,
+				  const LatencyHistogram::Snapshot& snapshot, double unitSeconds) {
+	for (double quantile : { 0.5, 0.9, 0.99, 0.999 })
+		out << name << '{' << labels << "quantile=\"" << quantile << "\"} "
+			<< snapshot.percentile(quantile) * unitSeconds << '\n';
+
+	std::string plainLabels = labels.empty() ? "" : "{" + labels.substr(0, labels.size() - 1) + "}";
+	out << name << "_sum" << plainLabels << ' ' << snapshot.sum * unitSeconds << '\n';
+	out << name << "_count" << plainLabels << ' ' << snapshot.total << '\n';
+}
+
+} // namespace
+
+Metrics& Metrics::get() {
+	static Metrics metrics;
+	return metrics;
+}
+
+Metrics::Metrics()
+  : startNs(nowNs()) {}
+
+uint64_t Metrics::nowNs() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+	  .count();
+}
+
+LatencyHistogram& Metrics::drawTime(const std::string& element) {
+	std::lock_guard<std::mutex> lock(drawTimesMutex);
+	for (auto& entry : drawTimes)
+		if (entry.first == element) return entry.second;
+
+	drawTimes.emplace_back(std::piecewise_construct, std::forward_as_tuple(element), std::forward_as_tuple());
+	return drawTimes.back().second;
+}
+
+void Metrics::messageArrived(uint64_t receivedNs) {
+	if (receivedNs > 0) awaitingScreen.push_back(receivedNs);
+}
+
+void Metrics::screenUpdated() {
+	if (awaitingScreen.empty()) return;
+
+	uint64_t now = nowNs();
+	for (uint64_t receivedNs : awaitingScreen)
+		messageToScreenUs.record(now > receivedNs ? (now - receivedNs) / 1000 : 0);
+	awaitingScreen.clear();
+}
+
+std::vector<std::string> Metrics::summary() {
+	double uptime = (nowNs() - startNs) / 1e9;
+	if (uptime <= 0) uptime = 1;
+
+	std::vector<std::string> lines;
+	lines.push_back("Network: " + std::to_string(framesIn.load()) + " frames in (" + formatBytes(bytesIn) + "), " +
+					std::to_string(framesOut.load()) + " frames out (" + formatBytes(bytesOut) + "), " +
+					std::to_string(reconnects.load()) + " reconnects");
+	lines.push_back("Decode: " + formatPercentiles(decodeNs.snapshot(), 1));
+	lines.push_back("Encode: " + formatPercentiles(encodeNs.snapshot(), 1));
+	lines.push_back("Sanitized texts: " + std::to_string(textsSanitized.load()));
+	lines.push_back("Inbound queue: depth " + std::to_string(inboundQueueDepth.load()) + ", high water " +
+					std::to_string(inboundQueueHighWater.load()) + ", dropped " +
+					std::to_string(inboundDropped.load()) + "; send queue depth " +
+					std::to_string(sendQueueDepth.load()));
+
+	std::ostringstream redrawRate;
+	redrawRate << std::fixed << std::setprecision(1) << redraws / uptime;
+	lines.push_back("Redraws: " + std::to_string(redraws.load()) + " (" + redrawRate.str() + "/s)");
+	lines.push_back("Frames: " + std::to_string(frames.load()) + ", skipped " + std::to_string(framesSkipped.load()) +
+					", coalesced updates " + std::to_string(updatesCoalesced.load()) + "; frame time " +
+					formatPercentiles(frameNs.snapshot(), 1));
+
+	{
+		std::lock_guard<std::mutex> lock(drawTimesMutex);
+		for (auto& entry : drawTimes)
+			lines.push_back("Draw " + entry.first + ": " + formatPercentiles(entry.second.snapshot(), 1));
+	}
+
+	lines.push_back("Message to screen: " + formatPercentiles(messageToScreenUs.snapshot(), 1000));
+	return lines;
+}
+
+void Metrics::writePrometheus(std::ostream& out) {
+	writeValue(out, "chat_frames_received_total", "counter", "WebSocket frames received", framesIn);
+	writeValue(out, "chat_bytes_received_total", "counter", "Payload bytes received", bytesIn);
+	writeValue(out, "chat_frames_sent_total", "counter", "WebSocket frames sent", framesOut);
+	writeValue(out, "chat_bytes_sent_total", "counter", "Payload bytes sent", bytesOut);
+	writeValue(out, "chat_reconnects_total", "counter", "Successful reconnects after a drop", reconnects);
+
+	writeHeader(out, "chat_decode_seconds", "summary", "Time to decode one frame");
+	writeSummary(out, "chat_decode_seconds", "", decodeNs.snapshot(), 1e-9);
+	writeHeader(out, "chat_encode_seconds", "summary", "Time to encode one frame");
+	writeSummary(out, "chat_encode_seconds", "", encodeNs.snapshot(), 1e-9);
+	writeValue(out, "chat_texts_sanitized_total", "counter", "Inbound texts with control characters removed",
+			   textsSanitized);
+
+	writeValue(out, "chat_inbound_queue_depth", "gauge", "Events waiting when the UI last drained",
+			   inboundQueueDepth);
+	writeValue(out, "chat_inbound_queue_high_water", "gauge", "Deepest inbound queue seen", inboundQueueHighWater);
+	writeValue(out, "chat_inbound_dropped_total", "counter", "Events dropped by a full inbound queue",
+			   inboundDropped);
+	writeValue(out, "chat_send_queue_depth", "gauge", "Outbound messages waiting to be sent", sendQueueDepth);
+	writeValue(out, "chat_redraws_total", "counter", "Screen updates that redrew any element", redraws);
+
+	writeValue(out, "chat_frames_total", "counter", "Frames drawn by the render scheduler", frames);
+	writeValue(out, "chat_frames_skipped_total", "counter", "Frame slots lost to frames longer than the budget",
+			   framesSkipped);
+	writeValue(out, "chat_updates_coalesced_total", "counter", "Changes left for the next frame", updatesCoalesced);
+	writeHeader(out, "chat_frame_seconds", "summary", "Time to draw one frame");
+	writeSummary(out, "chat_frame_seconds", "", frameNs.snapshot(), 1e-9);
+
+	writeHeader(out, "chat_draw_seconds", "summary", "Time to draw one UI element");
+	{
+		std::lock_guard<std::mutex> lock(drawTimesMutex);
+		for (auto& entry : drawTimes)
+			writeSummary(out, "chat_draw_seconds", "element=\"" + entry.first + "\",", entry.second.snapshot(), 1e-9);
+	}
+
+	writeHeader(out, "chat_message_to_screen_seconds", "summary", "Time from receiving a message to showing it");
+	writeSummary(out, "chat_message_to_screen_seconds", "", messageToScreenUs.snapshot(), 1e-6);
+}
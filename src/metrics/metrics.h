@@ -0,0 +1,73 @@
+#pragma once
+
+#include "latencyHistogram.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Process-wide instrumentation of the network, parsing and UI layers. Counters and histograms
+// are updated lock-free from any thread; the summary and the Prometheus text can be rendered
+// from any thread as well.
+class Metrics {
+  public:
+	static Metrics& get();
+
+	static uint64_t nowNs();
+
+	// Network (sender worker and IXWebSocket threads)
+	std::atomic<uint64_t> framesIn{ 0 }, bytesIn{ 0 };
+	std::atomic<uint64_t> framesOut{ 0 }, bytesOut{ 0 };
+	std::atomic<uint64_t> reconnects{ 0 };
+
+	// Codec time per frame, nanoseconds
+	LatencyHistogram decodeNs;
+	LatencyHistogram encodeNs;
+
+	// Inbound texts that had escape sequences, control characters or invalid UTF-8 removed (UI thread)
+	std::atomic<uint64_t> textsSanitized{ 0 };
+
+	// Queue gauges, refreshed by the UI thread whenever it drains
+	std::atomic<uint64_t> inboundQueueDepth{ 0 }; // Events waiting when the last drain started
+	std::atomic<uint64_t> inboundQueueHighWater{ 0 };
+	std::atomic<uint64_t> inboundDropped{ 0 };
+	std::atomic<uint64_t> sendQueueDepth{ 0 };
+
+	// UI
+	std::atomic<uint64_t> redraws{ 0 }; // refreshElements() passes that drew anything
+	LatencyHistogram messageToScreenUs;  // Frame received until the screen update showing it
+
+	// Render scheduler
+	std::atomic<uint64_t> frames{ 0 };
+	std::atomic<uint64_t> framesSkipped{ 0 };    // Frame slots lost to frames longer than the budget
+	std::atomic<uint64_t> updatesCoalesced{ 0 }; // Changes left for the next frame instead of drawn at once
+	LatencyHistogram frameNs;
+
+	// Draw time of one UI element, nanoseconds; the reference stays valid
+	LatencyHistogram& drawTime(const std::string& element);
+
+	// UI thread: a shown message is waiting for the next screen update
+	void messageArrived(uint64_t receivedNs);
+
+	// UI thread: the screen was updated
+	void screenUpdated();
+
+	// Human-readable summary for /stats, one line per entry
+	std::vector<std::string> summary();
+
+	// Prometheus text exposition format
+	void writePrometheus(std::ostream& out);
+
+  private:
+	Metrics();
+
+	uint64_t startNs;
+
+	std::mutex drawTimesMutex;
+	std::deque<std::pair<std::string, LatencyHistogram>> drawTimes; // Stable references
+
+	std::vector<uint64_t> awaitingScreen; // UI thread only
+};
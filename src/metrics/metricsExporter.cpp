@@ -0,0 +1,45 @@
+#include "metricsExporter.h"
+#include "metrics.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+MetricsExporter::MetricsExporter(const std::string& path, unsigned intervalSecs)
+  : path(path)
+  , intervalSecs(intervalSecs > 0 ? intervalSecs : 1)
+  , stopping(false)
+  , thread(&MetricsExporter::loop, this) {}
+
+MetricsExporter::~MetricsExporter() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_one();
+	thread.join();
+}
+
+void MetricsExporter::loop() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!stopping) {
+		lock.unlock();
+		write();
+		lock.lock();
+		wake.wait_for(lock, std::chrono::seconds(intervalSecs), [this] { return stopping; });
+	}
+	// Final values on exit
+	lock.unlock();
+	write();
+}
+
+void MetricsExporter::write() {
+	// Write next to the target and rename, so a scraper never sees a partial file
+	std::string temporary = path + ".tmp";
+	{
+		std::ofstream out(temporary, std::ios::trunc);
+		if (!out) return;
+		Metrics::get().writePrometheus(out);
+		if (!out) return;
+	}
+	std::rename(temporary.c_str(), path.c_str());
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Rewrites a file with Metrics in Prometheus text format on an interval, for node_exporter's
+// textfile collector or any scraper that reads files. The file is replaced atomically.
+class MetricsExporter {
+  public:
+	MetricsExporter(const std::string& path, unsigned intervalSecs);
+	~MetricsExporter();
+
+  private:
+	std::string path;
+	unsigned intervalSecs;
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping;
+	std::thread thread;
+
+	void loop();
+	void write();
+};
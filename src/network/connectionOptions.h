@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Tunables for a WebSocketManager connection
+struct ConnectionOptions {
+	std::string codec = "json"; // Wire format, see WireCodec::create
+
+	// Outbound queue
+	size_t sendQueueCapacity = 1024;    // Frames beyond this are rejected
+	size_t sendHighWaterMark = 64;      // Pending frames at which sendMessage reports backpressure
+	size_t sendBatchSize = 32;          // Frames the sender worker takes per wakeup
+	size_t socketBufferLimit = 256 * 1024; // Bytes buffered in the socket before the worker waits
+
+	// Reconnection: delay doubles per failed attempt, with random jitter of up to half the delay
+	uint32_t reconnectMinDelayMs = 500;
+	uint32_t reconnectMaxDelayMs = 30000;
+	size_t outboxCapacity = 256; // Frames kept while offline
+	int pingIntervalSecs = 30;   // Detects dead connections; 0 disables
+
+	// permessage-deflate, offered to the server in the handshake
+	bool compression = false;
+	uint8_t clientMaxWindowBits = 15; // 9..15, smaller windows use less memory per connection
+	uint8_t serverMaxWindowBits = 15;
+	bool clientNoContextTakeover = false; // Reset the compressor after each frame
+	bool serverNoContextTakeover = false;
+	// IXWebSocket compresses every frame once deflate is negotiated, so frames below this
+	// size are reported separately to show what compression costs on small messages
+	size_t compressionMinSize = 64;
+};
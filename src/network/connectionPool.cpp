@@ -0,0 +1,53 @@
+#include "connectionPool.h"
+
+ConnectionPool::ConnectionPool(const std::string& url, const ConnectionOptions& options, size_t warmConnections)
+  : url(url)
+  , options(options)
+  , warmConnections(warmConnections)
+  , created(0) {}
+
+ConnectionPool::~ConnectionPool() {
+	for (auto& connection : idle)
+		connection->disconnect();
+}
+
+std::unique_ptr<WebSocketManager> ConnectionPool::acquire() {
+	std::unique_ptr<WebSocketManager> connection;
+	if (idle.empty()) {
+		connection = open();
+	} else {
+		connection = std::move(idle.back());
+		idle.pop_back();
+	}
+
+	refill();
+	return connection;
+}
+
+void ConnectionPool::release(std::unique_ptr<WebSocketManager> connection) {
+	if (!connection) return;
+
+	// Closing the socket is the only way to leave a room
+	connection->disconnect();
+	connection->resetSession();
+	connection->setMessageCallback(nullptr);
+	connection->setStatusCallback(nullptr);
+	connection->setConnectionStatusCallback(nullptr);
+
+	if (idle.size() < warmConnections) {
+		connection->connect();
+		idle.push_back(std::move(connection));
+	}
+}
+
+std::unique_ptr<WebSocketManager> ConnectionPool::open() {
+	created++;
+	return std::make_unique<WebSocketManager>(url, options);
+}
+
+void ConnectionPool::refill() {
+	while (idle.size() < warmConnections) {
+		idle.push_back(open());
+		idle.back()->connect();
+	}
+}
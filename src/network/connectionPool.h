@@ -0,0 +1,37 @@
+#pragma once
+
+#include "connectionOptions.h"
+#include "webSocketManager.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Hands out connections to room sessions. The protocol allows one room per connection, so a
+// released connection is closed (leaving its room on the server) and, if the pool is below its
+// warm target, reopened as an idle connection that the next join can use without a handshake.
+class ConnectionPool {
+  public:
+	ConnectionPool(const std::string& url, const ConnectionOptions& options, size_t warmConnections);
+	~ConnectionPool();
+
+	// An idle connection if one is warm, otherwise a new one. Set the callbacks, then call
+	// connect() (a no-op for a warm connection). A warm connection may already be open, in which
+	// case no callback reports it: check isConnected() after setting them.
+	std::unique_ptr<WebSocketManager> acquire();
+
+	// Close a connection that is no longer used by a session
+	void release(std::unique_ptr<WebSocketManager> connection);
+
+	size_t idleCount() const { return idle.size(); }
+	size_t createdCount() const { return created; }
+
+  private:
+	std::string url;
+	ConnectionOptions options;
+	size_t warmConnections;
+	size_t created;
+	std::vector<std::unique_ptr<WebSocketManager>> idle;
+
+	std::unique_ptr<WebSocketManager> open();
+	void refill();
+};
@@ -1,93 +1,412 @@
 #include "webSocketManager.h"
+#include "../metrics/metrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
 
-WebSocketManager::WebSocketManager(const std::string& url)
+namespace {
+
+// Bounds of the wait before resending after the socket refused a frame without disconnecting
+const uint32_t minSendRetryMs = 10;
+const uint32_t maxSendRetryMs = 1000;
+
+// Set while this thread is inside webSocket.stop(). IXWebSocket may report the close from the
+// calling thread; consumers (such as a session's SPSC ring) must only hear from its own thread.
+thread_local bool stoppingSocket = false;
+
+void stopSocket(ix::WebSocket& webSocket) {
+	stoppingSocket = true;
+	webSocket.stop();
+	stoppingSocket = false;
+}
+
+} // namespace
+
+WebSocketManager::WebSocketManager(const std::string& url, const ConnectionOptions& options)
   : url(url)
-  , connected(false) {}
+  , options(options)
+  , codec(WireCodec::create(options.codec))
+  , connected(false)
+  , state(State::Idle)
+  , failedAttempts(0)
+  , jitter(std::random_device{}())
+  , inFlight(0)
+  , sendRetryMs(0)
+  , hasSessionMessage(false)
+  , sessionMessagePending(false) {
+	if (!codec) codec = WireCodec::create("json");
+}
 
 WebSocketManager::~WebSocketManager() {
 	disconnect();
 }
 
 bool WebSocketManager::connect() {
-	if (connected) return true;
+	std::lock_guard<std::mutex> lock(mutex);
+	if (state != State::Idle && state != State::Stopped) return true;
 
 	webSocket.setUrl(url);
-	setupWebSocketCallbacks();
-	webSocket.start();
-
-	// Wait for connection
-	for (int i = 0; i < 50; i++) {
-		if (webSocket.getReadyState() == ix::ReadyState::Open) {
-			connected = true;
-			if (onConnectionStatus) onConnectionStatus(true);
-			return true;
-		}
-		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	webSocket.disableAutomaticReconnection(); // The worker owns the retry policy
+	if (options.pingIntervalSecs > 0) webSocket.setPingInterval(options.pingIntervalSecs);
+	if (options.compression) {
+		auto windowBits = [](uint8_t bits) { return std::min<uint8_t>(std::max<uint8_t>(bits, 9), 15); };
+		webSocket.setPerMessageDeflateOptions(
+		  ix::WebSocketPerMessageDeflateOptions(true, options.clientNoContextTakeover, options.serverNoContextTakeover,
+												windowBits(options.clientMaxWindowBits),
+												windowBits(options.serverMaxWindowBits)));
+	} else {
+		webSocket.setPerMessageDeflateOptions(ix::WebSocketPerMessageDeflateOptions(false));
 	}
+	setupWebSocketCallbacks();
 
-	if (onStatus) onStatus("Failed to connect to server");
-	return false;
+	// The worker performs the first attempt right away
+	state = State::Backoff;
+	reconnectAt = Clock::now();
+	if (!workerThread.joinable()) workerThread = std::thread(&WebSocketManager::workerLoop, this);
+	wakeWorker.notify_one();
+	return true;
 }
 
 void WebSocketManager::disconnect() {
-	if (!connected) return;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (state == State::Idle || state == State::Stopped) return;
+		state = State::Stopped;
+	}
+	connected = false; // Also releases a worker waiting for the socket to drain
+	wakeWorker.notify_all();
+	if (workerThread.joinable()) workerThread.join();
 
-	webSocket.stop();
-	connected = false;
-	if (onConnectionStatus) onConnectionStatus(false);
+	stopSocket(webSocket);
 }
 
 bool WebSocketManager::isConnected() const {
 	return connected;
 }
 
-bool WebSocketManager::sendMessage(const json& message) {
-	if (!connected) return false;
-	return sendRawMessage(message.dump());
+WebSocketManager::State WebSocketManager::getState() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return state;
 }
 
-bool WebSocketManager::sendRawMessage(const std::string& message) {
-	if (!connected) return false;
-	webSocket.send(message);
-	return true;
+WebSocketManager::SendResult WebSocketManager::sendMessage(const OutboundMessage& message) {
+	PendingFrame frame;
+	frame.message = message;
+	return enqueue(std::move(frame));
+}
+
+WebSocketManager::SendResult WebSocketManager::sendRawMessage(const std::string& message) {
+	PendingFrame frame;
+	frame.text = message;
+	frame.raw = true;
+	return enqueue(std::move(frame));
+}
+
+void WebSocketManager::setSessionMessage(const OutboundMessage& message) {
+	std::lock_guard<std::mutex> lock(mutex);
+	sessionMessage = message;
+	hasSessionMessage = true;
+	sessionMessagePending = true;
+	wakeWorker.notify_one();
+}
+
+WebSocketManager::SendResult WebSocketManager::enqueue(PendingFrame&& frame) {
+	std::lock_guard<std::mutex> lock(mutex);
+	bool online = state == State::Connected;
+	size_t depth = sendQueue.size() + inFlight;
+	size_t limit = online ? options.sendQueueCapacity : std::min(options.outboxCapacity, options.sendQueueCapacity);
+
+	// A pending room list request already covers this one
+	if (!frame.raw && frame.message.type == OutboundMessage::Type::GetRoomList)
+		for (const auto& pending : sendQueue)
+			if (!pending.raw && pending.message == frame.message) {
+				sendStats.coalesced++;
+				return online ? SendResult::Queued : SendResult::Offline;
+			}
+
+	if (depth >= limit) {
+		sendStats.rejected++;
+		return SendResult::Rejected;
+	}
+
+	frame.enqueued = Clock::now();
+	sendQueue.push_back(std::move(frame));
+	depth++;
+
+	sendStats.queueDepth = depth;
+	if (depth > sendStats.peakQueueDepth) sendStats.peakQueueDepth = depth;
+	wakeWorker.notify_one();
+
+	if (!online) return SendResult::Offline;
+	return depth > options.sendHighWaterMark ? SendResult::Backpressure : SendResult::Queued;
+}
+
+WebSocketManager::SendStats WebSocketManager::getSendStats() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return sendStats;
+}
+
+WebSocketManager::ConnectionStats WebSocketManager::getConnectionStats() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return connectionStats;
+}
+
+WebSocketManager::CompressionStats WebSocketManager::getCompressionStats() const {
+	CompressionStats stats;
+	stats.enabled = options.compression;
+	stats.negotiated = wire.negotiated;
+	stats.framesOut = wire.framesOut;
+	stats.rawBytesOut = wire.rawBytesOut;
+	stats.wireBytesOut = wire.wireBytesOut;
+	stats.smallFramesOut = wire.smallFramesOut;
+	stats.smallRawBytesOut = wire.smallRawBytesOut;
+	stats.smallWireBytesOut = wire.smallWireBytesOut;
+	stats.framesIn = wire.framesIn;
+	stats.rawBytesIn = wire.rawBytesIn;
+	stats.wireBytesIn = wire.wireBytesIn;
+	return stats;
+}
+
+void WebSocketManager::countSent(const ix::WebSocketSendInfo& info) {
+	wire.framesOut.fetch_add(1, std::memory_order_relaxed);
+	wire.rawBytesOut.fetch_add(info.payloadSize, std::memory_order_relaxed);
+	wire.wireBytesOut.fetch_add(info.wireSize, std::memory_order_relaxed);
+	Metrics::get().framesOut.fetch_add(1, std::memory_order_relaxed);
+	Metrics::get().bytesOut.fetch_add(info.wireSize, std::memory_order_relaxed);
+
+	if (info.payloadSize < options.compressionMinSize) {
+		wire.smallFramesOut.fetch_add(1, std::memory_order_relaxed);
+		wire.smallRawBytesOut.fetch_add(info.payloadSize, std::memory_order_relaxed);
+		wire.smallWireBytesOut.fetch_add(info.wireSize, std::memory_order_relaxed);
+	}
+}
+
+void WebSocketManager::workerLoop() {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (state != State::Stopped) {
+		if (state == State::Backoff) {
+			if (Clock::now() < reconnectAt) {
+				wakeWorker.wait_until(lock, reconnectAt);
+				continue;
+			}
+
+			// One attempt per start(); the result arrives as an Open or Error message
+			state = State::Connecting;
+			connectionStats.attempts++;
+			lock.unlock();
+			stopSocket(webSocket);
+			webSocket.start();
+			lock.lock();
+			continue;
+		}
+
+		bool hasWork = sessionMessagePending || !sendQueue.empty();
+		if (state == State::Connected && hasWork) {
+			sendBatch(lock);
+			continue;
+		}
+
+		wakeWorker.wait(lock);
+	}
+}
+
+void WebSocketManager::sendBatch(std::unique_lock<std::mutex>& lock) {
+	std::vector<PendingFrame> batch;
+
+	// The session message (room rejoin) always goes first; queued copies of it are redundant
+	if (sessionMessagePending) {
+		sessionMessagePending = false;
+		if (hasSessionMessage) {
+			auto isSessionMessage = [this](const PendingFrame& f) { return !f.raw && f.message == sessionMessage; };
+			sendQueue.erase(std::remove_if(sendQueue.begin(), sendQueue.end(), isSessionMessage), sendQueue.end());
+			PendingFrame frame;
+			frame.message = sessionMessage;
+			frame.enqueued = Clock::now();
+			batch.push_back(std::move(frame));
+		}
+	}
+
+	// Take everything pending (up to a batch) in one go
+	while (!sendQueue.empty() && batch.size() < options.sendBatchSize) {
+		batch.push_back(std::move(sendQueue.front()));
+		sendQueue.pop_front();
+	}
+	inFlight = batch.size();
+	lock.unlock();
+
+	// Let the socket drain before piling more onto it; the queue backs up meanwhile
+	while (webSocket.bufferedAmount() > options.socketBufferLimit && connected)
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+	uint64_t totalUs = 0, maxUs = 0, lastUs = 0;
+	size_t sent = 0;
+	bool refused = false;
+	for (; sent < batch.size(); ++sent) {
+		auto& frame = batch[sent];
+		if (!connected) break;
+
+		ix::WebSocketSendInfo info;
+		if (frame.raw) {
+			info = webSocket.send(frame.text);
+		} else {
+			codec->encode(frame.message, encodeBuffer);
+			info = webSocket.send(encodeBuffer, codec->isBinary());
+		}
+		if (!info.success) {
+			refused = connected;
+			break;
+		}
+		countSent(info);
+
+		lastUs = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - frame.enqueued).count();
+		totalUs += lastUs;
+		maxUs = std::max(maxUs, lastUs);
+	}
+
+	lock.lock();
+	// Connection dropped mid-batch: put the rest back into the outbox in order
+	for (size_t i = batch.size(); i > sent; --i)
+		sendQueue.push_front(std::move(batch[i - 1]));
+
+	sendStats.framesSent += sent;
+	sendStats.batches++;
+	sendStats.totalLatencyUs += totalUs;
+	if (sent > 0) sendStats.lastLatencyUs = lastUs;
+	sendStats.maxLatencyUs = std::max(sendStats.maxLatencyUs, maxUs);
+	inFlight = 0;
+	sendStats.queueDepth = sendQueue.size();
+
+	if (!refused) {
+		sendRetryMs = 0;
+		return;
+	}
+
+	// The socket is stuck but not closed: retrying at once would spin. Wait longer each time,
+	// unless the connection drops or is stopped meanwhile.
+	sendRetryMs = std::min(std::max(sendRetryMs * 2, minSendRetryMs), maxSendRetryMs);
+	wakeWorker.wait_for(lock, std::chrono::milliseconds(sendRetryMs), [this]() { return state != State::Connected; });
+}
+
+void WebSocketManager::scheduleReconnect() {
+	if (state == State::Stopped || state == State::Backoff) return;
+
+	if (state == State::Connected) {
+		connectionStats.drops++;
+		droppedAt = Clock::now();
+	}
+
+	// Exponential backoff with jitter: delay in [base/2, base]
+	uint64_t base = options.reconnectMinDelayMs;
+	for (uint32_t i = 0; i < failedAttempts && base < options.reconnectMaxDelayMs; ++i)
+		base *= 2;
+	base = std::min<uint64_t>(base, options.reconnectMaxDelayMs);
+	std::uniform_int_distribution<uint64_t> spread(base / 2, base);
+
+	failedAttempts++;
+	state = State::Backoff;
+	reconnectAt = Clock::now() + std::chrono::milliseconds(spread(jitter));
+	wakeWorker.notify_one();
 }
 
 void WebSocketManager::setMessageCallback(MessageCallback callback) {
+	std::lock_guard<std::mutex> lock(callbackMutex);
 	onMessage = callback;
 }
 
 void WebSocketManager::setStatusCallback(StatusCallback callback) {
+	std::lock_guard<std::mutex> lock(callbackMutex);
 	onStatus = callback;
 }
 
 void WebSocketManager::setConnectionStatusCallback(ConnectionStatusCallback callback) {
+	std::lock_guard<std::mutex> lock(callbackMutex);
 	onConnectionStatus = callback;
 }
 
+void WebSocketManager::resetSession() {
+	std::lock_guard<std::mutex> lock(mutex);
+	sendQueue.clear();
+	sessionMessage = OutboundMessage();
+	hasSessionMessage = false;
+	sessionMessagePending = false;
+	sendStats.queueDepth = inFlight;
+}
+
+void WebSocketManager::notifyStatus(const std::string& status) {
+	std::lock_guard<std::mutex> lock(callbackMutex);
+	if (onStatus) onStatus(status);
+}
+
+void WebSocketManager::notifyConnectionStatus(bool isConnected) {
+	std::lock_guard<std::mutex> lock(callbackMutex);
+	if (onConnectionStatus) onConnectionStatus(isConnected);
+}
+
 void WebSocketManager::setupWebSocketCallbacks() {
 	webSocket.setOnMessageCallback(
 	  [this](const ix::WebSocketMessagePtr& msg) { handleWebSocketMessage(msg); });
 }
 
+// Runs on the IXWebSocket thread. Callbacks are only invoked from here so consumers see a single producer.
 void WebSocketManager::handleWebSocketMessage(const ix::WebSocketMessagePtr& msg) {
+	// Delivered inside our own stop(), on the worker or UI thread: the socket is already closed
+	// or being closed on purpose, so there is nothing to report
+	if (stoppingSocket) return;
+
 	if (msg->type == ix::WebSocketMessageType::Message) {
-		try {
-			json received = json::parse(msg->str);
-			if (onMessage) onMessage(received);
-		} catch (const std::exception& e) {
-			if (onStatus) onStatus("Error parsing message: " + std::string(e.what()));
-		}
+		wire.framesIn.fetch_add(1, std::memory_order_relaxed);
+		wire.rawBytesIn.fetch_add(msg->str.size(), std::memory_order_relaxed);
+		wire.wireBytesIn.fetch_add(msg->wireSize, std::memory_order_relaxed);
+		Metrics::get().framesIn.fetch_add(1, std::memory_order_relaxed);
+		Metrics::get().bytesIn.fetch_add(msg->wireSize, std::memory_order_relaxed);
+
+		// Decoding is left to the consumer, straight into its own storage
+		std::lock_guard<std::mutex> lock(callbackMutex);
+		if (onMessage) onMessage(msg->str, *codec);
 	} else if (msg->type == ix::WebSocketMessageType::Open) {
-		connected = true;
-		if (onStatus) onStatus("Connected to server");
-		if (onConnectionStatus) onConnectionStatus(true);
-	} else if (msg->type == ix::WebSocketMessageType::Error) {
-		connected = false;
-		if (onStatus) onStatus("Connection error: " + msg->errorInfo.reason);
-		if (onConnectionStatus) onConnectionStatus(false);
-	} else if (msg->type == ix::WebSocketMessageType::Close) {
-		connected = false;
-		if (onStatus) onStatus("Connection closed");
-		if (onConnectionStatus) onConnectionStatus(false);
+		std::string status = "Connected to server";
+		wire.negotiated = msg->openInfo.headers.count("Sec-WebSocket-Extensions") > 0 &&
+						  msg->openInfo.headers.at("Sec-WebSocket-Extensions").find("permessage-deflate") != std::string::npos;
+		if (wire.negotiated) status += " (compressed)";
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (state == State::Stopped) return;
+
+			if (connectionStats.drops > 0 && connectionStats.reconnects < connectionStats.drops) {
+				uint64_t recoveryMs =
+				  std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - droppedAt).count();
+				connectionStats.reconnects++;
+				Metrics::get().reconnects.fetch_add(1, std::memory_order_relaxed);
+				connectionStats.lastRecoveryMs = recoveryMs;
+				connectionStats.maxRecoveryMs = std::max(connectionStats.maxRecoveryMs, recoveryMs);
+				connectionStats.totalRecoveryMs += recoveryMs;
+				status = "Reconnected to server after " + std::to_string(recoveryMs) + " ms";
+			}
+
+			state = State::Connected;
+			failedAttempts = 0;
+			connected = true;
+			sessionMessagePending = hasSessionMessage;
+			wakeWorker.notify_one();
+		}
+		notifyStatus(status);
+		notifyConnectionStatus(true);
+	} else if (msg->type == ix::WebSocketMessageType::Error || msg->type == ix::WebSocketMessageType::Close) {
+		std::string reason =
+		  msg->type == ix::WebSocketMessageType::Error ? "Connection error: " + msg->errorInfo.reason : "Connection closed";
+		bool wasConnected = connected.exchange(false);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (state == State::Stopped) return;
+			scheduleReconnect();
+
+			char delay[32];
+			auto waitMs = std::chrono::duration_cast<std::chrono::milliseconds>(reconnectAt - Clock::now()).count();
+			std::snprintf(delay, sizeof(delay), "%.1f", std::max<long long>(waitMs, 0) / 1000.0);
+			reason += ", retrying in " + std::string(delay) + " s";
+		}
+		notifyStatus(reason);
+		if (wasConnected) notifyConnectionStatus(false);
 	}
-}
\ No newline at end of file
+}
@@ -1,44 +1,175 @@
 #pragma once
 
+#include "../message/outboundMessage.h"
+#include "../message/wireCodec.h"
+#include "connectionOptions.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <ixwebsocket/IXWebSocket.h>
-#include <nlohmann/json.hpp>
+#include <memory>
+#include <mutex>
+#include <random>
 #include <string>
-
-using json = nlohmann::json;
+#include <string_view>
+#include <thread>
 
 class WebSocketManager {
   public:
-	using MessageCallback = std::function<void(const json&)>;
+	// Receives each inbound frame together with the codec that decodes it
+	using MessageCallback = std::function<void(std::string_view frame, WireCodec& codec)>;
 	using StatusCallback = std::function<void(const std::string&)>;
 	using ConnectionStatusCallback = std::function<void(bool)>;
 
-	WebSocketManager(const std::string& url);
+	// Connection state machine, driven by the worker thread
+	enum class State {
+		Idle,       // connect() not called yet
+		Connecting, // Handshake in progress
+		Connected,
+		Backoff, // Waiting before the next attempt
+		Stopped  // disconnect() called
+	};
+
+	// Outcome of queueing an outbound frame
+	enum class SendResult {
+		Queued,       // Accepted
+		Backpressure, // Accepted, but the queue is above its high-water mark
+		Offline,      // Accepted into the outbox, sent after reconnecting
+		Rejected      // Queue or outbox full, frame dropped
+	};
+
+	// Sender worker statistics
+	struct SendStats {
+		uint64_t framesSent = 0;
+		uint64_t batches = 0;
+		uint64_t coalesced = 0; // Duplicate requests folded into a pending one
+		uint64_t rejected = 0;
+		size_t queueDepth = 0;
+		size_t peakQueueDepth = 0;
+		// Enqueue-to-wire latency
+		uint64_t lastLatencyUs = 0;
+		uint64_t maxLatencyUs = 0;
+		uint64_t totalLatencyUs = 0;
+	};
+
+	// Reconnection statistics
+	struct ConnectionStats {
+		uint64_t attempts = 0;   // Connection attempts, including the first
+		uint64_t reconnects = 0; // Successful opens after a drop
+		uint64_t drops = 0;
+		// Time from losing the connection to having it open again
+		uint64_t lastRecoveryMs = 0;
+		uint64_t maxRecoveryMs = 0;
+		uint64_t totalRecoveryMs = 0;
+	};
+
+	// Bytes before (raw) and after (wire) permessage-deflate, per direction
+	struct CompressionStats {
+		bool enabled = false;    // Offered in the handshake
+		bool negotiated = false; // Accepted by the server on the current connection
+		uint64_t framesOut = 0;
+		uint64_t rawBytesOut = 0;
+		uint64_t wireBytesOut = 0;
+		uint64_t smallFramesOut = 0; // Frames below compressionMinSize
+		uint64_t smallRawBytesOut = 0;
+		uint64_t smallWireBytesOut = 0;
+		uint64_t framesIn = 0;
+		uint64_t rawBytesIn = 0;
+		uint64_t wireBytesIn = 0;
+	};
+
+	WebSocketManager(const std::string& url, const ConnectionOptions& options = ConnectionOptions());
 	~WebSocketManager();
 
-	// Connection management
+	// Connection management; connect() returns immediately and keeps reconnecting in the background
 	bool connect();
 	void disconnect();
 	bool isConnected() const;
+	State getState() const;
+
+	// Queue messages for the sender worker; never blocks on the socket
+	SendResult sendMessage(const OutboundMessage& message);
+	SendResult sendRawMessage(const std::string& message); // Sent as-is in a text frame
+
+	// Frame sent first on every (re)connect, e.g. the last joinRoom. Queued copies are dropped.
+	void setSessionMessage(const OutboundMessage& message);
+
+	WireCodec& getCodec() { return *codec; }
 
-	// Send messages
-	bool sendMessage(const json& message);
-	bool sendRawMessage(const std::string& message);
+	SendStats getSendStats() const;
+	ConnectionStats getConnectionStats() const;
+	CompressionStats getCompressionStats() const;
 
-	// Set callbacks
+	// Forget the session message and anything still queued (before reusing the connection)
+	void resetSession();
+
+	// Set callbacks; safe while connected, the previous callback is not called after this returns
 	void setMessageCallback(MessageCallback callback);
 	void setStatusCallback(StatusCallback callback);
 	void setConnectionStatusCallback(ConnectionStatusCallback callback);
 
   private:
+	using Clock = std::chrono::steady_clock;
+
+	struct PendingFrame {
+		OutboundMessage message; // Serialized by the worker
+		std::string text;        // Pre-serialized frame (sendRawMessage)
+		bool raw = false;
+		Clock::time_point enqueued;
+	};
+
 	ix::WebSocket webSocket;
 	std::string url;
-	bool connected;
+	ConnectionOptions options;
+	std::unique_ptr<WireCodec> codec;
+	std::atomic<bool> connected;
+
+	// Everything below is guarded by mutex and shared with the worker thread
+	mutable std::mutex mutex;
+	std::condition_variable wakeWorker;
+	std::thread workerThread;
 
+	State state;
+	uint32_t failedAttempts;
+	Clock::time_point reconnectAt;
+	Clock::time_point droppedAt;
+	ConnectionStats connectionStats;
+	std::mt19937 jitter;
+
+	std::deque<PendingFrame> sendQueue;
+	size_t inFlight;
+	uint32_t sendRetryMs; // Wait after a refused send while still connected, doubling; 0 after a success
+	OutboundMessage sessionMessage;
+	bool hasSessionMessage;
+	bool sessionMessagePending;
+	SendStats sendStats;
+	std::string encodeBuffer; // Worker only, reused across frames
+
+	// Updated lock-free: outbound from the worker, inbound from the IXWebSocket thread
+	struct WireCounters {
+		std::atomic<bool> negotiated{ false };
+		std::atomic<uint64_t> framesOut{ 0 }, rawBytesOut{ 0 }, wireBytesOut{ 0 };
+		std::atomic<uint64_t> smallFramesOut{ 0 }, smallRawBytesOut{ 0 }, smallWireBytesOut{ 0 };
+		std::atomic<uint64_t> framesIn{ 0 }, rawBytesIn{ 0 }, wireBytesIn{ 0 };
+	} wire;
+
+	// Callbacks run on the IXWebSocket thread under callbackMutex
+	std::mutex callbackMutex;
 	MessageCallback onMessage;
 	StatusCallback onStatus;
 	ConnectionStatusCallback onConnectionStatus;
 
 	void setupWebSocketCallbacks();
 	void handleWebSocketMessage(const ix::WebSocketMessagePtr& msg);
-};
\ No newline at end of file
+	void notifyStatus(const std::string& status);
+	void notifyConnectionStatus(bool isConnected);
+
+	SendResult enqueue(PendingFrame&& frame);
+	void workerLoop();
+	void scheduleReconnect(); // Caller holds mutex
+	void sendBatch(std::unique_lock<std::mutex>& lock);
+	void countSent(const ix::WebSocketSendInfo& info);
+};
@@ -0,0 +1,41 @@
+#include "chatServer.h"
+#include <thread>
+
+ChatServer::ChatServer(const ServerOptions& options)
+  : options(options)
+  , rooms(resolveThreads(options.threads),
+		  [this](size_t worker, uint64_t roomId, const SharedFrame& frame) { workers[worker]->post(roomId, frame); }) {
+	unsigned threads = resolveThreads(options.threads);
+	for (unsigned i = 0; i < threads; ++i)
+		workers.push_back(std::make_unique<ServerWorker>(i, this->options, rooms));
+}
+
+ChatServer::~ChatServer() {
+	stop();
+}
+
+unsigned ChatServer::resolveThreads(unsigned requested) {
+	if (requested > 0) return requested;
+	unsigned cores = std::thread::hardware_concurrency();
+	return cores > 0 ? cores : 1;
+}
+
+bool ChatServer::start() {
+	for (auto& worker : workers)
+		if (!worker->listen()) return false;
+	for (auto& worker : workers)
+		worker->start();
+	return true;
+}
+
+void ChatServer::stop() {
+	for (auto& worker : workers)
+		worker->stop();
+}
+
+size_t ChatServer::connectionCount() const {
+	size_t total = 0;
+	for (const auto& worker : workers)
+		total += worker->connectionCount();
+	return total;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "roomRegistry.h"
+#include "serverOptions.h"
+#include "serverWorker.h"
+#include <memory>
+#include <vector>
+
+// ChatApp-compatible server: a RoomRegistry shared by one ServerWorker per thread
+class ChatServer {
+  public:
+	ChatServer(const ServerOptions& options);
+	~ChatServer();
+
+	// Bind every worker's socket and start the threads; returns false if the port is unavailable
+	bool start();
+	void stop();
+
+	size_t threadCount() const { return workers.size(); }
+	size_t connectionCount() const;
+	size_t roomCount() { return rooms.roomCount(); }
+
+  private:
+	ServerOptions options;
+	RoomRegistry rooms;
+	std::vector<std::unique_ptr<ServerWorker>> workers;
+
+	static unsigned resolveThreads(unsigned requested);
+};
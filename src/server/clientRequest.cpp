@@ -0,0 +1,72 @@
+#include "clientRequest.h"
+#include "../message/jsonScanner.h"
+
+bool ClientRequest::decode(std::string_view frame, ClientRequest& request) {
+	request.buffer.assign(frame.data(), frame.size());
+	request.textSpan = request.roomSpan = request.usernameSpan = InboundEvent::Span();
+
+	char* begin = &request.buffer[0];
+	JsonScanner scanner(begin, begin + request.buffer.size());
+
+	// First pass: find "type" and remember where "data" starts
+	InboundEvent::Span key, typeSpan;
+	char* data = nullptr;
+	bool haveType = false;
+
+	if (!scanner.consume('{')) return false;
+	if (!scanner.consume('}')) {
+		do {
+			if (!scanner.readString(key) || !scanner.consume(':')) return false;
+
+			std::string_view name = request.view(key);
+			if (name == "type" && scanner.peek('"')) {
+				if (!scanner.readString(typeSpan)) return false;
+				haveType = true;
+			} else {
+				if (name == "data") {
+					scanner.skipSpace();
+					data = scanner.position();
+				}
+				if (!scanner.skipValue()) return false;
+			}
+		} while (scanner.consume(','));
+		if (!scanner.consume('}')) return false;
+	}
+	if (!haveType) return false;
+
+	// Second pass: decode "data" according to the type
+	std::string_view type = request.view(typeSpan);
+	if (type == "getRoomList") {
+		request.type = Type::GetRoomList;
+		return true;
+	}
+	if (!data) return false;
+	scanner.seek(data);
+
+	if (type == "sendMessage") {
+		request.type = Type::SendMessage;
+		return scanner.readString(request.textSpan);
+	}
+
+	if (type == "joinRoom") {
+		request.type = Type::JoinRoom;
+		if (!scanner.consume('{')) return false;
+		if (scanner.consume('}')) return false;
+
+		do {
+			if (!scanner.readString(key) || !scanner.consume(':')) return false;
+
+			std::string_view name = request.view(key);
+			if (name == "username" && scanner.peek('"')) {
+				if (!scanner.readString(request.usernameSpan)) return false;
+			} else if (name == "room" && scanner.peek('"')) {
+				if (!scanner.readString(request.roomSpan)) return false;
+			} else if (!scanner.skipValue()) {
+				return false;
+			}
+		} while (scanner.consume(','));
+		return scanner.consume('}') && request.roomSpan.length > 0 && request.usernameSpan.length > 0;
+	}
+
+	return false;
+}
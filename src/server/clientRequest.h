@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../message/inboundEvent.h"
+#include <string>
+#include <string_view>
+
+// A decoded client frame (joinRoom, sendMessage, getRoomList). Like InboundEvent, strings are
+// spans into the request's own copy of the frame, so a reused request decodes without allocating.
+struct ClientRequest {
+	enum class Type { JoinRoom, SendMessage, GetRoomList };
+
+	Type type = Type::GetRoomList;
+	std::string buffer;
+	InboundEvent::Span textSpan;
+	InboundEvent::Span roomSpan;
+	InboundEvent::Span usernameSpan;
+
+	std::string_view view(InboundEvent::Span span) const {
+		return std::string_view(buffer).substr(span.offset, span.length);
+	}
+	std::string_view text() const { return view(textSpan); }
+	std::string_view room() const { return view(roomSpan); }
+	std::string_view username() const { return view(usernameSpan); }
+
+	// Returns false for malformed frames and unknown message types
+	static bool decode(std::string_view frame, ClientRequest& request);
+};
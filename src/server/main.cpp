@@ -0,0 +1,89 @@
+#include "chatServer.h"
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sys/resource.h>
+
+static void printUsage(const char* program) {
+	std::cout << "Usage: " << program << " [options]\n"
+			  << "  --port=N                   Port to listen on (default 8080)\n"
+			  << "  --threads=N                Event loop threads (default: one per core)\n"
+			  << "  --max-message=N            Largest accepted client message in bytes (default 65536)\n"
+			  << "  --max-output=N             Bytes queued for a slow client before it is dropped (default 4 MiB)\n"
+			  << "  --help                     Show this help\n";
+}
+
+// Returns the value of "--name=value" if arg matches name, nullptr otherwise
+static const char* optionValue(const char* arg, const char* name) {
+	size_t len = std::strlen(name);
+	if (std::strncmp(arg, name, len) != 0 || arg[len] != '=') return nullptr;
+	return arg + len + 1;
+}
+
+static bool parseOptions(int argc, char** argv, ServerOptions& options) {
+	for (int i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+		const char* value;
+
+		if (std::strcmp(arg, "--help") == 0) {
+			printUsage(argv[0]);
+			std::exit(0);
+		} else if ((value = optionValue(arg, "--port"))) {
+			unsigned long port = std::strtoul(value, nullptr, 10);
+			if (port == 0 || port > 65535) return false;
+			options.port = port;
+		} else if ((value = optionValue(arg, "--threads"))) {
+			options.threads = std::strtoul(value, nullptr, 10);
+		} else if ((value = optionValue(arg, "--max-message"))) {
+			options.maxMessageSize = std::strtoul(value, nullptr, 10);
+		} else if ((value = optionValue(arg, "--max-output"))) {
+			options.maxOutputBytes = std::strtoul(value, nullptr, 10);
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Tens of thousands of clients need more descriptors than the usual soft limit
+static void raiseFileLimit() {
+	rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &limit);
+	}
+}
+
+int main(int argc, char** argv) {
+	ServerOptions options;
+	if (!parseOptions(argc, argv, options)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	raiseFileLimit();
+	std::signal(SIGPIPE, SIG_IGN);
+
+	// Workers inherit the mask; only this thread waits for the shutdown signals
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+	ChatServer server(options);
+	if (!server.start()) {
+		std::cerr << "Failed to listen on port " << options.port << ": " << std::strerror(errno) << std::endl;
+		return 1;
+	}
+	std::cout << "Listening on port " << options.port << " with " << server.threadCount() << " threads" << std::endl;
+
+	int signal;
+	sigwait(&signals, &signal);
+
+	std::cout << "Shutting down (" << server.connectionCount() << " connections, " << server.roomCount() << " rooms)"
+			  << std::endl;
+	server.stop();
+	return 0;
+}
@@ -0,0 +1,122 @@
+#include "roomRegistry.h"
+#include <algorithm>
+#include <thread>
+
+RoomRegistry::RoomRegistry(size_t workerCount, Deliver deliver)
+  : workerCount(workerCount)
+  , deliver(std::move(deliver)) {}
+
+uint64_t RoomRegistry::join(std::string_view roomName, std::string_view username, uint64_t connectionId,
+							size_t worker) {
+	SharedFrame joined = ServerFrames::message(std::string(username) + " joined the room");
+
+	for (;;) {
+		uint64_t roomId;
+		std::shared_ptr<Room> room;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			auto [idIt, created] = roomIds.try_emplace(std::string(roomName), nextRoomId);
+			roomId = idIt->second;
+			if (created) {
+				nextRoomId++;
+				room = std::make_shared<Room>();
+				room->name = roomName;
+				room->workerMembers.assign(workerCount, 0);
+				rooms.emplace(roomId, room);
+				cachedRoomList.reset();
+			} else {
+				room = rooms.at(roomId);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(room->mutex);
+		if (room->closed) {
+			// The last member just left; wait for the room to be removed, then create it anew
+			std::this_thread::yield();
+			continue;
+		}
+
+		room->members.push_back({ std::string(username), connectionId });
+		room->workerMembers[worker]++;
+
+		broadcast(roomId, *room, joined);
+		broadcast(roomId, *room, userList(*room));
+		return roomId;
+	}
+}
+
+void RoomRegistry::leave(uint64_t roomId, uint64_t connectionId, size_t worker) {
+	std::shared_ptr<Room> room = find(roomId);
+	if (!room) return;
+
+	{
+		std::lock_guard<std::mutex> lock(room->mutex);
+		auto member = std::find_if(room->members.begin(), room->members.end(),
+								   [connectionId](const Member& m) { return m.connectionId == connectionId; });
+		if (member == room->members.end()) return;
+
+		std::string username = std::move(member->username);
+		room->members.erase(member);
+		room->workerMembers[worker]--;
+
+		if (!room->members.empty()) {
+			broadcast(roomId, *room, ServerFrames::message(username + " left the room"));
+			broadcast(roomId, *room, userList(*room));
+			return;
+		}
+		room->closed = true;
+	}
+
+	// Only the member that closed the room removes it; joins in between wait for this
+	std::lock_guard<std::mutex> lock(mutex);
+	roomIds.erase(room->name);
+	rooms.erase(roomId);
+	cachedRoomList.reset();
+}
+
+void RoomRegistry::say(uint64_t roomId, std::string_view username, std::string_view text) {
+	std::shared_ptr<Room> room = find(roomId);
+	if (!room) return;
+
+	SharedFrame frame = ServerFrames::chat(username, text);
+	std::lock_guard<std::mutex> lock(room->mutex);
+	if (!room->closed) broadcast(roomId, *room, frame);
+}
+
+SharedFrame RoomRegistry::roomList() {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (cachedRoomList) return cachedRoomList;
+
+	std::vector<std::string_view> names;
+	names.reserve(rooms.size());
+	for (const auto& entry : rooms)
+		names.push_back(entry.second->name);
+	std::sort(names.begin(), names.end());
+
+	cachedRoomList = ServerFrames::roomList(names);
+	return cachedRoomList;
+}
+
+size_t RoomRegistry::roomCount() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return rooms.size();
+}
+
+std::shared_ptr<RoomRegistry::Room> RoomRegistry::find(uint64_t roomId) {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto roomIt = rooms.find(roomId);
+	return roomIt == rooms.end() ? nullptr : roomIt->second;
+}
+
+void RoomRegistry::broadcast(uint64_t roomId, const Room& room, const SharedFrame& frame) {
+	for (size_t worker = 0; worker < workerCount; ++worker)
+		if (room.workerMembers[worker] > 0) deliver(worker, roomId, frame);
+}
+
+SharedFrame RoomRegistry::userList(const Room& room) {
+	std::vector<std::string_view> users;
+	users.reserve(room.members.size());
+	for (const Member& member : room.members)
+		users.push_back(member.username);
+	return ServerFrames::userList(users);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "serverFrames.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Rooms and their members across all workers. Every broadcast is serialized once and handed
+// to each worker that has members in the room; the worker fans it out to its own connections.
+// The registry lock only covers finding, creating and deleting rooms; each room has its own
+// lock for membership and broadcasts, so busy rooms do not hold each other up.
+class RoomRegistry {
+  public:
+	// Queue a frame for the members of roomId on one worker. Called with the room's lock held,
+	// so every worker sees a room's messages in the same order.
+	using Deliver = std::function<void(size_t worker, uint64_t roomId, const SharedFrame& frame)>;
+
+	RoomRegistry(size_t workerCount, Deliver deliver);
+
+	// Add a member and announce it to the room; returns the room id
+	uint64_t join(std::string_view room, std::string_view username, uint64_t connectionId, size_t worker);
+
+	// Remove a member and announce it; empty rooms are deleted
+	void leave(uint64_t roomId, uint64_t connectionId, size_t worker);
+
+	// Broadcast "username: text" to the room
+	void say(uint64_t roomId, std::string_view username, std::string_view text);
+
+	// Frame listing the current rooms (cached until a room is created or deleted)
+	SharedFrame roomList();
+
+	size_t roomCount();
+
+  private:
+	struct Member {
+		std::string username;
+		uint64_t connectionId;
+	};
+
+	struct Room {
+		std::string name; // Fixed at creation
+
+		// Guarded by mutex
+		std::mutex mutex;
+		std::vector<Member> members;       // In join order
+		std::vector<size_t> workerMembers; // Member count per worker
+		bool closed = false;               // Emptied; removed from the registry right after
+	};
+
+	size_t workerCount;
+	Deliver deliver;
+
+	// Guards the maps below; never held while waiting for a room's lock
+	std::mutex mutex;
+	std::unordered_map<uint64_t, std::shared_ptr<Room>> rooms;
+	std::unordered_map<std::string, uint64_t> roomIds;
+	uint64_t nextRoomId = 1;
+	SharedFrame cachedRoomList;
+
+	std::shared_ptr<Room> find(uint64_t roomId);
+
+	// Room lock must be held
+	void broadcast(uint64_t roomId, const Room& room, const SharedFrame& frame);
+	static SharedFrame userList(const Room& room);
+};
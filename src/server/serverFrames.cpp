@@ -0,0 +1,61 @@
+#include "serverFrames.h"
+#include "../message/jsonCodec.h"
+
+SharedFrame ServerFrames::message(std::string_view text) {
+	std::string payload;
+	payload.reserve(32 + text.size());
+	payload += "{\"type\":\"message\",\"data\":";
+	JsonCodec::appendString(payload, text);
+	payload += '}';
+	return frame(Text, payload);
+}
+
+SharedFrame ServerFrames::chat(std::string_view username, std::string_view text) {
+	std::string line;
+	line.reserve(username.size() + 2 + text.size());
+	line.append(username);
+	line += ": ";
+	line.append(text);
+	return message(line);
+}
+
+SharedFrame ServerFrames::userList(const std::vector<std::string_view>& users) {
+	return list("userList", users);
+}
+
+SharedFrame ServerFrames::roomList(const std::vector<std::string_view>& rooms) {
+	return list("roomList", rooms);
+}
+
+SharedFrame ServerFrames::list(const char* type, const std::vector<std::string_view>& items) {
+	std::string payload = "{\"type\":\"";
+	payload += type;
+	payload += "\",\"data\":[";
+	for (size_t i = 0; i < items.size(); ++i) {
+		if (i > 0) payload += ',';
+		JsonCodec::appendString(payload, items[i]);
+	}
+	payload += "]}";
+	return frame(Text, payload);
+}
+
+SharedFrame ServerFrames::frame(Opcode opcode, std::string_view payload) {
+	auto out = std::make_shared<std::string>();
+	out->reserve(payload.size() + 10);
+
+	out->push_back(static_cast<char>(0x80 | opcode));
+	uint64_t size = payload.size();
+	if (size < 126) {
+		out->push_back(static_cast<char>(size));
+	} else if (size <= 0xFFFF) {
+		out->push_back(126);
+		out->push_back(static_cast<char>(size >> 8));
+		out->push_back(static_cast<char>(size));
+	} else {
+		out->push_back(127);
+		for (int shift = 56; shift >= 0; shift -= 8)
+			out->push_back(static_cast<char>(size >> shift));
+	}
+	out->append(payload);
+	return out;
+}
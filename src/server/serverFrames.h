@@ -0,0 +1,32 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A complete, unmasked WebSocket frame. Broadcasts are serialized once and the same buffer
+// is queued on every recipient connection.
+using SharedFrame = std::shared_ptr<const std::string>;
+
+// Server to client messages of the JS ChatApp protocol, already framed for the wire
+class ServerFrames {
+  public:
+	enum Opcode : uint8_t { Text = 0x1, Binary = 0x2, Close = 0x8, Ping = 0x9, Pong = 0xA };
+
+	// {"type":"message","data":"text"}
+	static SharedFrame message(std::string_view text);
+
+	// {"type":"message","data":"username: text"}
+	static SharedFrame chat(std::string_view username, std::string_view text);
+
+	// {"type":"userList","data":[...]} / {"type":"roomList","data":[...]}
+	static SharedFrame userList(const std::vector<std::string_view>& users);
+	static SharedFrame roomList(const std::vector<std::string_view>& rooms);
+
+	// Wrap a payload in a single final frame
+	static SharedFrame frame(Opcode opcode, std::string_view payload);
+
+  private:
+	static SharedFrame list(const char* type, const std::vector<std::string_view>& items);
+};
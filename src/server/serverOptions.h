@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct ServerOptions {
+	uint16_t port = 8080;
+
+	// Event loop threads, each with its own listening socket (SO_REUSEPORT); 0 = one per core
+	unsigned threads = 0;
+
+	// Largest message a client may send; bigger ones close the connection
+	size_t maxMessageSize = 64 * 1024;
+
+	// Bytes queued for a client before it is considered too slow and disconnected
+	size_t maxOutputBytes = 4 * 1024 * 1024;
+
+	int listenBacklog = 4096;
+};
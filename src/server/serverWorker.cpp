@@ -0,0 +1,277 @@
+#include "serverWorker.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+ServerWorker::ServerWorker(size_t index, const ServerOptions& options, RoomRegistry& rooms)
+  : index(index)
+  , options(options)
+  , rooms(rooms)
+  , listenFd(-1)
+  , epollFd(-1)
+  , spareFd(-1)
+  , running(false)
+  , liveConnections(0)
+  , nextConnectionId(uint64_t(index) << 48) {}
+
+ServerWorker::~ServerWorker() {
+	stop();
+	connections.clear();
+	if (listenFd >= 0) close(listenFd);
+	if (epollFd >= 0) close(epollFd);
+	if (spareFd >= 0) close(spareFd);
+}
+
+bool ServerWorker::listen() {
+	listenFd = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (listenFd < 0) return false;
+
+	// Every worker binds the same port; the kernel spreads incoming connections between them
+	int on = 1, off = 0;
+	setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	setsockopt(listenFd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+	setsockopt(listenFd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+
+	sockaddr_in6 address{};
+	address.sin6_family = AF_INET6;
+	address.sin6_addr = in6addr_any;
+	address.sin6_port = htons(options.port);
+	if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) return false;
+	if (::listen(listenFd, options.listenBacklog) < 0) return false;
+
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if (epollFd < 0) return false;
+	spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+	if (spareFd < 0) return false;
+
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.fd = listenFd;
+	if (epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) < 0) return false;
+	event.data.fd = mailboxReady.fd();
+	return epoll_ctl(epollFd, EPOLL_CTL_ADD, mailboxReady.fd(), &event) == 0;
+}
+
+void ServerWorker::start() {
+	running = true;
+	thread = std::thread(&ServerWorker::loop, this);
+}
+
+void ServerWorker::stop() {
+	if (!running.exchange(false)) return;
+	mailboxReady.notify();
+	if (thread.joinable()) thread.join();
+}
+
+void ServerWorker::post(uint64_t roomId, const SharedFrame& frame) {
+	{
+		std::lock_guard<std::mutex> lock(mailboxMutex);
+		mailbox.push_back({ roomId, frame });
+	}
+	mailboxReady.notify();
+}
+
+void ServerWorker::loop() {
+	epoll_event events[256];
+
+	while (running) {
+		int count = epoll_wait(epollFd, events, 256, -1);
+		if (count < 0 && errno != EINTR) {
+			std::cerr << "Worker " << index << ": epoll_wait failed" << std::endl;
+			break;
+		}
+
+		for (int i = 0; i < count; ++i) {
+			int fd = events[i].data.fd;
+			if (fd == listenFd) {
+				acceptConnections();
+				continue;
+			}
+			if (fd == mailboxReady.fd()) continue; // Drained below
+
+			auto it = connections.find(fd);
+			if (it == connections.end() || it->second->closed) continue;
+			WebSocketConnection& connection = *it->second;
+
+			if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+				if (!connection.handleReadable(*this)) {
+					closeConnection(connection);
+					continue;
+				}
+			}
+			if (events[i].events & EPOLLOUT) {
+				if (!connection.flush()) closeConnection(connection);
+			}
+		}
+
+		// Broadcasts, including those this iteration's messages produced, then one write per connection
+		drainMailbox();
+		flushDirty();
+		reap();
+	}
+}
+
+void ServerWorker::acceptConnections() {
+	// Taken by another thread the last time it was freed
+	if (spareFd < 0) spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+	size_t refused = 0;
+	for (;;) {
+		int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) continue;
+			if ((errno == EMFILE || errno == ENFILE) && spareFd >= 0) {
+				// The listening socket is level-triggered: a connection left pending would wake the
+				// loop forever. Free the spare descriptor to accept and close it, then take it back.
+				close(spareFd);
+				fd = accept(listenFd, nullptr, nullptr);
+				if (fd >= 0) close(fd);
+				spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+				if (fd >= 0) {
+					refused++;
+					continue;
+				}
+			}
+			break;
+		}
+
+		int on = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+		epoll_event event{};
+		event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+		event.data.fd = fd;
+		if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+			close(fd);
+			continue;
+		}
+
+		connections[fd] = std::make_unique<WebSocketConnection>(fd, nextConnectionId++, options.maxMessageSize,
+																options.maxOutputBytes);
+		liveConnections.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (refused > 0)
+		std::cerr << "Worker " << index << ": out of file descriptors, refused " << refused << " connections"
+				  << std::endl;
+}
+
+void ServerWorker::onMessage(WebSocketConnection& connection, std::string_view payload, bool binary) {
+	// Dropped earlier in this read; it must not rejoin a room once closed
+	if (connection.closed) return;
+
+	// The protocol is JSON text frames
+	if (binary || !ClientRequest::decode(payload, request)) return;
+
+	switch (request.type) {
+		case ClientRequest::Type::JoinRoom: joinRoom(connection, request.room(), request.username()); break;
+		case ClientRequest::Type::SendMessage:
+			if (connection.roomId != 0 && !request.text().empty())
+				rooms.say(connection.roomId, connection.username, request.text());
+			break;
+		case ClientRequest::Type::GetRoomList: send(connection, rooms.roomList()); break;
+	}
+}
+
+void ServerWorker::joinRoom(WebSocketConnection& connection, std::string_view room, std::string_view username) {
+	leaveRoom(connection);
+
+	connection.username = username;
+	connection.roomId = rooms.join(room, username, connection.id(), index);
+
+	// The announcement is in our mailbox, so registering locally now still delivers it
+	auto& members = localRooms[connection.roomId];
+	connection.roomSlot = members.size();
+	members.push_back(&connection);
+}
+
+void ServerWorker::leaveRoom(WebSocketConnection& connection) {
+	if (connection.roomId == 0) return;
+
+	// Swap-remove from the local member list
+	auto it = localRooms.find(connection.roomId);
+	if (it != localRooms.end()) {
+		auto& members = it->second;
+		members[connection.roomSlot] = members.back();
+		members[connection.roomSlot]->roomSlot = connection.roomSlot;
+		members.pop_back();
+		// Erased in reap(), the list may be mid-delivery
+		if (members.empty()) emptiedRooms.push_back(connection.roomId);
+	}
+
+	rooms.leave(connection.roomId, connection.id(), index);
+	connection.roomId = 0;
+}
+
+void ServerWorker::drainMailbox() {
+	mailboxReady.clear();
+	{
+		std::lock_guard<std::mutex> lock(mailboxMutex);
+		delivering.swap(mailbox);
+	}
+
+	for (const Delivery& delivery : delivering) {
+		auto it = localRooms.find(delivery.roomId);
+		if (it == localRooms.end()) continue;
+
+		// Index loop: a slow member being dropped swap-removes itself from this vector
+		auto& members = it->second;
+		for (size_t i = 0; i < members.size();) {
+			WebSocketConnection* member = members[i];
+			send(*member, delivery.frame);
+			if (i < members.size() && members[i] == member) ++i;
+		}
+	}
+	delivering.clear();
+}
+
+void ServerWorker::send(WebSocketConnection& connection, const SharedFrame& frame) {
+	if (connection.closed) return;
+	if (!connection.queue(frame)) {
+		// Too far behind: drop it rather than buffer without bound
+		closeConnection(connection);
+		return;
+	}
+	if (!connection.dirty) {
+		connection.dirty = true;
+		dirty.push_back(&connection);
+	}
+}
+
+void ServerWorker::flushDirty() {
+	for (WebSocketConnection* connection : dirty) {
+		connection->dirty = false;
+		if (!connection->closed && !connection->flush()) closeConnection(*connection);
+	}
+	dirty.clear();
+}
+
+void ServerWorker::closeConnection(WebSocketConnection& connection) {
+	if (connection.closed) return;
+
+	// Best effort for a queued close frame or handshake rejection
+	connection.flush();
+	leaveRoom(connection);
+	connection.closed = true;
+	epoll_ctl(epollFd, EPOLL_CTL_DEL, connection.fd(), nullptr);
+	closing.push_back(connection.fd());
+}
+
+void ServerWorker::reap() {
+	for (uint64_t roomId : emptiedRooms) {
+		auto it = localRooms.find(roomId);
+		if (it != localRooms.end() && it->second.empty()) localRooms.erase(it);
+	}
+	emptiedRooms.clear();
+
+	for (int fd : closing) {
+		connections.erase(fd);
+		liveConnections.fetch_sub(1, std::memory_order_relaxed);
+	}
+	closing.clear();
+}
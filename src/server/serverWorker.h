@@ -0,0 +1,78 @@
+#pragma once
+
+#include "../util/eventFd.h"
+#include "clientRequest.h"
+#include "roomRegistry.h"
+#include "serverOptions.h"
+#include "webSocketConnection.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// One event loop thread: its own SO_REUSEPORT listening socket and epoll instance, the
+// connections the kernel assigned to it, and a mailbox for room broadcasts from other workers.
+class ServerWorker : public WebSocketConnection::Listener {
+  public:
+	ServerWorker(size_t index, const ServerOptions& options, RoomRegistry& rooms);
+	~ServerWorker();
+
+	// Bind the listening socket; returns false (errno set) on failure
+	bool listen();
+
+	void start();
+	void stop();
+
+	// Queue a broadcast for this worker's members of a room (thread-safe)
+	void post(uint64_t roomId, const SharedFrame& frame);
+
+	size_t connectionCount() const { return liveConnections.load(std::memory_order_relaxed); }
+
+	void onMessage(WebSocketConnection& connection, std::string_view payload, bool binary) override;
+
+  private:
+	struct Delivery {
+		uint64_t roomId;
+		SharedFrame frame;
+	};
+
+	size_t index;
+	const ServerOptions& options;
+	RoomRegistry& rooms;
+
+	int listenFd;
+	int epollFd;
+	int spareFd; // Held in reserve so connections can be refused when out of descriptors
+	std::thread thread;
+	std::atomic<bool> running;
+
+	// Broadcasts posted by any worker (including this one), drained once per loop iteration
+	EventFd mailboxReady;
+	std::mutex mailboxMutex;
+	std::vector<Delivery> mailbox;
+	std::vector<Delivery> delivering;
+
+	// Loop thread only
+	std::unordered_map<int, std::unique_ptr<WebSocketConnection>> connections;
+	std::unordered_map<uint64_t, std::vector<WebSocketConnection*>> localRooms;
+	std::vector<WebSocketConnection*> dirty; // Connections with output queued since the last flush
+	std::vector<int> closing;                // Closed this iteration, freed after the event batch
+	std::vector<uint64_t> emptiedRooms;      // Local rooms whose last member left this iteration
+	std::atomic<size_t> liveConnections;
+	uint64_t nextConnectionId;
+	ClientRequest request;
+
+	void loop();
+	void acceptConnections();
+	void drainMailbox();
+	void flushDirty();
+	void reap();
+
+	void send(WebSocketConnection& connection, const SharedFrame& frame);
+	void closeConnection(WebSocketConnection& connection);
+
+	void joinRoom(WebSocketConnection& connection, std::string_view room, std::string_view username);
+	void leaveRoom(WebSocketConnection& connection);
+};
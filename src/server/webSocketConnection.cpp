@@ -0,0 +1,280 @@
+#include "webSocketConnection.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <openssl/evp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t maxHeaderSize = 8192;
+const size_t maxFrameHeaderSize = 14; // 64-bit length and mask
+const int maxIovecs = 64;
+
+// Close status codes (RFC 6455 7.4.1)
+const uint16_t protocolError = 1002;
+const uint16_t messageTooBig = 1009;
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+	return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+			   return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+		   });
+}
+
+std::string_view trim(std::string_view value) {
+	while (!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+		value.remove_prefix(1);
+	while (!value.empty() && (value.back() == ' ' || value.back() == '\t'))
+		value.remove_suffix(1);
+	return value;
+}
+
+} // namespace
+
+WebSocketConnection::WebSocketConnection(int fd, uint64_t id, size_t maxMessageSize, size_t maxOutputBytes)
+  : socketFd(fd)
+  , connectionId(id)
+  , maxMessageSize(maxMessageSize)
+  , maxOutputBytes(maxOutputBytes) {}
+
+WebSocketConnection::~WebSocketConnection() {
+	close(socketFd);
+}
+
+bool WebSocketConnection::handleReadable(Listener& listener) {
+	char chunk[64 * 1024];
+
+	// Edge triggered: drain the socket, handling each chunk before reading the next so a client
+	// sending faster than its frames complete cannot grow readBuffer past one message
+	for (;;) {
+		ssize_t bytes = read(socketFd, chunk, sizeof(chunk));
+		if (bytes > 0) {
+			readBuffer.append(chunk, bytes);
+			if (!handleInput(listener)) return false;
+			continue;
+		}
+		if (bytes < 0 && errno == EINTR) continue;
+		if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+		return false; // Closed by the peer; what arrived before was already handled
+	}
+}
+
+bool WebSocketConnection::handleInput(Listener& listener) {
+	size_t offset = 0;
+	if (!handshakeDone) {
+		size_t headerEnd = readBuffer.find("\r\n\r\n");
+		if (headerEnd == std::string::npos) return readBuffer.size() <= maxHeaderSize;
+		if (!handleHandshake(headerEnd)) return false;
+		offset = headerEnd + 4;
+	}
+
+	bool open = parseFrames(offset, listener);
+	readBuffer.erase(0, offset);
+
+	// Only an incomplete frame is left, and frames above maxMessageSize were refused
+	if (open && readBuffer.size() > maxMessageSize + maxFrameHeaderSize) {
+		queueClose(messageTooBig);
+		return false;
+	}
+	return open;
+}
+
+bool WebSocketConnection::handleHandshake(size_t headerEnd) {
+	std::string_view request(readBuffer.data(), headerEnd);
+	if (request.compare(0, 4, "GET ") != 0) return false;
+
+	std::string_view key;
+	bool upgrade = false;
+	size_t lineStart = request.find("\r\n");
+	while (lineStart != std::string_view::npos) {
+		lineStart += 2;
+		size_t lineEnd = request.find("\r\n", lineStart);
+		std::string_view line = request.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd;
+
+		size_t colon = line.find(':');
+		if (colon == std::string_view::npos) continue;
+		std::string_view name = trim(line.substr(0, colon));
+		std::string_view value = trim(line.substr(colon + 1));
+
+		if (equalsIgnoreCase(name, "Sec-WebSocket-Key"))
+			key = value;
+		else if (equalsIgnoreCase(name, "Upgrade"))
+			upgrade = equalsIgnoreCase(value, "websocket");
+	}
+
+	if (!upgrade || key.empty()) {
+		static const std::string badRequest = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n";
+		ssize_t written = write(socketFd, badRequest.data(), badRequest.size());
+		(void)written; // Closing anyway
+		return false;
+	}
+
+	std::string response = "HTTP/1.1 101 Switching Protocols\r\n"
+						   "Upgrade: websocket\r\n"
+						   "Connection: Upgrade\r\n"
+						   "Sec-WebSocket-Accept: ";
+	response += acceptKey(key);
+	response += "\r\n\r\n";
+
+	// Nothing else can be queued before the handshake, so the response goes first
+	handshakeDone = true;
+	return queue(std::make_shared<const std::string>(std::move(response)));
+}
+
+std::string WebSocketConnection::acceptKey(std::string_view key) {
+	static const char guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+	std::string input(key);
+	input += guid;
+
+	unsigned char digest[EVP_MAX_MD_SIZE];
+	unsigned int digestLength = 0;
+	EVP_Digest(input.data(), input.size(), digest, &digestLength, EVP_sha1(), nullptr);
+
+	unsigned char encoded[64];
+	int encodedLength = EVP_EncodeBlock(encoded, digest, digestLength);
+	return std::string(reinterpret_cast<char*>(encoded), encodedLength);
+}
+
+bool WebSocketConnection::parseFrames(size_t& offset, Listener& listener) {
+	for (;;) {
+		size_t available = readBuffer.size() - offset;
+		if (available < 2) return true;
+
+		unsigned char* header = reinterpret_cast<unsigned char*>(&readBuffer[offset]);
+		bool fin = header[0] & 0x80;
+		uint8_t opcode = header[0] & 0x0F;
+		bool masked = header[1] & 0x80;
+		uint64_t length = header[1] & 0x7F;
+
+		// Client frames must be masked
+		if (!masked) return false;
+
+		size_t headerSize = 2;
+		if (length == 126) {
+			if (available < 4) return true;
+			length = (uint64_t(header[2]) << 8) | header[3];
+			headerSize = 4;
+		} else if (length == 127) {
+			if (available < 10) return true;
+			length = 0;
+			for (int i = 0; i < 8; ++i)
+				length = (length << 8) | header[2 + i];
+			headerSize = 10;
+		}
+		if (length > maxMessageSize || fragments.size() + length > maxMessageSize) {
+			queueClose(messageTooBig);
+			return false;
+		}
+
+		// Control frames are never fragmented and carry at most 125 bytes
+		if ((opcode & 0x08) && (!fin || length > 125)) {
+			queueClose(protocolError);
+			return false;
+		}
+
+		headerSize += 4;
+		if (available < headerSize + length) return true;
+
+		const unsigned char* mask = header + headerSize - 4;
+		char* payload = &readBuffer[offset + headerSize];
+		for (uint64_t i = 0; i < length; ++i)
+			payload[i] ^= mask[i & 3];
+		std::string_view data(payload, length);
+		offset += headerSize + length;
+
+		switch (opcode) {
+			case 0x0: // Continuation
+				if (!fragmented) {
+					queueClose(protocolError);
+					return false;
+				}
+				fragments.append(data);
+				if (fin) {
+					listener.onMessage(*this, fragments, fragmentsBinary);
+					fragments.clear();
+					fragmented = false;
+					if (closed) return false;
+				}
+				break;
+			case ServerFrames::Text:
+			case ServerFrames::Binary:
+				// A new message may not start inside a fragmented one
+				if (fragmented) {
+					queueClose(protocolError);
+					return false;
+				}
+				if (fin) {
+					listener.onMessage(*this, data, opcode == ServerFrames::Binary);
+					// The listener dropped the connection; the rest of the buffer is not handled
+					if (closed) return false;
+				} else {
+					fragments.assign(data);
+					fragmented = true;
+					fragmentsBinary = opcode == ServerFrames::Binary;
+				}
+				break;
+			case ServerFrames::Ping:
+				if (!queue(ServerFrames::frame(ServerFrames::Pong, data))) return false;
+				break;
+			case ServerFrames::Pong: break;
+			case ServerFrames::Close:
+				// Echo the status code, then let the worker flush and close
+				queue(ServerFrames::frame(ServerFrames::Close, data.substr(0, 2)));
+				return false;
+			default:
+				queueClose(protocolError);
+				return false;
+		}
+	}
+}
+
+void WebSocketConnection::queueClose(uint16_t code) {
+	char status[2] = { static_cast<char>(code >> 8), static_cast<char>(code & 0xFF) };
+	queue(ServerFrames::frame(ServerFrames::Close, std::string_view(status, sizeof(status))));
+}
+
+bool WebSocketConnection::queue(const SharedFrame& frame) {
+	if (outputBytes + frame->size() > maxOutputBytes) return false;
+
+	output.push_back(frame);
+	outputBytes += frame->size();
+	return true;
+}
+
+bool WebSocketConnection::flush() {
+	while (!output.empty()) {
+		// Gather queued frames into one writev
+		iovec iov[maxIovecs];
+		int count = 0;
+		for (auto it = output.begin(); it != output.end() && count < maxIovecs; ++it, ++count) {
+			size_t skip = count == 0 ? outputOffset : 0;
+			iov[count].iov_base = const_cast<char*>((*it)->data() + skip);
+			iov[count].iov_len = (*it)->size() - skip;
+		}
+
+		ssize_t written = writev(socketFd, iov, count);
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+		}
+
+		// Release fully written frames
+		size_t remaining = written;
+		outputBytes -= remaining;
+		while (remaining > 0) {
+			size_t left = output.front()->size() - outputOffset;
+			if (remaining < left) {
+				outputOffset += remaining;
+				break;
+			}
+			remaining -= left;
+			outputOffset = 0;
+			output.pop_front();
+		}
+	}
+	return true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "serverFrames.h"
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+
+// Server side of one WebSocket: handshake, frame parsing and a queue of shared outgoing frames.
+// Owned and used by a single ServerWorker thread.
+class WebSocketConnection {
+  public:
+	class Listener {
+	  public:
+		virtual ~Listener() = default;
+		// A complete text or binary message arrived
+		virtual void onMessage(WebSocketConnection& connection, std::string_view payload, bool binary) = 0;
+	};
+
+	WebSocketConnection(int fd, uint64_t id, size_t maxMessageSize, size_t maxOutputBytes);
+	~WebSocketConnection();
+
+	WebSocketConnection(const WebSocketConnection&) = delete;
+	WebSocketConnection& operator=(const WebSocketConnection&) = delete;
+
+	// Read until the socket would block and dispatch complete messages.
+	// Returns false when the connection should be closed.
+	bool handleReadable(Listener& listener);
+
+	// Queue a frame; returns false if the client is too far behind and should be dropped
+	bool queue(const SharedFrame& frame);
+
+	// Write as much queued output as the socket takes; returns false on a write error
+	bool flush();
+
+	bool hasPendingOutput() const { return !output.empty(); }
+
+	int fd() const { return socketFd; }
+	uint64_t id() const { return connectionId; }
+
+	// Room membership, maintained by the worker
+	uint64_t roomId = 0;
+	size_t roomSlot = 0;
+	std::string username;
+
+	// Worker bookkeeping
+	bool closed = false;
+	bool dirty = false;
+
+  private:
+	int socketFd;
+	uint64_t connectionId;
+	size_t maxMessageSize;
+	size_t maxOutputBytes;
+
+	bool handshakeDone = false;
+	std::string readBuffer;
+	std::string fragments;
+	bool fragmented = false; // A message's first frame arrived without FIN
+	bool fragmentsBinary = false;
+
+	std::deque<SharedFrame> output;
+	size_t outputOffset = 0; // Bytes of output.front() already written
+	size_t outputBytes = 0;
+
+	// Handle the handshake or frames in readBuffer and drop what was consumed; returns false
+	// when the connection should be closed
+	bool handleInput(Listener& listener);
+
+	// Returns false if the request is not a valid WebSocket upgrade
+	bool handleHandshake(size_t headerEnd);
+
+	// Parse frames from readBuffer[offset...]; returns false on a protocol error, a close, or
+	// when the listener closed the connection
+	bool parseFrames(size_t& offset, Listener& listener);
+
+	// Queue a close frame with a status code before the connection is dropped
+	void queueClose(uint16_t code);
+
+	static std::string acceptKey(std::string_view key);
+};
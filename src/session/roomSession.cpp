@@ -0,0 +1,284 @@
+#include "roomSession.h"
+#include "../metrics/metrics.h"
+#include "../util/displayText.h"
+#include <algorithm>
+
+RoomSession::RoomSession(std::unique_ptr<WebSocketManager> connection, size_t queueCapacity, OverflowPolicy overflow,
+						 const ChatHistory::Limits& historyLimits, const RoomLogOptions& logOptions, EventFd& wakeup,
+						 SessionListener& listener)
+  : connection(std::move(connection))
+  , logOptions(logOptions)
+  , history(historyLimits)
+  , unread(0)
+  , active(false)
+  , inboundQueue(queueCapacity, overflow)
+  , wakeup(wakeup)
+  , listener(listener)
+  , connectedOnArrival(false)
+  , batchAppended(0) {
+
+	// Network thread callbacks
+	this->connection->setMessageCallback(
+	  [this](std::string_view frame, WireCodec& codec) { processFrame(frame, codec); });
+	this->connection->setStatusCallback(
+	  [this](const std::string& status) { enqueueText(InboundEvent::Type::SystemEvent, status); });
+	this->connection->setConnectionStatusCallback(
+	  [this](bool connected) { enqueueText(InboundEvent::Type::Status, connectionStatus(connected)); });
+
+	// A warm connection from the pool opened before these callbacks were set, so nothing will
+	// report it. The next drain() does; pushing into the ring from this thread would give it a
+	// second producer.
+	if (this->connection->isConnected()) {
+		connectedOnArrival = true;
+		wakeup.notify();
+	}
+	this->connection->connect();
+}
+
+RoomSession::~RoomSession() {
+	// Unblock the network thread if it is waiting on a full queue, then stop it
+	inboundQueue.close();
+	if (connection) connection->disconnect();
+}
+
+void RoomSession::join(const std::string& roomName, const std::string& user) {
+	room = roomName;
+	username = user;
+
+	if (!log && !logOptions.directory.empty()) {
+		log = std::make_unique<RoomLog>(logOptions, roomName);
+		if (log->isOpen()) {
+			history.attachArchive(*log);
+		} else if (log->inUse()) {
+			history.attachArchive(*log);
+			history.addSystemMessage("Another session is logging this room; lines shown here are not logged again");
+		} else {
+			history.addSystemMessage("Could not open the chat log in " + logOptions.directory);
+		}
+	}
+
+	// The join is the session message: sent before anything else now and after every reconnect
+	connection->setSessionMessage(OutboundMessage::joinRoom(roomName, user));
+}
+
+std::unique_ptr<WebSocketManager> RoomSession::releaseConnection() {
+	inboundQueue.close();
+	if (connection) connection->disconnect();
+	return std::move(connection);
+}
+
+void RoomSession::setActive(bool value) {
+	active = value;
+	if (active) unread = 0;
+}
+
+void RoomSession::processFrame(std::string_view frame, WireCodec& codec) {
+	// Network thread: decode straight into a free ring slot and wake the UI loop, never touch the UI here
+	InboundEvent* event = inboundQueue.beginPush();
+	if (!event) {
+		wakeup.notify(); // Let the UI report the drop
+		return;
+	}
+
+	uint64_t receivedNs = Metrics::nowNs();
+	switch (codec.decode(frame, *event)) {
+		case MessageDecoder::Result::Decoded: break;
+		case MessageDecoder::Result::Ignored: return; // Slot is reused for the next frame
+		case MessageDecoder::Result::Malformed:
+			event->setText(InboundEvent::Type::SystemEvent, "Error parsing message");
+			break;
+	}
+
+	event->receivedNs = receivedNs;
+	inboundQueue.commitPush();
+	wakeup.notify();
+}
+
+const char* RoomSession::connectionStatus(bool connected) {
+	return connected ? "Connected" : "Connection lost, reconnecting...";
+}
+
+void RoomSession::enqueueText(InboundEvent::Type type, std::string_view text) {
+	InboundEvent* event = inboundQueue.beginPush();
+	if (event) {
+		event->setText(type, text);
+		inboundQueue.commitPush();
+	}
+	wakeup.notify();
+}
+
+bool RoomSession::drain() {
+	// Before anything queued, all of which happened after the callbacks were set
+	bool reported = connectedOnArrival;
+	if (reported) {
+		connectedOnArrival = false;
+		listener.onStatus(*this, connectionStatus(true));
+	}
+
+	// Everything queued so far is one batch; events arriving meanwhile wake the UI again
+	size_t count = inboundQueue.available();
+	if (count == 0) return reported;
+
+	// Lists replace each other, so only the last of each kind needs applying
+	size_t lastUserList = count, lastRoomList = count;
+	for (size_t i = 0; i < count; ++i) {
+		InboundEvent::Type type = inboundQueue.peek(i)->type;
+		if (type == InboundEvent::Type::UserList)
+			lastUserList = i;
+		else if (type == InboundEvent::Type::RoomList)
+			lastRoomList = i;
+	}
+
+	for (size_t i = 0; i < count; ++i) {
+		const InboundEvent& event = *inboundQueue.peek(i);
+		if ((event.type == InboundEvent::Type::UserList && i != lastUserList) ||
+			(event.type == InboundEvent::Type::RoomList && i != lastRoomList))
+			continue;
+
+		// Only lines of the shown room reach the screen
+		bool line = event.type == InboundEvent::Type::ChatMessage || event.type == InboundEvent::Type::SystemEvent;
+		if (active && line) Metrics::get().messageArrived(event.receivedNs);
+
+		std::string_view name;
+		bool joined;
+		if (event.type == InboundEvent::Type::SystemEvent && parseMembership(event.text(), name, joined)) {
+			if (membershipRun.count++ == 0) membershipRun.firstText = event.text();
+			(joined ? membershipRun.joined : membershipRun.left).push_back(name);
+			continue;
+		}
+
+		flushMembershipRun();
+		handleEvent(event);
+	}
+	flushMembershipRun();
+
+	// The views into the slots are no longer needed
+	inboundQueue.popFront(count);
+
+	if (batchAppended > 0) appended(batchAppended);
+	batchAppended = 0;
+	return true;
+}
+
+void RoomSession::flushMembershipRun() {
+	if (membershipRun.count == 0) return;
+
+	if (membershipRun.count == 1) {
+		handleSystemEvent(membershipRun.firstText);
+	} else {
+		// "alice, bob and 3 others joined; carol left"
+		std::string summary;
+		if (!membershipRun.joined.empty()) {
+			appendNames(summary, membershipRun.joined);
+			summary += " joined";
+		}
+		if (!membershipRun.left.empty()) {
+			if (!summary.empty()) summary += "; ";
+			appendNames(summary, membershipRun.left);
+			summary += " left";
+		}
+		handleSystemEvent(summary);
+	}
+
+	membershipRun.joined.clear();
+	membershipRun.left.clear();
+	membershipRun.count = 0;
+}
+
+void RoomSession::appendNames(std::string& out, const std::vector<std::string_view>& names) {
+	const size_t shown = 3;
+
+	for (size_t i = 0; i < names.size() && i < shown; ++i) {
+		if (i > 0) out += i + 1 == names.size() ? " and " : ", ";
+		out.append(names[i]);
+	}
+	if (names.size() > shown) out += " and " + std::to_string(names.size() - shown) + " others";
+}
+
+bool RoomSession::parseMembership(std::string_view text, std::string_view& name, bool& joined) {
+	static constexpr std::string_view joinedSuffix = " joined the room";
+	static constexpr std::string_view leftSuffix = " left the room";
+
+	auto endsWith = [text](std::string_view suffix) {
+		return text.size() > suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+	};
+
+	if (endsWith(joinedSuffix)) {
+		joined = true;
+		name = text.substr(0, text.size() - joinedSuffix.size());
+		return true;
+	}
+	if (endsWith(leftSuffix)) {
+		joined = false;
+		name = text.substr(0, text.size() - leftSuffix.size());
+		return true;
+	}
+	return false;
+}
+
+void RoomSession::handleEvent(const InboundEvent& event) {
+	switch (event.type) {
+		case InboundEvent::Type::ChatMessage: handleChatMessage(event.username(), event.text()); break;
+		case InboundEvent::Type::SystemEvent: handleSystemEvent(event.text()); break;
+		case InboundEvent::Type::UserList: handleUserListUpdate(event.items()); break;
+		case InboundEvent::Type::RoomList: handleRoomListUpdate(event.items()); break;
+		case InboundEvent::Type::Status: listener.onStatus(*this, sanitize(event.text(), cleanText)); break;
+	}
+}
+
+void RoomSession::handleChatMessage(std::string_view user, std::string_view message) {
+	// Server text never reaches the terminal as escape sequences
+	history.addMessage(sanitize(user, cleanUser), sanitize(message, cleanText));
+	logLastLine();
+	batchAppended++;
+}
+
+void RoomSession::handleSystemEvent(std::string_view event) {
+	history.addSystemMessage(sanitize(event, cleanText));
+	logLastLine();
+	batchAppended++;
+}
+
+void RoomSession::handleUserListUpdate(const InboundEvent::ItemList& newUsers) {
+	// Usually only a few members differ from the last list
+	bool clean = std::all_of(newUsers.begin(), newUsers.end(), DisplayText::isClean);
+	if (!clean) {
+		cleanNames.clear();
+		for (std::string_view name : newUsers)
+			cleanNames.emplace_back(sanitize(name, cleanText));
+	}
+	if (clean ? users.assign(newUsers) : users.assign(cleanNames)) listener.onUsersChanged(*this);
+}
+
+void RoomSession::handleRoomListUpdate(const InboundEvent::ItemList& rooms) {
+	listener.onRoomList(*this, rooms);
+
+	// A line of the batch like any other, so it is counted as unread and logged
+	std::string line = "Available rooms: ";
+	if (rooms.empty()) line += "none (create a new one)";
+	for (size_t i = 0; i < rooms.size(); ++i) {
+		if (i > 0) line += ", ";
+		line += rooms[i];
+	}
+	handleSystemEvent(line);
+}
+
+void RoomSession::logLastLine() {
+	if (!log) return;
+
+	// Same timestamp as the line on screen
+	const ChatHistory::Record& line = history.record(history.size() - 1);
+	log->append(line.time, line.kind == ChatHistory::Kind::System, history.username(line), history.body(line));
+}
+
+std::string_view RoomSession::sanitize(std::string_view text, std::string& buffer) {
+	std::string_view result = DisplayText::sanitize(text, buffer);
+	if (result.data() != text.data()) Metrics::get().textsSanitized.fetch_add(1, std::memory_order_relaxed);
+	return result;
+}
+
+void RoomSession::appended(size_t count) {
+	// Inactive rooms only count; the listener decides whether anything is redrawn
+	if (!active) unread += count;
+	listener.onHistoryAppended(*this, count);
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "../message/inboundEvent.h"
+#include "../message/messageHandler.h"
+#include "../network/webSocketManager.h"
+#include "../storage/roomLog.h"
+#include "../ui/chatHistory.h"
+#include "../ui/userList.h"
+#include "../util/eventFd.h"
+#include "../util/spscRing.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class RoomSession;
+
+// Receives session updates on the UI thread
+class SessionListener {
+  public:
+	virtual ~SessionListener() = default;
+
+	// Lines were appended to the session's history
+	virtual void onHistoryAppended(RoomSession& session, size_t count) = 0;
+
+	// Members joined or left the session's user list
+	virtual void onUsersChanged(RoomSession& session) = 0;
+
+	// The server sent the list of rooms; the session also appends it to its history
+	virtual void onRoomList(RoomSession& session, const InboundEvent::ItemList& rooms) = 0;
+
+	// Connection state text for the status bar
+	virtual void onStatus(RoomSession& session, std::string_view status) = 0;
+};
+
+// One room (or the room-less lobby) on its own connection, with its own scrollback and user list.
+// The connection's network thread only decodes into the session's ring; drain() applies the
+// events on the UI thread.
+class RoomSession : public MessageHandler {
+  public:
+	RoomSession(std::unique_ptr<WebSocketManager> connection, size_t queueCapacity, OverflowPolicy overflow,
+				const ChatHistory::Limits& historyLimits, const RoomLogOptions& logOptions, EventFd& wakeup,
+				SessionListener& listener);
+	~RoomSession();
+
+	// Join (or, on the lobby, first join) a room; resent automatically after reconnects.
+	// With logging enabled this also opens the room's log and shows what it already holds.
+	void join(const std::string& roomName, const std::string& user);
+
+	// Apply queued events as one batch (UI thread); returns false if nothing was queued.
+	// Only the batch's last user and room list are applied, and runs of join/leave
+	// messages become a single line.
+	bool drain();
+
+	// Give the connection back, e.g. to a ConnectionPool; the session is unusable afterwards
+	std::unique_ptr<WebSocketManager> releaseConnection();
+
+	WebSocketManager& getConnection() { return *connection; }
+	const std::string& getRoom() const { return room; }
+	const std::string& getUsername() const { return username; }
+	ChatHistory& getHistory() { return history; }
+	UserList& getUsers() { return users; }
+
+	// Lines received while the session was not shown
+	uint64_t getUnread() const { return unread; }
+	void setActive(bool value);
+	bool isActive() const { return active; }
+
+	uint64_t getDroppedEvents() const { return inboundQueue.dropped(); }
+	size_t getQueueDepth() const { return inboundQueue.depth(); }
+	size_t getQueueHighWater() const { return inboundQueue.highWater(); }
+	size_t getQueueCapacity() const { return inboundQueue.capacity(); }
+
+	// MessageHandler implementation
+	// processFrame runs on the network thread and only enqueues; the handlers run on the UI thread
+	void processFrame(std::string_view frame, WireCodec& codec) override;
+	void handleEvent(const InboundEvent& event) override;
+	void handleChatMessage(std::string_view user, std::string_view message) override;
+	void handleSystemEvent(std::string_view event) override;
+	void handleUserListUpdate(const InboundEvent::ItemList& newUsers) override;
+	void handleRoomListUpdate(const InboundEvent::ItemList& rooms) override;
+
+  private:
+	std::unique_ptr<WebSocketManager> connection;
+	std::string room;
+	std::string username;
+
+	// Persistent log of the room's lines; declared first so the history reading it goes first
+	RoomLogOptions logOptions;
+	std::unique_ptr<RoomLog> log;
+
+	ChatHistory history;
+	UserList users;
+	uint64_t unread;
+	bool active;
+
+	// Network thread -> UI thread handoff
+	SpscRing<InboundEvent> inboundQueue;
+	EventFd& wakeup;
+	SessionListener& listener;
+
+	// The connection was already open when the session took it (a warm pool connection)
+	bool connectedOnArrival;
+
+	// Join/leave messages of the current batch, collapsed into one line (UI thread)
+	struct MembershipRun {
+		std::vector<std::string_view> joined; // Views into ring slots, valid until the batch is popped
+		std::vector<std::string_view> left;
+		std::string_view firstText;
+		size_t count = 0;
+	} membershipRun;
+	size_t batchAppended;
+
+	// Inbound text with terminal controls removed, reused for every event (UI thread)
+	std::string cleanUser;
+	std::string cleanText;
+	std::vector<std::string> cleanNames;
+
+	void enqueueText(InboundEvent::Type type, std::string_view text);
+	static const char* connectionStatus(bool connected);
+	void flushMembershipRun();
+	void appended(size_t count);
+	void logLastLine();
+	std::string_view sanitize(std::string_view text, std::string& buffer);
+
+	// "name joined the room" / "name left the room"
+	static bool parseMembership(std::string_view text, std::string_view& name, bool& joined);
+	static void appendNames(std::string& out, const std::vector<std::string_view>& names);
+};
@@ -0,0 +1,378 @@
+#include "roomLog.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Segment layout, per line: length of the rest (4), time (8), flags (1), username length (2), username, body
+const size_t lineHeaderSize = 4 + 8 + 1 + 2;
+const uint8_t systemFlag = 1;
+
+size_t fileSize(int fd) {
+	struct stat st;
+	return fstat(fd, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+}
+
+template <typename T>
+void put(std::string& out, T value) {
+	out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+T get(const char* in) {
+	T value;
+	std::memcpy(&value, in, sizeof(value));
+	return value;
+}
+
+} // namespace
+
+RoomLog::RoomLog(const RoomLogOptions& options, const std::string& room)
+  : options(options)
+  , directory(options.directory + "/" + escapeName(room))
+  , mappedLines(0)
+  , lockFd(-1)
+  , opened(false)
+  , lockedElsewhere(false)
+  , stopping(false)
+  , failed(false)
+  , dataFd(-1)
+  , indexFd(-1)
+  , nextSequence(0)
+  , segmentSize(0)
+  , unsynced(false) {
+
+	if (!makeDirectories(directory)) return;
+
+	std::vector<uint64_t> segments = listSegments();
+	for (uint64_t first : segments)
+		mapSegment(first);
+
+	// A second writer (another session in the room, or another client) would keep its own
+	// segment size and write wrong offsets into the index
+	lockFd = open((directory + "/lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+	if (lockFd < 0) return;
+	if (flock(lockFd, LOCK_EX | LOCK_NB) != 0) {
+		lockedElsewhere = errno == EWOULDBLOCK;
+		return;
+	}
+
+	// Continue the newest segment, cutting off a line torn by a crash
+	if (!openWriter(segments.empty() ? 0 : segments.back(), true)) return;
+	applyRetention();
+
+	opened = true;
+	lastSync = std::chrono::steady_clock::now();
+	writer = std::thread(&RoomLog::writerLoop, this);
+}
+
+RoomLog::~RoomLog() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_one();
+	if (writer.joinable()) writer.join();
+
+	closeWriter();
+	if (lockFd >= 0) close(lockFd);
+	for (Segment& segment : mapped) {
+		if (segment.data) munmap(const_cast<char*>(segment.data), segment.dataSize);
+		if (segment.index) munmap(const_cast<IndexEntry*>(segment.index), segment.indexBytes);
+	}
+}
+
+std::string RoomLog::escapeName(const std::string& room) {
+	// Room names come from the server; keep them from escaping the log directory
+	std::string name;
+	for (unsigned char c : room) {
+		if (std::isalnum(c) || c == '-' || c == '_' || (c == '.' && !name.empty())) {
+			name += static_cast<char>(c);
+		} else {
+			char escaped[4];
+			std::snprintf(escaped, sizeof(escaped), "%%%02X", c);
+			name += escaped;
+		}
+	}
+	return name.empty() ? "%" : name;
+}
+
+bool RoomLog::makeDirectories(const std::string& path) {
+	for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+		std::string prefix = path.substr(0, slash);
+		if (mkdir(prefix.c_str(), 0700) != 0 && errno != EEXIST) return false;
+		if (slash == std::string::npos) return true;
+	}
+}
+
+std::string RoomLog::segmentPath(uint64_t firstSequence, const char* extension) const {
+	// Named after their first sequence number, so names sort in log order
+	char name[32];
+	std::snprintf(name, sizeof(name), "/%020" PRIu64 ".%s", firstSequence, extension);
+	return directory + name;
+}
+
+std::vector<uint64_t> RoomLog::listSegments() const {
+	std::vector<uint64_t> segments;
+	DIR* dir = opendir(directory.c_str());
+	if (!dir) return segments;
+
+	while (dirent* entry = readdir(dir)) {
+		const char* name = entry->d_name;
+		if (std::strlen(name) != 24 || std::strcmp(name + 20, ".log") != 0) continue;
+		segments.push_back(std::strtoull(name, nullptr, 10));
+	}
+	closedir(dir);
+
+	std::sort(segments.begin(), segments.end());
+	return segments;
+}
+
+size_t RoomLog::validLines(const char* data, size_t dataSize, const IndexEntry* index, size_t count) {
+	// The index is written after its line, so only trailing entries can be missing or point past the data
+	while (count > 0) {
+		const IndexEntry& last = index[count - 1];
+		if (last.offset + lineHeaderSize <= dataSize &&
+			last.offset + 4 + get<uint32_t>(data + last.offset) <= dataSize)
+			break;
+		count--;
+	}
+	return count;
+}
+
+void RoomLog::mapSegment(uint64_t firstSequence) {
+	int dataFile = open(segmentPath(firstSequence, "log").c_str(), O_RDONLY | O_CLOEXEC);
+	int indexFile = open(segmentPath(firstSequence, "idx").c_str(), O_RDONLY | O_CLOEXEC);
+
+	Segment segment;
+	segment.firstSequence = firstSequence;
+	if (dataFile >= 0 && indexFile >= 0) {
+		segment.dataSize = fileSize(dataFile);
+		segment.indexBytes = fileSize(indexFile) / sizeof(IndexEntry) * sizeof(IndexEntry);
+		if (segment.dataSize > 0 && segment.indexBytes > 0) {
+			// Pages are only read in when a line on them is drawn
+			void* data = mmap(nullptr, segment.dataSize, PROT_READ, MAP_SHARED, dataFile, 0);
+			void* index = mmap(nullptr, segment.indexBytes, PROT_READ, MAP_SHARED, indexFile, 0);
+			if (data != MAP_FAILED) segment.data = static_cast<const char*>(data);
+			if (index != MAP_FAILED) segment.index = static_cast<const IndexEntry*>(index);
+		}
+	}
+	if (dataFile >= 0) close(dataFile);
+	if (indexFile >= 0) close(indexFile);
+
+	if (segment.data && segment.index)
+		segment.count = validLines(segment.data, segment.dataSize, segment.index, segment.indexBytes / sizeof(IndexEntry));
+
+	if (segment.count == 0) {
+		if (segment.data) munmap(const_cast<char*>(segment.data), segment.dataSize);
+		if (segment.index) munmap(const_cast<IndexEntry*>(segment.index), segment.indexBytes);
+		return;
+	}
+
+	segment.mappedBefore = mappedLines;
+	mappedLines += segment.count;
+	mapped.push_back(segment);
+}
+
+bool RoomLog::openWriter(uint64_t firstSequence, bool recover) {
+	dataFd = open(segmentPath(firstSequence, "log").c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+	indexFd = open(segmentPath(firstSequence, "idx").c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+	if (dataFd < 0 || indexFd < 0) {
+		closeWriter();
+		return false;
+	}
+
+	nextSequence = firstSequence;
+	segmentSize = 0;
+
+	if (recover) {
+		size_t count = fileSize(indexFd) / sizeof(IndexEntry);
+		size_t dataSize = fileSize(dataFd);
+
+		// Drop trailing index entries whose line was not fully written, then the bytes after the last line
+		IndexEntry entry{};
+		uint32_t length = 0;
+		for (; count > 0; --count) {
+			if (pread(indexFd, &entry, sizeof(entry), (count - 1) * sizeof(IndexEntry)) == sizeof(entry) &&
+				entry.offset + lineHeaderSize <= dataSize &&
+				pread(dataFd, &length, sizeof(length), entry.offset) == sizeof(length) &&
+				entry.offset + 4 + length <= dataSize)
+				break;
+		}
+
+		segmentSize = count == 0 ? 0 : entry.offset + 4 + length;
+		if (ftruncate(indexFd, count * sizeof(IndexEntry)) != 0 || ftruncate(dataFd, segmentSize) != 0) {
+			closeWriter();
+			return false;
+		}
+		nextSequence = firstSequence + count;
+	}
+	return true;
+}
+
+void RoomLog::closeWriter() {
+	if (unsynced) sync();
+	if (dataFd >= 0) close(dataFd);
+	if (indexFd >= 0) close(indexFd);
+	dataFd = indexFd = -1;
+}
+
+void RoomLog::append(time_t time, bool system, std::string_view username, std::string_view body) {
+	if (!opened) return;
+
+	username = username.substr(0, UINT16_MAX);
+	uint32_t length = static_cast<uint32_t>(lineHeaderSize - 4 + username.size() + body.size());
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (failed) return;
+
+	// Only the first line since the writer last ran needs to wake it
+	bool wasEmpty = pending.empty();
+	put(pending, length);
+	put(pending, static_cast<int64_t>(time));
+	put(pending, static_cast<uint8_t>(system ? systemFlag : 0));
+	put(pending, static_cast<uint16_t>(username.size()));
+	pending.append(username);
+	pending.append(body);
+	if (wasEmpty) wake.notify_one();
+}
+
+void RoomLog::writerLoop() {
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;) {
+		// Woken by appends, and once the sync interval has passed since the last sync while
+		// lines are unsynced, so the last lines of a room gone quiet reach the disk too
+		auto ready = [this]() { return !pending.empty() || stopping; };
+		if (unsynced)
+			wake.wait_until(lock, lastSync + std::chrono::milliseconds(options.syncIntervalMs), ready);
+		else
+			wake.wait(lock, ready);
+
+		writing.swap(pending);
+		bool stop = stopping;
+		lock.unlock();
+
+		bool written = writeLines(writing);
+		writing.clear();
+		if (written && unsynced &&
+			(stop || std::chrono::steady_clock::now() - lastSync >= std::chrono::milliseconds(options.syncIntervalMs)))
+			sync();
+
+		lock.lock();
+		if (!written) {
+			// Disk full or similar: stop logging rather than leave a hole in the index
+			failed = true;
+			pending.clear();
+		}
+		if (!written || (stop && pending.empty())) return;
+	}
+}
+
+bool RoomLog::writeLines(std::string_view lines) {
+	size_t offset = 0;
+	while (offset < lines.size()) {
+		if (segmentSize > 0 && segmentSize >= options.segmentBytes) rotate();
+		if (dataFd < 0) return false;
+
+		// The lines that fit in this segment; each file gets one write, the lines going first so a
+		// crash can leave a line without an entry but not the reverse
+		entries.clear();
+		size_t end = offset, size = segmentSize;
+		while (end < lines.size() && (size == 0 || size < options.segmentBytes)) {
+			uint32_t length = get<uint32_t>(lines.data() + end);
+			entries.push_back({ size, get<int64_t>(lines.data() + end + 4) });
+			size += 4 + length;
+			end += 4 + length;
+		}
+
+		size_t entryBytes = entries.size() * sizeof(IndexEntry);
+		if (write(dataFd, lines.data() + offset, end - offset) != static_cast<ssize_t>(end - offset) ||
+			write(indexFd, entries.data(), entryBytes) != static_cast<ssize_t>(entryBytes)) {
+			closeWriter();
+			return false;
+		}
+
+		segmentSize = size;
+		nextSequence += entries.size();
+		unsynced = true;
+		offset = end;
+	}
+	return true;
+}
+
+void RoomLog::sync() {
+	if (dataFd >= 0) fdatasync(dataFd);
+	if (indexFd >= 0) fdatasync(indexFd);
+	unsynced = false;
+	lastSync = std::chrono::steady_clock::now();
+}
+
+void RoomLog::rotate() {
+	closeWriter();
+	if (openWriter(nextSequence, false)) applyRetention();
+}
+
+void RoomLog::applyRetention() {
+	std::vector<uint64_t> segments = listSegments();
+	time_t cutoff = options.retentionDays > 0 ? std::time(nullptr) - options.retentionDays * 24 * 3600 : 0;
+
+	// The segment being written is always kept; mapped segments stay readable after unlinking
+	for (size_t i = 0; i + 1 < segments.size(); ++i) {
+		bool expired = segments.size() - i > options.maxSegments;
+		if (!expired && cutoff > 0) {
+			// A segment is old once its last line is
+			int indexFile = open(segmentPath(segments[i], "idx").c_str(), O_RDONLY | O_CLOEXEC);
+			IndexEntry last;
+			size_t count = indexFile >= 0 ? fileSize(indexFile) / sizeof(IndexEntry) : 0;
+			expired = count > 0 && pread(indexFile, &last, sizeof(last), (count - 1) * sizeof(last)) == sizeof(last) &&
+					  last.time < cutoff;
+			if (indexFile >= 0) close(indexFile);
+		}
+		if (!expired) break;
+
+		unlink(segmentPath(segments[i], "log").c_str());
+		unlink(segmentPath(segments[i], "idx").c_str());
+	}
+}
+
+bool RoomLog::read(size_t index, Entry& entry) const {
+	if (index >= mappedLines) return false;
+
+	// Last segment starting at or before index
+	auto it = std::upper_bound(mapped.begin(), mapped.end(), index,
+							   [](size_t i, const Segment& segment) { return i < segment.mappedBefore; });
+	const Segment& segment = *(it - 1);
+
+	const char* line = segment.data + segment.index[index - segment.mappedBefore].offset;
+	uint32_t length = get<uint32_t>(line);
+	uint16_t usernameLength = get<uint16_t>(line + 13);
+	if (lineHeaderSize - 4 + usernameLength > length) return false;
+
+	entry.time = static_cast<time_t>(get<int64_t>(line + 4));
+	entry.system = (get<uint8_t>(line + 12) & systemFlag) != 0;
+	entry.username = std::string_view(line + lineHeaderSize, usernameLength);
+	entry.body = std::string_view(line + lineHeaderSize + usernameLength, length - (lineHeaderSize - 4) - usernameLength);
+	return true;
+}
+
+size_t RoomLog::lowerBound(time_t time) const {
+	// Lines are appended in time order, so both the segments and their indices are sorted by time
+	for (const Segment& segment : mapped) {
+		if (segment.index[segment.count - 1].time < time) continue;
+		const IndexEntry* found = std::lower_bound(segment.index, segment.index + segment.count, time,
+												   [](const IndexEntry& entry, time_t t) { return entry.time < t; });
+		return segment.mappedBefore + (found - segment.index);
+	}
+	return mappedLines;
+}
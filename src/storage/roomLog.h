@@ -0,0 +1,112 @@
+#pragma once
+
+#include "roomLogOptions.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Persistent chat log of one room: append-only segment files, each with an index of
+// (offset, time) per line, so a line is found by sequence number or by time without scanning.
+// The segments present when the log is opened are memory-mapped, so old lines are paged in
+// only when read. Appended lines are written and synced by a writer thread, and only one log
+// per room directory writes at a time: the others just read.
+class RoomLog {
+  public:
+	struct Entry {
+		time_t time;
+		bool system;
+		std::string_view username; // Views into the mapping, valid for the log's lifetime
+		std::string_view body;
+	};
+
+	RoomLog(const RoomLogOptions& options, const std::string& room);
+	~RoomLog();
+
+	RoomLog(const RoomLog&) = delete;
+	RoomLog& operator=(const RoomLog&) = delete;
+
+	// False if the directory or the current segment could not be opened, or the log is in use
+	bool isOpen() const { return opened; }
+
+	// Another session or process is writing this room's log; its lines can still be read
+	bool inUse() const { return lockedElsewhere; }
+
+	// Queue a line for the writer thread; ignored unless the log is open
+	void append(time_t time, bool system, std::string_view username, std::string_view body);
+
+	// Lines that were on disk when the log was opened, readable through the mapping
+	size_t mappedCount() const { return mappedLines; }
+	bool read(size_t index, Entry& entry) const;
+
+	// First mapped line at or after time (mappedCount() if none)
+	size_t lowerBound(time_t time) const;
+
+  private:
+	// Index file entry, one per line
+	struct IndexEntry {
+		uint64_t offset;
+		int64_t time;
+	};
+
+	struct Segment {
+		uint64_t firstSequence;
+		const char* data = nullptr;
+		size_t dataSize = 0;
+		const IndexEntry* index = nullptr;
+		size_t indexBytes = 0;
+		size_t count = 0; // Lines whose entry and bytes were fully written
+		size_t mappedBefore = 0; // Mapped lines in earlier segments
+	};
+
+	RoomLogOptions options;
+	std::string directory;
+
+	std::vector<Segment> mapped;
+	size_t mappedLines;
+
+	int lockFd; // Held with an exclusive flock while this log writes
+	bool opened;
+	bool lockedElsewhere;
+
+	// Lines appended since the writer thread last took them, serialized as in the segment
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::string pending;
+	bool stopping;
+	bool failed; // The writer stopped on an error; appends are dropped
+	std::thread writer;
+
+	// Writer thread state for the newest segment
+	int dataFd;
+	int indexFd;
+	uint64_t nextSequence;
+	size_t segmentSize;
+	bool unsynced;
+	std::chrono::steady_clock::time_point lastSync;
+	std::string writing;
+	std::vector<IndexEntry> entries;
+
+	std::vector<uint64_t> listSegments() const;
+	std::string segmentPath(uint64_t firstSequence, const char* extension) const;
+	void mapSegment(uint64_t firstSequence);
+	bool openWriter(uint64_t firstSequence, bool recover);
+	void closeWriter();
+	void rotate();
+	void applyRetention();
+
+	void writerLoop();
+	// Write serialized lines, one write per file and segment; false on an error
+	bool writeLines(std::string_view lines);
+	void sync();
+
+	static std::string escapeName(const std::string& room);
+	static bool makeDirectories(const std::string& path);
+	static size_t validLines(const char* data, size_t dataSize, const IndexEntry* index, size_t count);
+};
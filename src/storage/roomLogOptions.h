@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+struct RoomLogOptions {
+	// Root directory of the per-room logs; empty disables logging
+	std::string directory;
+
+	// A new segment is started once the current one reaches this size
+	size_t segmentBytes = 4 * 1024 * 1024;
+
+	// Retention: oldest segments beyond this count, or older than retentionDays (0 = keep), are deleted
+	size_t maxSegments = 16;
+	unsigned retentionDays = 0;
+
+	// Lines are written as they arrive and synced with fdatasync this long after the last sync,
+	// whether or not more lines follow; 0 syncs after every write
+	unsigned syncIntervalMs = 2000;
+};
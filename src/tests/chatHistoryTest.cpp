@@ -0,0 +1,29 @@
+#include "../ui/chatHistory.h"
+#include "test.h"
+#include <string>
+
+TEST(historyWithoutColdTierDropsBlocks) {
+	ChatHistory::Limits limits;
+	limits.hotLines = 300;
+	limits.coldBytes = 0;
+	ChatHistory history(limits);
+
+	for (int i = 0; i < 10 * static_cast<int>(ChatHistory::blockLines); ++i)
+		history.addMessage("alice", "line" + std::to_string(i));
+
+	ChatHistory::Stats stats = history.getStats();
+	CHECK(stats.coldBlocks == 0 && stats.coldBytes == 0);
+	CHECK(history.droppedLines() + history.size() == 10 * ChatHistory::blockLines);
+	CHECK(history.size() >= limits.hotLines && history.size() < limits.hotLines + 2 * ChatHistory::blockLines);
+
+	// Ids still count from the first line ever appended
+	size_t index = 0;
+	CHECK(history.find(history.lineId(history.size() - 1), index) && index == history.size() - 1);
+	CHECK(!history.find(0, index));
+
+	SearchIndex::Query query;
+	query.terms = { "line0" };
+	CHECK(history.search(query, 10).empty());
+	query.terms = { "line" + std::to_string(10 * ChatHistory::blockLines - 1) };
+	CHECK(history.search(query, 10).size() == 1);
+}
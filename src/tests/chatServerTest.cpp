@@ -0,0 +1,97 @@
+#include "../server/chatServer.h"
+#include "test.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+const uint16_t testPort = 18932;
+
+int connectTo(uint16_t port) {
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in address{};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) return fd;
+	if (fd >= 0) close(fd);
+	return -1;
+}
+
+// A masked client text frame
+std::string clientFrame(std::string_view payload) {
+	const unsigned char mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+	std::string frame;
+	frame += static_cast<char>(0x81);
+	if (payload.size() < 126) {
+		frame += static_cast<char>(0x80 | payload.size());
+	} else {
+		frame += static_cast<char>(0x80 | 126);
+		frame += static_cast<char>(payload.size() >> 8);
+		frame += static_cast<char>(payload.size() & 0xFF);
+	}
+	frame.append(reinterpret_cast<const char*>(mask), sizeof(mask));
+	for (size_t i = 0; i < payload.size(); ++i)
+		frame += static_cast<char>(payload[i] ^ mask[i & 3]);
+	return frame;
+}
+
+const char handshake[] = "GET /ws HTTP/1.1\r\n"
+						 "Host: localhost\r\n"
+						 "Upgrade: websocket\r\n"
+						 "Connection: Upgrade\r\n"
+						 "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+						 "Sec-WebSocket-Version: 13\r\n\r\n";
+
+bool sendAll(int fd, const std::string& data) {
+	return write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size());
+}
+
+// Read until the server closes the connection; false on timeout
+bool waitForClose(int fd) {
+	char buffer[4096];
+	pollfd pfd{ fd, POLLIN, 0 };
+	while (poll(&pfd, 1, 5000) > 0) {
+		ssize_t bytes = read(fd, buffer, sizeof(buffer));
+		if (bytes <= 0) return true;
+	}
+	return false;
+}
+
+} // namespace
+
+TEST(closedConnectionIgnoresRestOfRead) {
+	ServerOptions serverOptions;
+	serverOptions.port = testPort;
+	serverOptions.threads = 1;
+	serverOptions.maxOutputBytes = 200; // The handshake response and about two room lists
+	ChatServer server(serverOptions);
+	CHECK(server.start());
+
+	// Room lists overflow the output cap and drop the connection; the join after them arrives
+	// in the same read and must not register the closed connection in a room
+	int fd = connectTo(testPort);
+	CHECK(fd >= 0);
+	std::string input = handshake;
+	for (int i = 0; i < 10; ++i)
+		input += clientFrame(R"({"type":"getRoomList"})");
+	input += clientFrame(R"({"type":"joinRoom","data":{"room":"lobby","username":"ghost"}})");
+	CHECK(sendAll(fd, input));
+	CHECK(waitForClose(fd));
+	close(fd);
+	CHECK(server.roomCount() == 0);
+
+	// A later member of the room must not be delivered to the freed connection
+	int other = connectTo(testPort);
+	CHECK(other >= 0);
+	CHECK(sendAll(other, handshake + clientFrame(R"({"type":"joinRoom","data":{"room":"lobby","username":"alice"}})")));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	CHECK(server.roomCount() == 1);
+	close(other);
+}
@@ -0,0 +1,52 @@
+#include "../network/connectionPool.h"
+#include "../server/chatServer.h"
+#include "../session/roomSession.h"
+#include "test.h"
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace {
+
+const uint16_t testPort = 18931;
+
+class StatusRecorder : public SessionListener {
+  public:
+	std::vector<std::string> statuses;
+
+	void onHistoryAppended(RoomSession&, size_t) override {}
+	void onUsersChanged(RoomSession&) override {}
+	void onRoomList(RoomSession&, const InboundEvent::ItemList&) override {}
+	void onStatus(RoomSession&, std::string_view status) override { statuses.emplace_back(status); }
+};
+
+template <typename Condition>
+bool waitFor(Condition condition) {
+	for (int i = 0; i < 500 && !condition(); ++i)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	return condition();
+}
+
+} // namespace
+
+TEST(warmConnectionReportsConnected) {
+	ServerOptions serverOptions;
+	serverOptions.port = testPort;
+	serverOptions.threads = 1;
+	ChatServer server(serverOptions);
+	CHECK(server.start());
+
+	// The first acquire opens a fresh connection and warms the next one
+	ConnectionPool pool("ws://127.0.0.1:" + std::to_string(testPort) + "/ws", ConnectionOptions(), 1);
+	std::unique_ptr<WebSocketManager> fresh = pool.acquire();
+	std::unique_ptr<WebSocketManager> warm = pool.acquire();
+	CHECK(waitFor([&warm]() { return warm->isConnected(); }));
+
+	// Its Open happened before the session set its callbacks, and must still be reported
+	EventFd wakeup;
+	StatusRecorder recorder;
+	RoomSession session(std::move(warm), 64, OverflowPolicy::DropNewest, ChatHistory::Limits(), RoomLogOptions(),
+						wakeup, recorder);
+	CHECK(session.drain());
+	CHECK(!recorder.statuses.empty() && recorder.statuses.front() == "Connected");
+}
@@ -0,0 +1,33 @@
+#include "../message/jsonScanner.h"
+#include "test.h"
+#include <string>
+
+namespace {
+
+// Unescape a JSON string literal; "<error>" if the scanner rejects it
+std::string unescape(std::string literal) {
+	JsonScanner scanner(&literal[0], &literal[0] + literal.size());
+	InboundEvent::Span span;
+	if (!scanner.readString(span)) return "<error>";
+	return literal.substr(span.offset, span.length);
+}
+
+} // namespace
+
+TEST(jsonEscapes) {
+	CHECK(unescape(R"("a\"b\\c\/\n\t")") == "a\"b\\c/\n\t");
+	CHECK(unescape(R"("\u00e9\u20ac")") == "\xC3\xA9\xE2\x82\xAC");
+	CHECK(unescape(R"("\ud83d\ude00")") == "\xF0\x9F\x98\x80");
+	CHECK(unescape(R"("\q")") == "<error>");
+	CHECK(unescape(R"("\u12")") == "<error>");
+}
+
+TEST(jsonLoneSurrogates) {
+	// U+FFFD for the lone surrogate; the escape after it is still decoded
+	CHECK(unescape(R"("\ud800\n")") == "\xEF\xBF\xBD\n");
+	CHECK(unescape(R"("\ud800\u0041")") == "\xEF\xBF\xBD" "A");
+	CHECK(unescape(R"("\ud800\ud83d\ude00")") == "\xEF\xBF\xBD\xF0\x9F\x98\x80");
+	CHECK(unescape(R"("\ud800x")") == "\xEF\xBF\xBDx");
+	CHECK(unescape(R"("\udc00")") == "\xEF\xBF\xBD");
+	CHECK(unescape(R"("\ud800")") == "\xEF\xBF\xBD");
+}
@@ -0,0 +1,92 @@
+#include "../storage/roomLog.h"
+#include "../ui/chatHistory.h"
+#include "test.h"
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+
+namespace {
+
+std::string temporaryDirectory() {
+	char path[] = "/tmp/chat-test-XXXXXX";
+	return mkdtemp(path) ? path : "";
+}
+
+void removeDirectory(const std::string& path) {
+	std::string command = "rm -rf '" + path + "'";
+	CHECK(std::system(command.c_str()) == 0);
+}
+
+size_t fileSize(const std::string& path) {
+	struct stat st;
+	return stat(path.c_str(), &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+}
+
+} // namespace
+
+TEST(roomLogHasOneWriterPerRoom) {
+	RoomLogOptions options;
+	options.directory = temporaryDirectory();
+	options.segmentBytes = 256; // Several segments, so offsets restart
+
+	{
+		RoomLog first(options, "lobby");
+		RoomLog second(options, "lobby");
+		CHECK(first.isOpen());
+		CHECK(!second.isOpen() && second.inUse());
+
+		for (int i = 0; i < 40; ++i) {
+			first.append(1000 + i, false, "alice", "line " + std::to_string(i));
+			second.append(1000 + i, false, "bob", "ignored"); // Would corrupt the index if written
+		}
+
+		// Written by the writer thread without waiting for another append or the destructor
+		std::string segment = options.directory + "/lobby/00000000000000000000.log";
+		for (int i = 0; i < 200 && fileSize(segment) < 256; ++i)
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		CHECK(fileSize(segment) >= 256);
+	}
+
+	RoomLog reopened(options, "lobby");
+	CHECK(reopened.mappedCount() == 40);
+	RoomLog::Entry entry{};
+	for (size_t i = 0; i < reopened.mappedCount(); ++i) {
+		CHECK(reopened.read(i, entry));
+		CHECK(entry.username == "alice" && entry.body == "line " + std::to_string(i));
+		CHECK(entry.time == static_cast<time_t>(1000 + i));
+	}
+	CHECK(reopened.lowerBound(1010) == 10);
+	CHECK(reopened.lowerBound(2000) == 40);
+	removeDirectory(options.directory);
+}
+
+TEST(archiveSearchWithinTimeRange) {
+	RoomLogOptions options;
+	options.directory = temporaryDirectory();
+	{
+		RoomLog log(options, "lobby");
+		for (int i = 0; i < 100; ++i)
+			log.append(1000 + i, false, "alice", i % 2 ? "odd" : "even");
+	}
+
+	RoomLog log(options, "lobby");
+	ChatHistory history;
+	history.attachArchive(log);
+
+	SearchIndex::Query query;
+	query.terms = { "odd" };
+	query.after = 1090;
+	query.before = 1095;
+	std::vector<int64_t> ids = history.search(query, 10);
+	CHECK(ids.size() == 3);
+	size_t index = 0;
+	CHECK(!ids.empty() && history.find(ids.front(), index) && history.record(index).time == 1095);
+	CHECK(ids.size() == 3 && history.find(ids.back(), index) && history.record(index).time == 1091);
+
+	// Without bounds every archived line is searched
+	query.after = query.before = 0;
+	CHECK(history.search(query, 100).size() == 50);
+	removeDirectory(options.directory);
+}
@@ -0,0 +1,53 @@
+#include "../ui/searchIndex.h"
+#include "test.h"
+
+namespace {
+
+bool parses(const char* text) {
+	SearchIndex::Query query;
+	std::string error;
+	return SearchIndex::Query::parse(text, query, error);
+}
+
+} // namespace
+
+TEST(searchQueryTimes) {
+	CHECK(parses("after:30m hello"));
+	CHECK(parses("before:2h hello"));
+	CHECK(parses("after:12:30 hello"));
+	CHECK(parses("after:12:30:15 hello"));
+
+	// No unit, a bad unit, trailing text
+	CHECK(!parses("after:30 hello"));
+	CHECK(!parses("after:30x hello"));
+	CHECK(!parses("after:30mm hello"));
+	CHECK(!parses("after:24:00 hello"));
+	CHECK(!parses("after: hello"));
+
+	// Minutes and seconds need both digits
+	CHECK(!parses("after:12: hello"));
+	CHECK(!parses("after:12:3 hello"));
+	CHECK(!parses("after:12:-5 hello"));
+	CHECK(!parses("after:12:30: hello"));
+	CHECK(!parses("after:12:30:1 hello"));
+}
+
+TEST(searchIndexDropsOldLines) {
+	SearchIndex index;
+	for (int i = 0; i < 1000; ++i)
+		index.add(i, i % 2 ? "alice" : "bob", i == 10 ? "rare word" : "common word");
+
+	SearchIndex::Query query;
+	std::string error;
+	SearchIndex::Query::parse("rare", query, error);
+	CHECK(index.search(query, 10) == std::vector<uint64_t>{ 10 });
+
+	// Dropped lines stop matching, and compaction keeps the remaining ids
+	index.dropBefore(600);
+	CHECK(index.search(query, 10).empty());
+	CHECK(index.size() == 400);
+
+	SearchIndex::Query::parse("from:alice common", query, error);
+	std::vector<uint64_t> lines = index.search(query, 2);
+	CHECK(lines == (std::vector<uint64_t>{ 999, 997 }));
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+// Minimal test runner: TEST(name) registers a function, CHECK records a failure and carries on
+namespace test {
+
+struct Case {
+	const char* name;
+	std::function<void()> run;
+};
+
+inline std::vector<Case>& cases() {
+	static std::vector<Case> all;
+	return all;
+}
+
+inline int& failures() {
+	static int count = 0;
+	return count;
+}
+
+struct Register {
+	Register(const char* name, std::function<void()> run) { cases().push_back({ name, std::move(run) }); }
+};
+
+} // namespace test
+
+#define TEST(name)                                                                                                     \
+	static void name();                                                                                                \
+	static test::Register name##Registered(#name, name);                                                             \
+	static void name()
+
+#define CHECK(condition)                                                                                               \
+	do {                                                                                                               \
+		if (!(condition)) {                                                                                            \
+			std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);                       \
+			test::failures()++;                                                                                        \
+		}                                                                                                              \
+	} while (0)
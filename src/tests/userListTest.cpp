@@ -0,0 +1,62 @@
+#include "../ui/elements/userListElement.h"
+#include "../ui/surface/memorySurface.h"
+#include "test.h"
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> numberedUsers(int count) {
+	std::vector<std::string> names;
+	for (int i = 0; i < count; ++i)
+		names.push_back((i < 10 ? "u0" : "u") + std::to_string(i));
+	return names;
+}
+
+} // namespace
+
+TEST(userListRedrawsWhenLeavesScrollIt) {
+	MemoryScreen screen(12, 20);
+	UserListElement element(screen, 12, 20, 0, 0);
+	UserList users;
+	users.assign(numberedUsers(30));
+	element.setUsers(&users);
+
+	// Scrolled to the bottom, the last member is on the last row inside the border
+	element.scrollBy(100);
+	element.draw();
+	element.refresh();
+	screen.update();
+	CHECK(screen.dump()[10].find("u29") != std::string::npos);
+
+	// Five leave from the end: the clamp scrolls up, so every row shows a different member
+	users.assign(numberedUsers(25));
+	element.onUsersChanged();
+	element.draw();
+	element.refresh();
+	screen.update();
+	std::vector<std::string> rows = screen.dump();
+	CHECK(rows[0].find("Users (25)") != std::string::npos);
+	CHECK(rows[1].find("u15") != std::string::npos);
+	CHECK(rows[10].find("u24") != std::string::npos);
+}
+
+TEST(userListForgetsDepartedNames) {
+	UserList users;
+	users.assign(numberedUsers(3));
+
+	// Heavy churn compacts the interned names without disturbing the members
+	for (int round = 0; round < 1000; ++round) {
+		std::vector<std::string> names = numberedUsers(3);
+		names.push_back("guest" + std::to_string(round));
+		CHECK(users.assign(names));
+	}
+	CHECK(users.size() == 4);
+	CHECK(users[0] == "guest999");
+	CHECK(users[3] == "u02");
+
+	// Members that return after a compaction are still known
+	CHECK(!users.assign(std::vector<std::string>{ "u00", "u01", "u02", "guest999" }));
+	CHECK(users.assign(numberedUsers(3)));
+	CHECK(users.size() == 3 && users[0] == "u00");
+}
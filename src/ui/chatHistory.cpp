@@ -0,0 +1,268 @@
+#include "chatHistory.h"
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+
+namespace {
+
+// Cold block layout, per line: time (8), kind (1), user (4), body length (4), body
+const size_t lineHeaderSize = 8 + 1 + 4 + 4;
+
+template <typename T>
+void put(std::string& out, T value) {
+	out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+T get(const char*& in) {
+	T value;
+	std::memcpy(&value, in, sizeof(value));
+	in += sizeof(value);
+	return value;
+}
+
+} // namespace
+
+ChatHistory::ChatHistory()
+  : limits() {}
+
+ChatHistory::ChatHistory(const Limits& limits)
+  : limits(limits) {}
+
+void ChatHistory::attachArchive(const RoomLog& log) {
+	archive = &log;
+	archiveLines = log.mappedCount();
+}
+
+void ChatHistory::addMessage(std::string_view username, std::string_view message) {
+	append(Kind::User, usernames.intern(username), message);
+}
+
+void ChatHistory::addSystemMessage(std::string_view message) {
+	append(Kind::System, 0, message);
+}
+
+void ChatHistory::append(Kind kind, uint32_t user, std::string_view body) {
+	if (hot.empty() || hot.back().records.size() == blockLines) {
+		hot.emplace_back();
+		hot.back().records.reserve(blockLines);
+	}
+
+	Block& block = hot.back();
+	std::string_view stored = block.bodies.store(body);
+	block.records.push_back({ stored.data(), static_cast<uint32_t>(stored.size()), user, std::time(nullptr), kind });
+	hotLines++;
+	index.add(block.records.back().time, kind == Kind::User ? usernames.lookup(user) : std::string_view(), body);
+
+	// Keep at least limits.hotLines uncompressed; everything older moves to the cold tier
+	while (hot.size() > 1 && hotLines - hot.front().records.size() >= limits.hotLines)
+		freeze();
+}
+
+void ChatHistory::freeze() {
+	Block& block = hot.front();
+
+	if (limits.coldBytes == 0) {
+		// No cold tier: the block would be compressed only to be dropped right away
+		hotLines -= block.records.size();
+		dropped += block.records.size();
+		hot.pop_front();
+		index.dropBefore(dropped);
+		return;
+	}
+
+	std::string raw;
+	size_t bodyBytes = 0;
+	for (const Record& line : block.records)
+		bodyBytes += line.bodyLength;
+	raw.reserve(block.records.size() * lineHeaderSize + bodyBytes);
+
+	for (const Record& line : block.records) {
+		put<int64_t>(raw, line.time);
+		put<uint8_t>(raw, static_cast<uint8_t>(line.kind));
+		put<uint32_t>(raw, line.user);
+		put<uint32_t>(raw, line.bodyLength);
+		raw.append(line.body, line.bodyLength);
+	}
+
+	// Fast level: blocks are written once per blockLines messages and read when scrolling back
+	uLongf compressedSize = compressBound(raw.size());
+	ColdBlock packed;
+	packed.data.resize(compressedSize);
+	compress2(reinterpret_cast<Bytef*>(&packed.data[0]), &compressedSize, reinterpret_cast<const Bytef*>(raw.data()),
+			  raw.size(), Z_BEST_SPEED);
+	packed.data.resize(compressedSize);
+	packed.data.shrink_to_fit();
+	packed.rawSize = raw.size();
+
+	coldBytes += packed.data.size();
+	coldRawBytes += packed.rawSize;
+	coldLines += block.records.size();
+	hotLines -= block.records.size();
+	cold.push_back(std::move(packed));
+	hot.pop_front();
+
+	// Over budget: forget the oldest lines
+	while (coldBytes > limits.coldBytes && !cold.empty()) {
+		coldBytes -= cold.front().data.size();
+		coldRawBytes -= cold.front().rawSize;
+		coldLines -= blockLines;
+		dropped += blockLines;
+		cold.pop_front();
+		cachedIndex = SIZE_MAX; // Block indices shifted
+	}
+	index.dropBefore(dropped);
+}
+
+const ChatHistory::Block& ChatHistory::coldBlock(size_t index) const {
+	if (index == cachedIndex) return cachedBlock;
+
+	const ColdBlock& packed = cold[index];
+	std::string raw(packed.rawSize, '\0');
+	uLongf rawSize = raw.size();
+	uncompress(reinterpret_cast<Bytef*>(&raw[0]), &rawSize, reinterpret_cast<const Bytef*>(packed.data.data()),
+			   packed.data.size());
+	decompressions++;
+
+	cachedBlock = Block();
+	cachedBlock.records.reserve(blockLines);
+	const char* in = raw.data();
+	const char* end = raw.data() + rawSize;
+	while (end - in >= static_cast<ptrdiff_t>(lineHeaderSize)) {
+		Record line;
+		line.time = static_cast<time_t>(get<int64_t>(in));
+		line.kind = static_cast<Kind>(get<uint8_t>(in));
+		line.user = get<uint32_t>(in);
+		line.bodyLength = get<uint32_t>(in);
+		if (end - in < static_cast<ptrdiff_t>(line.bodyLength)) break;
+		line.body = cachedBlock.bodies.store(std::string_view(in, line.bodyLength)).data();
+		in += line.bodyLength;
+		cachedBlock.records.push_back(line);
+	}
+
+	cachedIndex = index;
+	return cachedBlock;
+}
+
+const ChatHistory::Record& ChatHistory::record(size_t index) const {
+	if (index < archiveLines) {
+		// Straight out of the mapping, nothing is copied
+		RoomLog::Entry entry{};
+		archive->read(index, entry);
+		archivedRecord.body = entry.body.data();
+		archivedRecord.bodyLength = static_cast<uint32_t>(entry.body.size());
+		archivedRecord.kind = entry.system ? Kind::System : Kind::User;
+		archivedRecord.user = entry.system ? 0 : usernames.intern(entry.username);
+		archivedRecord.time = entry.time;
+		return archivedRecord;
+	}
+
+	index -= archiveLines;
+	if (index < coldLines) {
+		const Block& block = coldBlock(index / blockLines);
+		return block.records[std::min(index % blockLines, block.records.size() - 1)];
+	}
+
+	// Every hot block but the newest is full
+	index -= coldLines;
+	return hot[index / blockLines].records[index % blockLines];
+}
+
+int64_t ChatHistory::lineId(size_t index) const {
+	if (index < archiveLines) return static_cast<int64_t>(index) - static_cast<int64_t>(archiveLines);
+	return static_cast<int64_t>(index - archiveLines + dropped);
+}
+
+bool ChatHistory::find(int64_t id, size_t& index) const {
+	if (id < 0) {
+		if (static_cast<uint64_t>(-id) > archiveLines) return false;
+		index = archiveLines + id;
+		return true;
+	}
+	if (static_cast<uint64_t>(id) < dropped || static_cast<uint64_t>(id) - dropped >= coldLines + hotLines)
+		return false;
+	index = archiveLines + (id - dropped);
+	return true;
+}
+
+std::vector<int64_t> ChatHistory::search(const SearchIndex::Query& query, size_t limit) const {
+	// Appended lines are indexed under their ids; dropped ones are gone from the index as well
+	std::vector<int64_t> ids;
+	for (uint64_t line : index.search(query, limit))
+		ids.push_back(static_cast<int64_t>(line));
+
+	if (ids.size() < limit && archiveLines > 0) {
+		// The log's time index narrows a time-bounded query to the lines in range
+		size_t first = archive->lowerBound(query.after);
+		size_t last = query.before == 0 ? archiveLines : std::max(first, archive->lowerBound(query.before + 1));
+
+		if (!archiveIndex && (last - first) * 2 < archiveLines) {
+			// A small range is indexed for this search only, without paging in the rest of the log
+			SearchIndex range;
+			indexArchive(range, first, last);
+			for (uint64_t line : range.search(query, limit - ids.size()))
+				ids.push_back(static_cast<int64_t>(first + line) - static_cast<int64_t>(archiveLines));
+			return ids;
+		}
+
+		if (!archiveIndex) {
+			// One pass over the mapped log; later searches only probe the index
+			archiveIndex = std::make_unique<SearchIndex>();
+			indexArchive(*archiveIndex, 0, archiveLines);
+		}
+		for (uint64_t line : archiveIndex->search(query, limit - ids.size()))
+			ids.push_back(static_cast<int64_t>(line) - static_cast<int64_t>(archiveLines));
+	}
+	return ids;
+}
+
+void ChatHistory::indexArchive(SearchIndex& target, size_t first, size_t last) const {
+	RoomLog::Entry entry{};
+	for (size_t i = first; i < last; ++i) {
+		if (!archive->read(i, entry)) entry = RoomLog::Entry{ entry.time, true, {}, {} }; // Keeps times sorted
+		target.add(entry.time, entry.system ? std::string_view() : entry.username, entry.body);
+	}
+}
+
+void ChatHistory::format(size_t index, std::string& out) const {
+	const Record& line = record(index);
+	out = timestamp(line.time);
+	if (line.kind == Kind::User) {
+		out += username(line);
+		out += ": ";
+	} else {
+		out += "* ";
+	}
+	out += body(line);
+}
+
+size_t ChatHistory::memoryUsed() const {
+	Stats stats = getStats();
+	return stats.hotBytes + stats.coldBytes;
+}
+
+ChatHistory::Stats ChatHistory::getStats() const {
+	Stats stats;
+	stats.hotLines = hotLines;
+	for (const Block& block : hot)
+		stats.hotBytes += block.records.capacity() * sizeof(Record) + block.bodies.bytesReserved();
+	stats.archivedLines = archiveLines;
+	stats.coldLines = coldLines;
+	stats.coldBlocks = cold.size();
+	stats.coldBytes = coldBytes;
+	stats.coldRawBytes = coldRawBytes;
+	stats.droppedLines = dropped;
+	stats.decompressions = decompressions;
+	stats.indexBytes = index.memoryUsed() + (archiveIndex ? archiveIndex->memoryUsed() : 0);
+	return stats;
+}
+
+const char* ChatHistory::timestamp(time_t time) const {
+	if (time != cachedSecond) {
+		std::tm tm;
+		localtime_r(&time, &tm);
+		std::strftime(cachedStamp, sizeof(cachedStamp), "[%H:%M:%S] ", &tm);
+		cachedSecond = time;
+	}
+	return cachedStamp;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "../storage/roomLog.h"
+#include "../util/stringArena.h"
+#include "../util/stringInterner.h"
+#include "searchIndex.h"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Scrollback of one room, rendered by ChatElement while the room is shown.
+// Lines are kept as compact records (time, interned username, body in an arena) and only
+// formatted when drawn. The most recent lines stay in memory (hot tier); older ones are packed
+// into fixed-size blocks compressed with zlib (cold tier) and decompressed when scrolled to.
+// Once the cold tier exceeds its budget the oldest blocks are discarded.
+// With a persistent log attached, the lines it held at that point come before all of these and
+// are read from its mapping on demand.
+// Every appended line is also added to a search index, which forgets lines as they are dropped;
+// the archive is indexed on the first search.
+class ChatHistory {
+  public:
+	enum class Kind : uint8_t { User, System };
+
+	struct Record {
+		const char* body;
+		uint32_t bodyLength;
+		uint32_t user; // Interned username, User records only
+		time_t time;
+		Kind kind;
+	};
+
+	struct Limits {
+		size_t hotLines = 5000;              // Lines always kept uncompressed
+		size_t coldBytes = 64 * 1024 * 1024; // Compressed bytes kept before the oldest are dropped
+	};
+
+	struct Stats {
+		size_t hotLines = 0;
+		size_t hotBytes = 0;
+		size_t coldLines = 0;
+		size_t coldBlocks = 0;
+		size_t coldBytes = 0;    // Compressed
+		size_t coldRawBytes = 0; // Before compression
+		size_t archivedLines = 0;
+		uint64_t droppedLines = 0;
+		uint64_t decompressions = 0;
+		size_t indexBytes = 0;
+	};
+
+	// Lines per cold block
+	static constexpr size_t blockLines = 256;
+
+	ChatHistory();
+	explicit ChatHistory(const Limits& limits);
+
+	// Append a line stamped with the current time
+	void addMessage(std::string_view username, std::string_view message);
+	void addSystemMessage(std::string_view message);
+
+	// Show the lines already in log before everything in memory; the log must outlive the history
+	void attachArchive(const RoomLog& log);
+
+	// Lines still retained; index 0 is the oldest of them
+	size_t size() const { return archiveLines + coldLines + hotLines; }
+
+	// Cheap parts of getStats() for callers that check them on every draw
+	size_t archivedLines() const { return archiveLines; }
+	uint64_t droppedLines() const { return dropped; }
+
+	// An archived or cold record (and its body) stays valid until another such record is accessed
+	const Record& record(size_t index) const;
+	std::string_view body(const Record& record) const { return std::string_view(record.body, record.bodyLength); }
+	std::string_view username(const Record& record) const { return usernames.lookup(record.user); }
+
+	// Render "[HH:MM:SS] user: text" or "[HH:MM:SS] * text" into out (cleared first)
+	void format(size_t index, std::string& out) const;
+
+	// Stable line ids for search results, unaffected by older lines being dropped: appended lines
+	// count up from 0, archived lines count down from -1. find() fails once a line was dropped.
+	int64_t lineId(size_t index) const;
+	bool find(int64_t id, size_t& index) const;
+
+	// Ids of matching lines, newest first, at most limit
+	std::vector<int64_t> search(const SearchIndex::Query& query, size_t limit) const;
+
+	// Bytes held by both tiers
+	size_t memoryUsed() const;
+
+	// Walks every block and posting list; for /stats, not per frame
+	Stats getStats() const;
+
+  private:
+	struct Block {
+		std::vector<Record> records;
+		StringArena bodies{ 16 * 1024 };
+	};
+
+	struct ColdBlock {
+		std::string data; // zlib stream of serialized records
+		size_t rawSize;
+	};
+
+	Limits limits;
+	mutable StringInterner usernames; // Archived usernames are interned as they are read
+
+	const RoomLog* archive = nullptr;
+	size_t archiveLines = 0;
+	mutable Record archivedRecord;
+
+	std::deque<Block> hot; // Full blocks of blockLines, the newest may be partial
+	size_t hotLines = 0;
+
+	std::deque<ColdBlock> cold;
+	size_t coldLines = 0;
+	size_t coldBytes = 0;
+	size_t coldRawBytes = 0;
+	uint64_t dropped = 0; // Cold lines discarded for the byte budget
+
+	SearchIndex index;
+	mutable std::unique_ptr<SearchIndex> archiveIndex; // Built by the first search
+
+	// The most recently decompressed cold block
+	mutable Block cachedBlock;
+	mutable size_t cachedIndex = SIZE_MAX;
+	mutable uint64_t decompressions = 0;
+
+	// Lines drawn together are mostly from the same second
+	mutable time_t cachedSecond = -1;
+	mutable char cachedStamp[16] = {};
+
+	void append(Kind kind, uint32_t user, std::string_view body);
+	void indexArchive(SearchIndex& target, size_t first, size_t last) const;
+	void freeze();
+	const Block& coldBlock(size_t index) const;
+	const char* timestamp(time_t time) const;
+};
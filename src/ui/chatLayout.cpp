@@ -0,0 +1,136 @@
+#include "chatLayout.h"
+#include "../util/displayText.h"
+#include <algorithm>
+#include <climits>
+
+namespace {
+
+size_t lowBit(size_t i) {
+	return i & (~i + 1);
+}
+
+} // namespace
+
+void ChatLayout::wrap(std::string_view text, int width, std::vector<std::string_view>& rows) {
+	rows.clear();
+	if (width < 1) width = 1;
+
+	size_t rowStart = 0;
+	while (rowStart < text.size()) {
+		int used = 0;
+		size_t i = rowStart;
+		size_t lastBreak = 0; // Byte after the last space in this row
+		while (i < text.size()) {
+			int columns;
+			size_t length = DisplayText::next(text, i, columns);
+			if (used + columns > width) break;
+			used += columns;
+			i += length;
+			if (text[i - 1] == ' ') lastBreak = i;
+		}
+
+		// Break at a word boundary unless the word fills the whole row
+		size_t rowEnd = i;
+		if (i < text.size() && lastBreak > rowStart && text[i] != ' ') rowEnd = lastBreak;
+		if (rowEnd == rowStart) rowEnd = i + DisplayText::next(text, i, used); // A character wider than the row
+
+		rows.push_back(text.substr(rowStart, rowEnd - rowStart));
+		rowStart = rowEnd;
+		if (rowEnd == i && rowStart < text.size() && text[rowStart] == ' ') rowStart++; // Space at a hard break
+	}
+	if (rows.empty()) rows.push_back(text);
+}
+
+void ChatLayout::sync(const ChatHistory& newHistory, int newWidth) {
+	size_t newArchivedLines = newHistory.archivedLines();
+	uint64_t newDroppedLines = newHistory.droppedLines();
+	if (&newHistory != history || newWidth != width || newArchivedLines != archivedLines) {
+		history = &newHistory;
+		width = newWidth;
+		archivedLines = newArchivedLines;
+		droppedLines = newDroppedLines;
+		counts.assign(newHistory.size(), 0);
+		rebuild();
+		return;
+	}
+
+	if (newDroppedLines != droppedLines) {
+		// Cold blocks were discarded from the front of the in-memory lines
+		size_t dropped = std::min<size_t>(newDroppedLines - droppedLines, counts.size() - archivedLines);
+		counts.erase(counts.begin() + archivedLines, counts.begin() + archivedLines + dropped);
+		droppedLines = newDroppedLines;
+		rebuild();
+	}
+
+	// New lines are not measured until they are shown
+	while (counts.size() < newHistory.size()) {
+		counts.push_back(0);
+		push(1);
+	}
+}
+
+uint32_t ChatLayout::rows(size_t line) {
+	if (counts[line] == 0) {
+		history->format(line, lineBuffer);
+		wrap(lineBuffer, width, rowBuffer);
+		counts[line] = static_cast<uint16_t>(std::min<size_t>(rowBuffer.size(), UINT16_MAX));
+		add(line, counts[line] - 1);
+	}
+	return counts[line];
+}
+
+void ChatLayout::rebuild() {
+	tree.assign(counts.size() + 1, 0);
+	for (size_t i = 1; i <= counts.size(); ++i) {
+		tree[i] += std::max<uint32_t>(counts[i - 1], 1);
+		size_t parent = i + lowBit(i);
+		if (parent <= counts.size()) tree[parent] += tree[i];
+	}
+}
+
+void ChatLayout::push(uint32_t value) {
+	// The new node covers (i - lowBit(i), i]: its own value plus the nodes directly below it
+	size_t i = tree.size();
+	uint32_t sum = value;
+	for (size_t child = 1; child < lowBit(i); child <<= 1)
+		sum += tree[i - child];
+	tree.push_back(sum);
+}
+
+void ChatLayout::add(size_t line, int32_t delta) {
+	for (size_t i = line + 1; i < tree.size(); i += lowBit(i))
+		tree[i] += delta;
+}
+
+size_t ChatLayout::rowsBefore(size_t line) const {
+	size_t sum = 0;
+	for (size_t i = line; i > 0; i -= lowBit(i))
+		sum += tree[i];
+	return sum;
+}
+
+size_t ChatLayout::lineAtRow(size_t row, size_t& rowInLine) const {
+	// Descend the tree for the last line whose preceding rows are <= row
+	size_t line = 0;
+	size_t step = 1;
+	while (step * 2 < tree.size())
+		step *= 2;
+	for (; step > 0; step /= 2) {
+		if (line + step < tree.size() && tree[line + step] <= row) {
+			line += step;
+			row -= tree[line];
+		}
+	}
+
+	if (line >= counts.size()) {
+		// Past the end: the last row of the last line
+		if (counts.empty()) {
+			rowInLine = 0;
+			return 0;
+		}
+		line = counts.size() - 1;
+		row = std::max<uint32_t>(counts[line], 1) - 1;
+	}
+	rowInLine = row;
+	return line;
+}
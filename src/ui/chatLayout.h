@@ -0,0 +1,44 @@
+#pragma once
+
+#include "chatHistory.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Screen rows taken by each line of a ChatHistory once wrapped to a given width.
+// Lines are only measured when asked for; until then they count as one row. Row totals are kept
+// in a Fenwick tree, so converting between rows and lines is O(log n) however long the history.
+class ChatLayout {
+  public:
+	// Forget every measurement if the history, its width or its oldest lines changed, and take
+	// in lines appended since the last call (unmeasured)
+	void sync(const ChatHistory& history, int width);
+
+	// Rows of a line, measured on first use
+	uint32_t rows(size_t line);
+
+	// Rows of all lines before line, and the line holding a given row (with the row inside it)
+	size_t rowsBefore(size_t line) const;
+	size_t lineAtRow(size_t row, size_t& rowInLine) const;
+	size_t totalRows() const { return rowsBefore(counts.size()); }
+	size_t lines() const { return counts.size(); }
+
+	// Split text into rows of at most width display columns, preferring to break after a space
+	static void wrap(std::string_view text, int width, std::vector<std::string_view>& rows);
+
+  private:
+	const ChatHistory* history = nullptr;
+	int width = 0;
+	size_t archivedLines = 0;
+	uint64_t droppedLines = 0;
+
+	std::vector<uint16_t> counts; // Rows per line, 0 while unmeasured
+	std::vector<uint32_t> tree;   // Fenwick tree over max(counts, 1), 1-based
+	std::string lineBuffer;
+	std::vector<std::string_view> rowBuffer;
+
+	void rebuild();
+	void push(uint32_t value);
+	void add(size_t line, int32_t delta);
+};
@@ -0,0 +1,105 @@
+#include "completer.h"
+#include <algorithm>
+
+namespace {
+
+// The word at wordStart is the first argument of command
+bool isFirstArgument(std::string_view line, size_t wordStart, std::string_view command) {
+	return line.size() > command.size() && line.compare(0, command.size(), command) == 0 &&
+		   line[command.size()] == ' ' && line.find_first_not_of(' ', command.size()) == wordStart;
+}
+
+} // namespace
+
+void Completer::setUsers(const UserList* users) {
+	this->users = users;
+	reset();
+}
+
+void Completer::setRooms(const std::vector<std::string>& names) {
+	std::vector<std::string> sorted = names;
+	std::sort(sorted.begin(), sorted.end());
+	sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+	// Walk both sorted lists together: names only in the old one are gone, only in the new one added
+	size_t i = 0, j = 0;
+	while (i < roomNames.size() || j < sorted.size()) {
+		if (j == sorted.size() || (i < roomNames.size() && roomNames[i] < sorted[j])) {
+			rooms.erase(roomNames[i++]);
+		} else if (i == roomNames.size() || sorted[j] < roomNames[i]) {
+			rooms.insert(sorted[j++]);
+		} else {
+			i++;
+			j++;
+		}
+	}
+	roomNames.swap(sorted);
+	if (source == Source::Rooms) reset();
+}
+
+bool Completer::start(std::string_view beforeCursor) {
+	size_t wordStart = beforeCursor.find_last_of(" \n");
+	wordStart = wordStart == std::string_view::npos ? 0 : wordStart + 1;
+	std::string_view word = beforeCursor.substr(wordStart);
+
+	if (wordStart == 0 && !word.empty() && word[0] == '/') {
+		source = Source::Commands;
+	} else if (isFirstArgument(beforeCursor, wordStart, "/join") ||
+			   isFirstArgument(beforeCursor, wordStart, "/switch")) {
+		source = Source::Rooms;
+	} else {
+		// A mention or a /search sender keeps its marker
+		source = Source::Users;
+		if (word.compare(0, 5, "from:") == 0)
+			word.remove_prefix(5);
+		else if (word.compare(0, 1, "@") == 0)
+			word.remove_prefix(1);
+	}
+
+	prefix.assign(word);
+	insertedBytes = word.size();
+	switch (source) {
+		case Source::Commands: count = commands ? commands->count(prefix) : 0; break;
+		case Source::Rooms: count = rooms.count(prefix); break;
+		case Source::Users: {
+			size_t last = first = 0;
+			if (users) users->prefixRange(prefix, first, last);
+			count = last - first;
+			break;
+		}
+	}
+	return count > 0;
+}
+
+bool Completer::fetch(size_t position, std::string& out) const {
+	switch (source) {
+		case Source::Commands: return commands && commands->nth(prefix, position, out);
+		case Source::Rooms: return rooms.nth(prefix, position, out);
+		case Source::Users:
+			if (!users || first + position >= users->size()) return false;
+			out.assign((*users)[first + position]);
+			return true;
+	}
+	return false;
+}
+
+bool Completer::cycle(InputElement& input, int direction) {
+	if (cycling) {
+		index = (index + count + (direction < 0 ? -1 : 1)) % count;
+	} else {
+		if (!start(input.beforeCursor())) return false;
+		index = direction < 0 ? count - 1 : 0;
+		cycling = true;
+	}
+
+	if (!fetch(index, match)) {
+		reset();
+		return false;
+	}
+
+	// A single match is finished off with a space, ready for the next word
+	if (count == 1) match += ' ';
+	input.replaceBeforeCursor(insertedBytes, match);
+	insertedBytes = match.size();
+	return true;
+}
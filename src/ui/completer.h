@@ -0,0 +1,52 @@
+#pragma once
+
+#include "../util/prefixTrie.h"
+#include "elements/inputElement.h"
+#include "userList.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Tab completion of the word before the input cursor: command names at the start of the line,
+// room names as the first argument of /join and /switch, and room members anywhere else (also
+// after "@" or "from:"). Repeated Tabs cycle through the matches in order, each one fetched by
+// position from a trie or the sorted member list, so a cycle costs the same with ten matches
+// or fifty thousand.
+class Completer {
+  public:
+	// Lists matched against; commands and users must outlive the completer or be replaced
+	void setCommands(const PrefixTrie* commands) { this->commands = commands; }
+	void setUsers(const UserList* users);
+
+	// Replace the known rooms; only names added or gone since the last list touch the trie
+	void setRooms(const std::vector<std::string>& names);
+
+	// Put the next (direction 1) or previous (-1) match in place of the word before the cursor,
+	// starting a new cycle if none is going on; false if nothing matches
+	bool cycle(InputElement& input, int direction);
+
+	// End the cycle, e.g. on any key other than Tab; the next Tab completes what is typed then
+	void reset() { cycling = false; }
+
+  private:
+	enum class Source { Commands, Rooms, Users };
+
+	const PrefixTrie* commands = nullptr;
+	const UserList* users = nullptr;
+	PrefixTrie rooms;
+	std::vector<std::string> roomNames; // Sorted, as in rooms
+
+	// Current cycle
+	bool cycling = false;
+	Source source = Source::Users;
+	std::string prefix;       // What was typed before the first Tab
+	size_t first = 0;         // Users: position of the first match
+	size_t count = 0;         // Matches
+	size_t index = 0;         // Match shown
+	size_t insertedBytes = 0; // Length of the text standing in for the word now
+	std::string match;
+
+	bool start(std::string_view beforeCursor);
+	bool fetch(size_t position, std::string& out) const;
+};
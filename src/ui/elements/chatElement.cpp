@@ -1,90 +1,321 @@
 #include "chatElement.h"
+#include "../../util/displayText.h"
 #include <algorithm>
 
-ChatElement::ChatElement(int height, int width, int startY, int startX)
-  : UIElement(height, width, startY, startX)
-  , scrollPosition(0) {
+ChatElement::ChatElement(Screen& screen, int height, int width, int startY, int startX)
+  : UIElement(screen, height, width, startY, startX)
+  , history(&localHistory)
+  , topLine(0)
+  , topRow(0)
+  , followBottom(true)
+  , showingResults(false)
+  , selectedResult(0)
+  , markedLine(0)
+  , hasMarkedLine(false)
+  , fullDamage(true)
+  , titleDamage(false)
+  , appendedLines(0)
+  , shownRows(0) {
 
-	win = newwin(height, width, startY, startX);
 	draw();
 }
 
 void ChatElement::draw() {
-	if (!win) return;
+	// A resize replaces the surface
+	if (surfaceReplaced) {
+		surface->setScrollRegion(1, height - 2); // Scroll the content rows only, never the top and bottom border
+		surfaceReplaced = false;
+		fullDamage = true;
+	}
+
+	if (!fullDamage && appendedLines > 0 && !drawAppended()) fullDamage = true;
+
+	if (fullDamage)
+		drawAll();
+	else if (titleDamage)
+		drawTitle();
+
+	fullDamage = titleDamage = false;
+	appendedLines = 0;
+	needRedraw = false;
+}
+
+void ChatElement::drawTitle() {
+	surface->horizontalLine(0, 1, width - 2);
+
+	// Display room tabs (or the room name) instead of "Chat" if available
+	std::string text = title();
+	surface->print(0, 2, std::string_view(text).substr(0, DisplayText::fit(text, std::max(0, width - 4))));
+}
+
+void ChatElement::drawAll() {
+	surface->blank();
+	surface->drawBox();
+	drawTitle();
+
+	if (showingResults) {
+		drawResults();
+		return;
+	}
+
+	layout.sync(*history, width - 2);
+	if (followBottom) anchorToBottom();
+
+	// Only lines on screen are formatted and wrapped
+	int visibleRows = height - 2;
+	shownRows = 0;
+	size_t skip = topRow;
+	for (size_t line = topIndex(); line < history->size() && shownRows < visibleRows; ++line) {
+		drawLine(line, skip, shownRows);
+		skip = 0;
+	}
+}
+
+bool ChatElement::drawAppended() {
+	// Only the common case: new lines below a pane pinned to the bottom
+	if (showingResults || !followBottom) return false;
+
+	layout.sync(*history, width - 2);
+	int visibleRows = height - 2;
+	size_t first = history->size() - std::min(appendedLines, history->size());
+	int newRows = 0;
+	for (size_t line = first; line < history->size(); ++line) {
+		newRows += layout.rows(line);
+		if (newRows >= visibleRows) return false;
+	}
+
+	// Scroll the rows above up just enough to make room, then draw only the new rows
+	int overflow = shownRows + newRows - visibleRows;
+	if (overflow > 0) {
+		surface->scrollUp(overflow);
+		shownRows -= overflow;
+	}
 
-	werase(win);
+	for (size_t line = first; line < history->size(); ++line)
+		drawLine(line, 0, shownRows);
+
+	anchorToBottom();
+	return true;
+}
 
-	// Draw border and title
-	box(win, 0, 0);
+void ChatElement::drawLine(size_t line, size_t skipRows, int& row) {
+	history->format(line, lineBuffer);
+	ChatLayout::wrap(lineBuffer, width - 2, rowBuffer);
 
-	// Display room name instead of "Chat" if available
-	std::string title = roomName.empty() ? " Chat " : " " + roomName + " ";
-	mvwprintw(win, 0, 2, "%s", title.c_str());
+	size_t marked = SIZE_MAX;
+	if (hasMarkedLine) history->find(markedLine, marked);
+
+	if (line == marked) surface->setReverse(true);
+	for (size_t r = skipRows; r < rowBuffer.size() && row < height - 2; ++r, ++row) {
+		surface->print(row + 1, 1, rowBuffer[r]);
+
+		// Rows scrolled in are blank, border included
+		surface->verticalLine(row + 1, 0, 1);
+		surface->verticalLine(row + 1, width - 1, 1);
+	}
+	if (line == marked) surface->setReverse(false);
+}
 
-	// Calculate visible lines (accounting for border)
+void ChatElement::drawResults() {
 	int visibleLines = height - 2;
 
-	// Adjust scroll position if needed
-	if (messages.size() > static_cast<size_t>(visibleLines)) {
-		if (scrollPosition > static_cast<int>(messages.size() - visibleLines))
-			scrollPosition = messages.size() - visibleLines;
-		if (scrollPosition < 0) scrollPosition = 0;
-	} else {
-		scrollPosition = 0;
+	// Keep the selection in view, showing as many of the newest results as possible
+	size_t first = results.size() > static_cast<size_t>(visibleLines) ? results.size() - visibleLines : 0;
+	if (selectedResult < first) first = selectedResult;
+
+	for (size_t row = 0; row < static_cast<size_t>(visibleLines) && first + row < results.size(); ++row) {
+		size_t index;
+		if (history->find(results[first + row], index))
+			history->format(index, lineBuffer);
+		else
+			lineBuffer = "(no longer in memory)";
+
+		// One row per result
+		ChatLayout::wrap(lineBuffer, width - 2, rowBuffer);
+
+		bool selected = first + row == selectedResult;
+		if (selected) surface->setReverse(true);
+		surface->print(row + 1, 1, rowBuffer[0]);
+		if (selected) surface->setReverse(false);
 	}
+}
 
-	// Display messages with scrolling
-	size_t startIdx = scrollPosition;
+void ChatElement::showResults(const std::vector<int64_t>& ids, const std::string& title) {
+	results.assign(ids.rbegin(), ids.rend());
+	resultsTitle = title;
+	selectedResult = results.empty() ? 0 : results.size() - 1;
+	showingResults = true;
+	invalidate();
+}
 
-	for (size_t i = 0; i < std::min(messages.size() - startIdx, static_cast<size_t>(visibleLines)); ++i)
-		mvwprintw(win, i + 1, 1, "%.*s", width - 2, messages[startIdx + i].c_str());
+void ChatElement::openResult() {
+	showingResults = false;
+	invalidate();
 
-	needRedraw = false;
+	size_t index;
+	if (selectedResult >= results.size() || !history->find(results[selectedResult], index)) return;
+
+	// Put the line in the middle of the pane
+	layout.sync(*history, width - 2);
+	followBottom = false;
+	setTop(index, 0);
+	moveRows(-(height - 2) / 2);
+	markedLine = results[selectedResult];
+	hasMarkedLine = true;
 }
 
 void ChatElement::refresh() {
-	if (!win) return;
-	wrefresh(win);
+	surface->present();
 }
 
 void ChatElement::handleInput(int ch) {
+	if (showingResults) {
+		if (ch == KEY_UP && selectedResult > 0)
+			selectedResult--;
+		else if (ch == KEY_DOWN && selectedResult + 1 < results.size())
+			selectedResult++;
+		else if (ch == '\n')
+			openResult();
+		else if (ch == 27) // Escape
+			showingResults = false;
+		invalidate();
+		return;
+	}
+
 	if (ch == KEY_DOWN) // Down Arrow and mouse scroll
 		scrollDown();
 	else if (ch == KEY_UP) // Up Arrow and mouse scroll
 		scrollUp();
-	refresh();
+	else if (ch == KEY_PPAGE)
+		scrollPageUp();
+	else if (ch == KEY_NPAGE)
+		scrollPageDown();
+	else if (ch == KEY_HOME)
+		scrollToTop();
+	else if (ch == KEY_END)
+		scrollToBottom();
 }
 
-void ChatElement::addMessage(const std::string& message) {
-	bool wasOnBottom = isOnBottom();
-	messages.push_back(message);
+void ChatElement::setHistory(ChatHistory* newHistory) {
+	history = newHistory ? newHistory : &localHistory;
+	showingResults = false;
+	hasMarkedLine = false;
 
-	if (wasOnBottom) scrollPosition = messages.size() - (height - 2);
+	// Start at the bottom of the newly shown room
+	followBottom = true;
+	invalidate();
+}
 
+void ChatElement::onHistoryAppended(size_t count) {
+	// Laid out at the next draw if the bottom is shown, when scrolled to otherwise
+	if (!followBottom || showingResults) return;
+	appendedLines += count;
 	needRedraw = true;
 }
 
-void ChatElement::scrollUp() {
-	if (scrollPosition > 0) {
-		--scrollPosition;
-		needRedraw = true;
+void ChatElement::invalidate() {
+	fullDamage = needRedraw = true;
+}
+
+size_t ChatElement::topIndex() const {
+	size_t index;
+	return history->find(topLine, index) ? index : 0;
+}
+
+void ChatElement::setTop(size_t index, size_t row) {
+	topLine = history->size() > 0 ? history->lineId(index) : 0;
+	topRow = row;
+}
+
+void ChatElement::anchorToBottom() {
+	// Walk back from the newest line until the pane is full
+	int remaining = height - 2;
+	size_t line = history->size();
+	while (line > 0 && remaining > 0)
+		remaining -= layout.rows(--line);
+	setTop(line, remaining < 0 ? -remaining : 0);
+}
+
+bool ChatElement::bottomVisible() {
+	int remaining = height - 2 + static_cast<int>(topRow);
+	for (size_t line = topIndex(); line < history->size(); ++line) {
+		remaining -= layout.rows(line);
+		if (remaining < 0) return false;
 	}
+	return true;
+}
+
+void ChatElement::moveRows(long delta) {
+	if (history->size() == 0) return;
+	layout.sync(*history, width - 2);
+	if (followBottom) anchorToBottom();
+
+	// Rows of lines not shown yet are estimated, so land on a line and measure it
+	long target = static_cast<long>(layout.rowsBefore(topIndex()) + topRow) + delta;
+	size_t row;
+	size_t line = layout.lineAtRow(static_cast<size_t>(std::max(0L, target)), row);
+	setTop(line, std::min<size_t>(row, layout.rows(line) - 1));
+
+	followBottom = bottomVisible();
+	invalidate();
+}
+
+void ChatElement::scrollUp() {
+	moveRows(-1);
 }
 
 void ChatElement::scrollDown() {
-	int visibleLines = height - 2;
-	if (scrollPosition < static_cast<int>(messages.size() - visibleLines)) {
-		++scrollPosition;
-		needRedraw = true;
-	}
+	if (!followBottom) moveRows(1);
+}
+
+void ChatElement::scrollPageUp() {
+	moveRows(-std::max(1, height - 3));
+}
+
+void ChatElement::scrollPageDown() {
+	if (!followBottom) moveRows(std::max(1, height - 3));
+}
+
+void ChatElement::scrollToTop() {
+	setTop(0, 0);
+	followBottom = false;
+	layout.sync(*history, width - 2);
+	followBottom = bottomVisible();
+	invalidate();
+}
+
+void ChatElement::scrollToBottom() {
+	followBottom = true;
+	invalidate();
 }
 
 bool ChatElement::isOnBottom() const {
-	int visibleLines = height - 2;
-	return scrollPosition >= static_cast<int>(messages.size() - visibleLines);
+	return followBottom;
 }
 
 void ChatElement::setRoomName(const std::string& name) {
 	roomName = name;
-	needRedraw = true;
-}
\ No newline at end of file
+	titleDamage = needRedraw = true;
+}
+void ChatElement::setTabs(const std::vector<Tab>& newTabs) {
+	tabs = newTabs;
+	titleDamage = needRedraw = true;
+}
+
+std::string ChatElement::title() const {
+	if (showingResults) return " " + resultsTitle + " - Enter: go to line, Esc: back ";
+
+	// A single room keeps the plain title
+	if (tabs.size() <= 1) return roomName.empty() ? " Chat " : " " + roomName + " ";
+
+	std::string result = " ";
+	for (size_t i = 0; i < tabs.size(); ++i) {
+		result += std::to_string(i + 1) + ":" + (tabs[i].name.empty() ? "-" : tabs[i].name);
+		if (tabs[i].active)
+			result += "*";
+		else if (tabs[i].unread > 0)
+			result += "(" + std::to_string(tabs[i].unread) + ")";
+		result += " ";
+	}
+	return result;
+}
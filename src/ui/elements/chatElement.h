@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../chatHistory.h"
+#include "../chatLayout.h"
 #include "uiElement.h"
 #include <ncurses.h>
 #include <string>
@@ -7,24 +9,82 @@
 
 class ChatElement : public UIElement {
   public:
-	ChatElement(int height, int width, int startY, int startX);
+	// One entry of the room tab bar drawn in the top border
+	struct Tab {
+		std::string name;
+		size_t unread;
+		bool active;
+	};
+
+	ChatElement(Screen& screen, int height, int width, int startY, int startX);
 
 	void draw() override;
 	void refresh() override;
 	void handleInput(int ch);
 
-	void addMessage(const std::string& message);
+	// Show another room's scrollback (nullptr shows an empty local history)
+	void setHistory(ChatHistory* newHistory);
+	ChatHistory& getHistory() { return *history; }
+
+	// Call after lines were appended to the shown history
+	void onHistoryAppended(size_t count = 1);
 
+	// Scrolling moves by screen rows; lines are wrapped to the pane width
 	void scrollUp();
 	void scrollDown();
 	void scrollPageUp();
 	void scrollPageDown();
+	void scrollToTop();
+	void scrollToBottom();
+
+	// Search results: the pane lists these lines (ids, newest first) instead of the scrollback.
+	// Up/Down select, Enter scrolls the scrollback to the selected line, Escape goes back.
+	void showResults(const std::vector<int64_t>& ids, const std::string& title);
+	bool isShowingResults() const { return showingResults; }
 
 	bool isOnBottom() const;
 	void setRoomName(const std::string& name);
+	void setTabs(const std::vector<Tab>& newTabs);
 
   private:
-	std::vector<std::string> messages;
-	int scrollPosition;
+	ChatHistory localHistory;
+	ChatHistory* history;
+	ChatLayout layout;
+
+	// Viewport: first shown row of line topLine (an id, stable when older lines are dropped), or
+	// pinned to the newest line while followBottom
+	int64_t topLine;
+	size_t topRow;
+	bool followBottom;
 	std::string roomName;
-};
\ No newline at end of file
+	std::vector<Tab> tabs;
+	std::string lineBuffer; // Reused to format each visible line
+	std::vector<std::string_view> rowBuffer;
+
+	bool showingResults;
+	std::vector<int64_t> results; // Oldest first, as drawn
+	std::string resultsTitle;
+	size_t selectedResult;
+	int64_t markedLine; // Id of the line a result was opened at, highlighted until the room changes
+	bool hasMarkedLine;
+
+	// Damage since the last draw: everything, the title, or lines appended at the bottom
+	bool fullDamage;
+	bool titleDamage;
+	size_t appendedLines;
+	int shownRows; // Content rows filled by the last draw
+
+	std::string title() const;
+	void invalidate();
+	void drawTitle();
+	void drawAll();
+	bool drawAppended();
+	void drawLine(size_t line, size_t skipRows, int& row);
+	size_t topIndex() const;
+	void setTop(size_t index, size_t row);
+	void anchorToBottom();
+	bool bottomVisible();
+	void moveRows(long delta);
+	void drawResults();
+	void openResult();
+};
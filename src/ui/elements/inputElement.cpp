@@ -1,67 +1,165 @@
 #include "inputElement.h"
-#include <climits>
-#include <codecvt>
-#include <locale>
+#include "../../util/displayText.h"
+#include <algorithm>
+#include <cwctype>
 
-InputElement::InputElement(int height, int width, int startY, int startX)
-  : UIElement(height, width, startY, startX)
-  , cursorPos(0) {
+namespace {
+
+// Append the columns [skip, skip + room) of piece to out; skip and room are reduced by what
+// piece covered, so a row split across several pieces is cut consistently
+void appendVisible(std::string_view piece, size_t& skip, size_t& room, std::string& out) {
+	size_t i = 0;
+	while (i < piece.size() && skip > 0) {
+		size_t run = std::min(DisplayText::asciiPrefix(piece.substr(i)), skip);
+		i += run;
+		skip -= run;
+		if (skip == 0 || i == piece.size()) break;
+
+		int columns;
+		size_t length = DisplayText::next(piece, i, columns);
+		i += length;
+		if (static_cast<size_t>(columns) > skip) {
+			// A wide character cut by the left edge shows as a blank
+			out.append(columns - skip, ' ');
+			room -= std::min(room, static_cast<size_t>(columns) - skip);
+			skip = 0;
+		} else {
+			skip -= columns;
+		}
+	}
+
+	std::string_view shown = piece.substr(i);
+	shown = shown.substr(0, DisplayText::fit(shown, room));
+	out.append(shown);
+	room -= DisplayText::width(shown);
+}
+
+} // namespace
+
+InputElement::InputElement(Screen& screen, int height, int width, int startY, int startX)
+  : UIElement(screen, height, width, startY, startX)
+  , composing(false)
+  , pasting(false)
+  , historyPosition(0)
+  , topLine(0)
+  , scrollColumn(0)
+  , cursorRow(0)
+  , cursorColumn(2) {
 
-	win = newwin(height, width, startY, startX);
-	keypad(win, TRUE);
-	wtimeout(win, 50);
 	draw();
 }
 
 void InputElement::draw() {
-	werase(win);
-	mvwprintw(win, 0, 0, "> ");
-	waddwstr(win, inputBuffer.c_str());
+	surface->blank();
+
+	std::string_view before = buffer.before();
+	std::string_view after = buffer.after();
+	size_t lineStart = before.rfind('\n');
+	lineStart = lineStart == std::string_view::npos ? 0 : lineStart + 1;
+	size_t lineEnd = std::min(after.find('\n'), after.size());
+	std::string_view head = before.substr(lineStart); // Cursor line up to the cursor
+	std::string_view tail = after.substr(0, lineEnd);
+
+	// Scroll sideways to keep the cursor in view, a quarter of the width beyond it
+	size_t textColumns = std::max(1, width - promptColumns());
+	size_t column = DisplayText::width(head);
+	if (column < scrollColumn)
+		scrollColumn = column - std::min(column, textColumns / 4);
+	else if (column >= scrollColumn + textColumns)
+		scrollColumn = column - textColumns * 3 / 4;
+
+	// And up or down to keep the cursor line shown
+	size_t cursorLine = composing ? std::count(before.begin(), before.end(), '\n') : 0;
+	size_t rows = std::max(1, height);
+	if (cursorLine < topLine)
+		topLine = cursorLine;
+	else if (cursorLine >= topLine + rows)
+		topLine = cursorLine - rows + 1;
+	if (!composing) topLine = 0;
+
+	// Lines above the cursor line come from the text before the gap, those below from after it
+	size_t position = 0;
+	for (size_t line = 0; line < topLine; ++line)
+		position = before.find('\n', position) + 1;
+	int row = 0;
+	for (size_t line = topLine; line < cursorLine; ++line, ++row) {
+		size_t end = before.find('\n', position);
+		drawRow(row, before.substr(position, end - position));
+		position = end + 1;
+	}
+
+	drawRow(row, head, tail);
+	cursorRow = row++;
+	cursorColumn = promptColumns() + static_cast<int>(column - scrollColumn);
+
+	position = lineEnd;
+	while (composing && row < height && position < after.size()) {
+		size_t end = std::min(after.find('\n', position + 1), after.size());
+		drawRow(row++, after.substr(position + 1, end - position - 1));
+		position = end;
+	}
+
 	needRedraw = false;
 }
 
+void InputElement::drawRow(int row, std::string_view head, std::string_view tail) {
+	surface->print(row, 0, composing ? "| " : row == 0 ? "> " : "  ");
+
+	size_t skip = scrollColumn;
+	size_t room = std::max(0, width - promptColumns());
+	rowBuffer.clear();
+	appendVisible(head, skip, room, rowBuffer);
+	appendVisible(tail, skip, room, rowBuffer);
+	surface->print(row, promptColumns(), rowBuffer);
+}
+
 void InputElement::refresh() {
-	if (!win) return;
-	wmove(win, 0, cursorPos + 2); // +2 for "> " prompt
-	wrefresh(win);
+	surface->moveCursor(cursorRow, cursorColumn);
+	surface->present();
 }
 
 bool InputElement::processInput(wint_t ch, bool isSpecialKey) {
+	// A paste is collected and inserted at its end, whatever it contains
+	if (pasting) {
+		if (isSpecialKey && ch == Surface::keyPasteEnd)
+			finishPaste();
+		else if (!isSpecialKey)
+			DisplayText::appendUtf8(pasteBuffer, ch);
+		return !pasting;
+	}
+
 	bool changed = false;
+	std::string typed;
 
-	if (isSpecialKey) {
-		if (ch == KEY_BACKSPACE || ch == 127 || ch == '\b') {
-			if (cursorPos > 0) {
-				inputBuffer.erase(cursorPos - 1, 1);
-				cursorPos--;
-				changed = true;
-			}
-		} else if (ch == KEY_DC) { // Delete key
-			if (cursorPos < inputBuffer.length()) {
-				inputBuffer.erase(cursorPos, 1);
-				changed = true;
-			}
-		} else if (ch == KEY_LEFT) { // Left Arrow
-			if (cursorPos > 0) {
-				cursorPos--;
-				changed = true;
-			}
-		} else if (ch == KEY_RIGHT) { // Right Arrow
-			if (cursorPos < inputBuffer.length()) {
-				cursorPos++;
-				changed = true;
-			}
-		} else if (ch == KEY_HOME) { // Home key
-			cursorPos = 0;
-			changed = true;
-		} else if (ch == KEY_END) { // End key
-			cursorPos = inputBuffer.length();
-			changed = true;
-		}
-	} else if (iswprint(ch)) {
+	if (isSpecialKey && ch == Surface::keyPasteBegin) {
+		pasting = true;
+		pasteBuffer.clear();
+	} else if ((ch == KEY_BACKSPACE && isSpecialKey) || (!isSpecialKey && (ch == 127 || ch == '\b'))) {
+		changed = buffer.eraseBefore();
+	} else if (ch == KEY_DC && isSpecialKey) { // Delete key
+		changed = buffer.eraseAfter();
+	} else if (ch == KEY_LEFT && isSpecialKey) { // Left Arrow
+		changed = buffer.moveLeft();
+	} else if (ch == KEY_RIGHT && isSpecialKey) { // Right Arrow
+		changed = buffer.moveRight();
+	} else if (ch == KEY_HOME && isSpecialKey) { // Home key: start of the line
+		size_t lineStart = buffer.before().rfind('\n');
+		buffer.moveTo(lineStart == std::string_view::npos ? 0 : lineStart + 1);
+		changed = true;
+	} else if (ch == KEY_END && isSpecialKey) { // End key: end of the line
+		buffer.moveTo(buffer.cursor() + std::min(buffer.after().find('\n'), buffer.after().size()));
+		changed = true;
+	} else if ((ch == KEY_UP || ch == KEY_DOWN) && isSpecialKey) {
+		// Between lines while composing, through the history past the first or last one
+		int direction = ch == KEY_UP ? -1 : 1;
+		changed = (composing && moveLine(direction)) || browseHistory(direction);
+	} else if (composing && (ch == '\n' || ch == '\r' || (ch == KEY_ENTER && isSpecialKey))) {
+		buffer.insert("\n");
+		changed = true;
+	} else if (!isSpecialKey && iswprint(ch)) {
 		// Insert character at cursor position
-		inputBuffer.insert(cursorPos, 1, static_cast<wchar_t>(ch));
-		cursorPos++;
+		DisplayText::appendUtf8(typed, ch);
+		buffer.insert(typed);
 		changed = true;
 	}
 
@@ -69,24 +167,115 @@ bool InputElement::processInput(wint_t ch, bool isSpecialKey) {
 	return changed;
 }
 
-std::string InputElement::getInput() const {
-	std::string result;
-	std::mbstate_t state = {};
-	char buffer[MB_LEN_MAX];
+void InputElement::finishPaste() {
+	pasting = false;
 
-	for (wchar_t wc : inputBuffer) {
-		std::size_t bytes = std::wcrtomb(buffer, wc, &state);
-		if (bytes > 0) result.append(buffer, bytes);
+	// Line breaks are kept (CR LF and CR become LF), tabs become spaces, other controls are dropped
+	std::string text;
+	text.reserve(pasteBuffer.size());
+	for (size_t i = 0; i < pasteBuffer.size(); ++i) {
+		char c = pasteBuffer[i];
+		if (c == '\r') {
+			if (i + 1 < pasteBuffer.size() && pasteBuffer[i + 1] == '\n') i++;
+			c = '\n';
+		}
+		if (c == '\t') c = ' ';
+		if ((static_cast<unsigned char>(c) < 0x20 && c != '\n') || c == 0x7F) continue;
+		text += c;
 	}
-	return result;
+	pasteBuffer.clear();
+	pasteBuffer.shrink_to_fit();
+
+	if (text.find('\n') != std::string::npos) setComposing(true);
+	buffer.insert(text);
+	needRedraw = true;
+}
+
+bool InputElement::moveLine(int direction) {
+	std::string_view before = buffer.before();
+	std::string_view after = buffer.after();
+	size_t lineStart = before.rfind('\n');
+	size_t column = DisplayText::width(before.substr(lineStart == std::string_view::npos ? 0 : lineStart + 1));
+
+	// Land on the same column of the other line, or its end if it is shorter
+	if (direction < 0) {
+		if (lineStart == std::string_view::npos) return false;
+		size_t previousStart = lineStart == 0 ? std::string_view::npos : before.rfind('\n', lineStart - 1);
+		previousStart = previousStart == std::string_view::npos ? 0 : previousStart + 1;
+		std::string_view previous = before.substr(previousStart, lineStart - previousStart);
+		buffer.moveTo(previousStart + DisplayText::fit(previous, column));
+	} else {
+		size_t lineEnd = after.find('\n');
+		if (lineEnd == std::string_view::npos) return false;
+		std::string_view next = after.substr(lineEnd + 1);
+		next = next.substr(0, next.find('\n'));
+		buffer.moveTo(buffer.cursor() + lineEnd + 1 + DisplayText::fit(next, column));
+	}
+	return true;
+}
+
+bool InputElement::browseHistory(int direction) {
+	if (direction < 0) {
+		if (historyPosition == 0) return false;
+		if (historyPosition == history.size()) draft = buffer.text();
+		historyPosition--;
+	} else {
+		if (historyPosition >= history.size()) return false;
+		historyPosition++;
+	}
+
+	const std::string& text = historyPosition == history.size() ? draft : history[historyPosition];
+	buffer.assign(text);
+	if (text.find('\n') != std::string::npos) setComposing(true);
+	return true;
+}
+
+std::string InputElement::getInput() const {
+	return buffer.text();
+}
+
+void InputElement::replaceBeforeCursor(size_t bytes, std::string_view text) {
+	buffer.replaceBefore(bytes, text);
+	needRedraw = true;
 }
 
 void InputElement::clearInput() {
-	inputBuffer.clear();
-	cursorPos = 0;
+	buffer.clear();
+	scrollColumn = topLine = 0;
 	needRedraw = true;
 }
 
+std::string InputElement::submit() {
+	std::string text = buffer.text();
+	history.add(text);
+	historyPosition = history.size();
+	draft.clear();
+	clearInput();
+	setComposing(false);
+	return text;
+}
+
+bool InputElement::openHistory(const std::string& path) {
+	bool opened = history.open(path);
+	historyPosition = history.size();
+	return opened;
+}
+
+void InputElement::setComposing(bool value) {
+	if (composing == value) return;
+	composing = value;
+	needRedraw = true;
+}
+
+int InputElement::desiredHeight() const {
+	if (!composing) return 1;
+
+	std::string_view before = buffer.before();
+	std::string_view after = buffer.after();
+	size_t lines = 1 + std::count(before.begin(), before.end(), '\n') + std::count(after.begin(), after.end(), '\n');
+	return static_cast<int>(std::min<size_t>(lines, maxComposeRows));
+}
+
 void InputElement::setInputCallback(InputCallback callback) {
 	onInputSubmitted = callback;
-}
\ No newline at end of file
+}
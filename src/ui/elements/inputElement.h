@@ -1,16 +1,18 @@
 #pragma once
 
+#include "../gapBuffer.h"
+#include "../inputHistory.h"
 #include "uiElement.h"
 #include <functional>
 #include <ncurses.h>
 #include <string>
-#include <vector>
+#include <string_view>
 
 class InputElement : public UIElement {
   public:
 	using InputCallback = std::function<void(const std::string&)>;
 
-	InputElement(int height, int width, int startY, int startX);
+	InputElement(Screen& screen, int height, int width, int startY, int startX);
 
 	void draw() override;
 	void refresh() override;
@@ -18,18 +20,55 @@ class InputElement : public UIElement {
 	// Set callback for input submission
 	void setInputCallback(InputCallback callback);
 
-	// Handle all input processing in one place
+	// Handle all input processing in one place: editing keys, typed characters and pastes
+	// (everything between Surface::keyPasteBegin and keyPasteEnd is inserted in one go)
 	bool processInput(wint_t ch, bool isSpecialKey);
 
 	std::string getInput() const;
+	std::string_view beforeCursor() const { return buffer.before(); }
+	void replaceBeforeCursor(size_t bytes, std::string_view text);
+	bool isEmpty() const { return buffer.empty(); }
 	void clearInput();
 
+	// Take the text for sending: it is added to the history and the input is cleared
+	std::string submit();
+
+	// Keep sent lines in this file across runs; false if it cannot be written
+	bool openHistory(const std::string& path);
+
+	// Compose mode: Enter starts a new line instead of sending and the element grows with the
+	// text, up to maxComposeRows. A paste with line breaks turns it on.
+	void setComposing(bool value);
+	bool isComposing() const { return composing; }
+	bool isPasting() const { return pasting; }
+
+	// Rows this element wants to be given
+	int desiredHeight() const;
+
+	static constexpr int maxComposeRows = 8;
+
   private:
-	std::wstring inputBuffer;
-	size_t cursorPos;
+	GapBuffer buffer;
+	bool composing;
+	bool pasting;
+	std::string pasteBuffer;
 	InputCallback onInputSubmitted;
 
-	// History feature
-	std::vector<std::wstring> inputHistory;
-	size_t historyPosition;
-};
\ No newline at end of file
+	// History feature: Up/Down walk through it, the text being typed is kept as a draft meanwhile
+	InputHistory history;
+	size_t historyPosition; // history.size() while not browsing
+	std::string draft;
+
+	// View: first shown line and column, and where the last draw left the cursor
+	size_t topLine;
+	size_t scrollColumn;
+	int cursorRow;
+	int cursorColumn;
+	std::string rowBuffer;
+
+	void finishPaste();
+	bool moveLine(int direction);
+	bool browseHistory(int direction);
+	void drawRow(int row, std::string_view head, std::string_view tail = std::string_view());
+	int promptColumns() const { return 2; }
+};
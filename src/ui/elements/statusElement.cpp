@@ -1,23 +1,22 @@
 #include "statusElement.h"
+#include "../../util/displayText.h"
+#include <algorithm>
 
-StatusElement::StatusElement(int height, int width, int startY, int startX)
-  : UIElement(height, width, startY, startX) {
+StatusElement::StatusElement(Screen& screen, int height, int width, int startY, int startX)
+  : UIElement(screen, height, width, startY, startX) {
 
-	win = newwin(height, width, startY, startX);
 	draw();
 }
 
 void StatusElement::draw() {
-	if (!win) return;
-
-	werase(win);
+	surface->blank();
 	// Add padding to prevent text from touching the edge
-	mvwprintw(win, 0, 1, "%.*s", width - 2, statusMessage.c_str());
+	surface->print(0, 1, std::string_view(statusMessage).substr(0, DisplayText::fit(statusMessage, std::max(0, width - 2))));
 	needRedraw = false;
 }
 
 void StatusElement::refresh() {
-	wrefresh(win);
+	surface->present();
 }
 
 void StatusElement::setStatus(const std::string& message) {
@@ -1,12 +1,11 @@
 #pragma once
 
 #include "uiElement.h"
-#include <ncurses.h>
 #include <string>
 
 class StatusElement : public UIElement {
   public:
-    StatusElement(int height, int width, int startY, int startX);
+    StatusElement(Screen& screen, int height, int width, int startY, int startX);
 
     void draw() override;
     void refresh() override;
@@ -1,14 +1,14 @@
 #include "uiElement.h"
-#include <ncurses.h>
 
-UIElement::UIElement(int height, int width, int startY, int startX)
-  : height(height)
+UIElement::UIElement(Screen& screen, int height, int width, int startY, int startX)
+  : screen(screen)
+  , surface(screen.createSurface(height, width, startY, startX))
+  , height(height)
   , width(width)
   , startY(startY)
   , startX(startX)
-  , needRedraw(true) {
-	win = newwin(height, width, startY, startX);
-}
+  , needRedraw(true)
+  , surfaceReplaced(true) {}
 
 void UIElement::setNeedRedraw(bool value) {
 	needRedraw = value;
@@ -21,12 +21,12 @@ void UIElement::resize(int newHeight, int newWidth, int newStartY, int newStartX
 	startY = newStartY;
 	startX = newStartX;
 
-	// Delete and recreate the window
-	if (win) delwin(win);
-	win = newwin(height, width, startY, startX);
-	needRedraw = true;
+	// Replace the surface, starting from a blank one
+	surface.reset();
+	surface = screen.createSurface(height, width, startY, startX);
+	needRedraw = surfaceReplaced = true;
 }
 
 bool UIElement::getNeedRedraw() const {
 	return needRedraw;
-}
\ No newline at end of file
+}
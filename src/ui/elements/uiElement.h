@@ -1,9 +1,12 @@
 #pragma once
-#include <ncurses.h>
+
+#include "../surface/surface.h"
+#include <memory>
 
 class UIElement {
   public:
-	UIElement(int height, int width, int startY, int startX);
+	UIElement(Screen& screen, int height, int width, int startY, int startX);
+	virtual ~UIElement() = default;
 
 	// Draw the UI element
 	virtual void draw() = 0;
@@ -18,13 +21,16 @@ class UIElement {
 	void setNeedRedraw(bool value);
 	bool getNeedRedraw() const;
 
-	WINDOW* getWindow() const { return win; }
+	Surface& getSurface() const { return *surface; }
+	int getHeight() const { return height; }
 
   protected:
-	WINDOW* win;
+	Screen& screen;
+	std::unique_ptr<Surface> surface;
 	int height;
 	int width;
 	int startY;
 	int startX;
 	bool needRedraw;
-};
\ No newline at end of file
+	bool surfaceReplaced; // Set on creation and resize, for elements that keep what they drew
+};
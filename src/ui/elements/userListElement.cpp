@@ -1,41 +1,114 @@
 #include "userListElement.h"
+#include "../../util/displayText.h"
+#include "../chatLayout.h"
 #include <algorithm>
 
-UserListElement::UserListElement(int height, int width, int startY, int startX)
-  : UIElement(height, width, startY, startX) {
+UserListElement::UserListElement(Screen& screen, int height, int width, int startY, int startX)
+  : UIElement(screen, height, width, startY, startX)
+  , users(nullptr)
+  , scrollOffset(0)
+  , drawnTop(0)
+  , fullDamage(true) {
 
-	win = newwin(height, width, startY, startX);
 	draw();
 	needRedraw = true;
 }
 
 void UserListElement::draw() {
-	if (!win) return; // Safety check
+	if (surfaceReplaced) {
+		surfaceReplaced = false;
+		fullDamage = true;
+	}
 
-	werase(win);
+	// Make sure this text is visible by using clear attributes
+	surface->setReverse(false);
 
-	// Draw border and title
-	box(win, 0, 0);
-	mvwprintw(win, 0, 2, " Users ");
+	if (!users || users->size() == 0) {
+		surface->blank();
+		surface->drawBox();
+		surface->print(0, 2, " Users ");
+		surface->print(1, 1, "Not in a room");
+		fullDamage = true; // The next list replaces this text
+		if (users) users->clearChanged();
+		needRedraw = false;
+		return;
+	}
 
-	// Display users or default message
-	// Make sure this text is visible by using clear attributes
-	wattrset(win, A_NORMAL);
+	size_t first = 0, last = users->size();
+	if (!filter.empty()) users->prefixRange(filter, first, last);
+	clampScroll(last - first);
 
-	if (users.empty())
-		mvwprintw(win, 1, 1, "Not in a room");
-	else
-		for (size_t i = 0; i < std::min(users.size(), static_cast<size_t>(height - 2)); ++i)
-			mvwprintw(win, i + 1, 1, "%s", users[i].c_str());
+	// Rows above the first changed member are unchanged, unless the change shifted them
+	size_t top = first + scrollOffset;
+	size_t changed = users->firstChanged();
+	int fromRow = 0;
+	if (fullDamage) {
+		surface->blank();
+		surface->drawBox();
+	} else if (!filter.empty() || changed < top || top != drawnTop) {
+		fromRow = 0; // Members moved across the filter range or into the rows shown, or the clamp scrolled
+	} else {
+		fromRow = static_cast<int>(std::min<size_t>(changed - top, height - 2));
+	}
 
+	drawTitle(first, last);
+	drawRows(fromRow, top, last);
+	drawnTop = top;
+
+	users->clearChanged();
+	fullDamage = false;
 	needRedraw = false;
 }
 
+void UserListElement::drawTitle(size_t first, size_t last) {
+	surface->horizontalLine(0, 1, width - 2);
+
+	std::string title = " Users (" + std::to_string(users->size()) + ") ";
+	if (!filter.empty())
+		title = " " + filter + "*: " + std::to_string(last - first) + " of " + std::to_string(users->size()) + " ";
+	surface->print(0, 2, std::string_view(title).substr(0, DisplayText::fit(title, std::max(0, width - 4))));
+}
+
+void UserListElement::drawRows(int fromRow, size_t top, size_t last) {
+	for (int row = fromRow; row < height - 2; ++row) {
+		// Clear the row inside the border, then print the name cut at the panel width
+		surface->clearCells(row + 1, 1, width - 2);
+		if (top + row >= last) continue;
+
+		ChatLayout::wrap((*users)[top + row], width - 2, rowBuffer);
+		surface->print(row + 1, 1, rowBuffer[0]);
+	}
+}
+
+void UserListElement::clampScroll(size_t count) {
+	size_t visible = std::max(1, height - 2);
+	scrollOffset = count > visible ? std::min(scrollOffset, count - visible) : 0;
+}
+
 void UserListElement::refresh() {
-	if (win) wrefresh(win);
+	surface->present();
 }
 
-void UserListElement::updateUsers(const std::vector<std::string>& newUsers) {
-	users = newUsers;
+void UserListElement::setUsers(UserList* list) {
+	users = list;
+	scrollOffset = 0;
+	fullDamage = needRedraw = true;
+}
+
+void UserListElement::onUsersChanged() {
 	needRedraw = true;
-}
\ No newline at end of file
+}
+
+void UserListElement::setFilter(const std::string& prefix) {
+	filter = prefix;
+	scrollOffset = 0;
+	fullDamage = needRedraw = true;
+}
+
+void UserListElement::scrollBy(int rows) {
+	if (rows < 0)
+		scrollOffset -= std::min<size_t>(scrollOffset, -rows);
+	else
+		scrollOffset += rows; // Clamped when drawn
+	fullDamage = needRedraw = true;
+}
@@ -1,19 +1,40 @@
 #pragma once
 
+#include "../userList.h"
 #include "uiElement.h"
-#include <ncurses.h>
 #include <string>
+#include <string_view>
 #include <vector>
 
 class UserListElement : public UIElement {
   public:
-    UserListElement(int height, int width, int startY, int startX);
+	UserListElement(Screen& screen, int height, int width, int startY, int startX);
+
+	void draw() override;
+	void refresh() override;
+
+	// Show a room's members (nullptr when not in a room); the list must outlive its display
+	void setUsers(UserList* list);
+
+	// The shown list changed; rows from its first changed position on are redrawn
+	void onUsersChanged();
+
+	// Only list members whose name starts with prefix (empty shows everyone)
+	void setFilter(const std::string& prefix);
+
+	// Scroll by rows, negative is up
+	void scrollBy(int rows);
 
-    void draw() override;
-    void refresh() override;
-    
-    void updateUsers(const std::vector<std::string>& newUsers);
-    
   private:
-    std::vector<std::string> users;
-};
\ No newline at end of file
+	UserList* users;
+	std::string filter;
+	size_t scrollOffset; // Within the filtered range
+	size_t drawnTop;     // Member shown in the first row when last drawn
+
+	bool fullDamage;
+	std::vector<std::string_view> rowBuffer;
+
+	void clampScroll(size_t count);
+	void drawTitle(size_t first, size_t last);
+	void drawRows(int fromRow, size_t first, size_t last);
+};
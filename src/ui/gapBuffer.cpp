@@ -0,0 +1,109 @@
+#include "gapBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+bool isContinuation(char byte) {
+	return (static_cast<unsigned char>(byte) & 0xC0) == 0x80;
+}
+
+} // namespace
+
+std::string GapBuffer::text() const {
+	std::string result;
+	result.reserve(size());
+	result.append(before());
+	result.append(after());
+	return result;
+}
+
+void GapBuffer::reserveGap(size_t bytes) {
+	if (gapEnd - gapStart >= bytes) return;
+
+	// Grow geometrically so a run of inserts stays linear overall
+	size_t tail = storage.size() - gapEnd;
+	size_t capacity = std::max({ size() + bytes, storage.size() * 2, static_cast<size_t>(64) });
+	std::vector<char> grown(capacity);
+	std::copy_n(storage.begin(), gapStart, grown.begin());
+	std::copy_n(storage.begin() + gapEnd, tail, grown.end() - tail);
+	storage.swap(grown);
+	gapEnd = capacity - tail;
+}
+
+void GapBuffer::insert(std::string_view text) {
+	reserveGap(text.size());
+	std::copy(text.begin(), text.end(), storage.begin() + gapStart);
+	gapStart += text.size();
+}
+
+void GapBuffer::replaceBefore(size_t bytes, std::string_view text) {
+	gapStart -= std::min(bytes, gapStart);
+	insert(text);
+}
+
+size_t GapBuffer::previousCharacter() const {
+	size_t position = gapStart;
+	while (position > 0 && isContinuation(storage[--position])) {}
+	return position;
+}
+
+size_t GapBuffer::nextCharacter() const {
+	size_t position = gapEnd;
+	if (position < storage.size()) position++;
+	while (position < storage.size() && isContinuation(storage[position]))
+		position++;
+	return position;
+}
+
+bool GapBuffer::eraseBefore() {
+	if (gapStart == 0) return false;
+	gapStart = previousCharacter();
+	return true;
+}
+
+bool GapBuffer::eraseAfter() {
+	if (gapEnd == storage.size()) return false;
+	gapEnd = nextCharacter();
+	return true;
+}
+
+bool GapBuffer::moveLeft() {
+	if (gapStart == 0) return false;
+	moveTo(previousCharacter());
+	return true;
+}
+
+bool GapBuffer::moveRight() {
+	if (gapEnd == storage.size()) return false;
+	moveTo(gapStart + nextCharacter() - gapEnd);
+	return true;
+}
+
+void GapBuffer::moveTo(size_t position) {
+	position = std::min(position, size());
+	if (position < gapStart) {
+		// Bytes before the new cursor position move to the end of the gap
+		size_t count = gapStart - position;
+		std::memmove(storage.data() + gapEnd - count, storage.data() + position, count);
+		gapStart -= count;
+		gapEnd -= count;
+	} else if (position > gapStart) {
+		size_t count = position - gapStart;
+		std::memmove(storage.data() + gapStart, storage.data() + gapEnd, count);
+		gapStart += count;
+		gapEnd += count;
+	}
+}
+
+void GapBuffer::assign(std::string_view text) {
+	clear();
+	insert(text);
+}
+
+void GapBuffer::clear() {
+	// Storage grown by a large paste is given back
+	if (storage.size() > 64 * 1024) std::vector<char>().swap(storage);
+	gapStart = 0;
+	gapEnd = storage.size();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// UTF-8 text being edited, stored with a gap at the cursor: typing and deleting there cost
+// O(1) amortized however long the text, and a paste is one copy. Moving the cursor moves the
+// bytes between the old and new position across the gap.
+class GapBuffer {
+  public:
+	size_t size() const { return storage.size() - (gapEnd - gapStart); }
+	bool empty() const { return size() == 0; }
+
+	// Byte offset of the cursor, always on a character boundary
+	size_t cursor() const { return gapStart; }
+
+	// Text before and after the cursor
+	std::string_view before() const { return std::string_view(storage.data(), gapStart); }
+	std::string_view after() const { return std::string_view(storage.data() + gapEnd, storage.size() - gapEnd); }
+	std::string text() const;
+
+	// Insert at the cursor, leaving the cursor after the text
+	void insert(std::string_view text);
+
+	// Replace the bytes bytes before the cursor with text, leaving the cursor after it
+	void replaceBefore(size_t bytes, std::string_view text);
+
+	// Remove the character before / after the cursor; false if there is none
+	bool eraseBefore();
+	bool eraseAfter();
+
+	// Move by one character; false at either end
+	bool moveLeft();
+	bool moveRight();
+
+	// Move to a byte offset (clamped to the text)
+	void moveTo(size_t position);
+
+	// Replace the whole text, cursor at the end
+	void assign(std::string_view text);
+	void clear();
+
+  private:
+	std::vector<char> storage;
+	size_t gapStart = 0;
+	size_t gapEnd = 0;
+
+	void reserveGap(size_t bytes);
+	size_t previousCharacter() const;
+	size_t nextCharacter() const;
+};
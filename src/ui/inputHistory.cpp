@@ -0,0 +1,98 @@
+#include "inputHistory.h"
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+InputHistory::InputHistory(size_t limit)
+  : limit(limit)
+  , fd(-1) {}
+
+InputHistory::~InputHistory() {
+	if (fd >= 0) close(fd);
+}
+
+bool InputHistory::open(const std::string& path) {
+	if (fd >= 0) close(fd);
+	fd = -1;
+
+	size_t fileEntries = 0;
+	std::ifstream in(path);
+	std::string line;
+	while (std::getline(in, line)) {
+		entries.push_back(unescape(line));
+		if (entries.size() > limit) entries.pop_front();
+		fileEntries++;
+	}
+	in.close();
+
+	if (fileEntries > 2 * limit && !rewrite(path)) return false;
+
+	// Only the user can read what they typed
+	fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+	return fd >= 0;
+}
+
+bool InputHistory::rewrite(const std::string& path) {
+	std::string temporary = path + ".tmp";
+	fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+	if (fd < 0) return false;
+	// A leftover temporary file keeps its mode, and the rewrite replaces the history with it
+	if (fchmod(fd, 0600) < 0) {
+		close(fd);
+		fd = -1;
+		return false;
+	}
+	for (const std::string& entry : entries)
+		write(entry);
+	close(fd);
+	fd = -1;
+	return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+void InputHistory::add(std::string_view entry) {
+	if (entry.empty() || (!entries.empty() && entries.back() == entry)) return;
+
+	entries.emplace_back(entry);
+	if (entries.size() > limit) entries.pop_front();
+	if (fd >= 0) write(entry);
+}
+
+void InputHistory::write(std::string_view entry) {
+	// One write per entry, so lines from two clients sharing the file never interleave
+	std::string line = escape(entry);
+	line += '\n';
+	if (::write(fd, line.data(), line.size()) != static_cast<ssize_t>(line.size())) {
+		close(fd);
+		fd = -1; // Disk full or file gone: keep going in memory
+	}
+}
+
+std::string InputHistory::escape(std::string_view entry) {
+	std::string result;
+	result.reserve(entry.size());
+	for (char c : entry) {
+		if (c == '\\')
+			result += "\\\\";
+		else if (c == '\n')
+			result += "\\n";
+		else
+			result += c;
+	}
+	return result;
+}
+
+std::string InputHistory::unescape(std::string_view line) {
+	std::string result;
+	result.reserve(line.size());
+	for (size_t i = 0; i < line.size(); ++i) {
+		if (line[i] == '\\' && i + 1 < line.size()) {
+			result += line[i + 1] == 'n' ? '\n' : line[i + 1];
+			i++;
+		} else {
+			result += line[i];
+		}
+	}
+	return result;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+
+// Lines sent from the input line, oldest first, optionally kept in a file across runs.
+// The file holds one entry per line (newlines and backslashes escaped) and is only appended
+// to; it is rewritten with the kept entries when it has grown to twice the limit.
+class InputHistory {
+  public:
+	explicit InputHistory(size_t limit = 1000);
+	~InputHistory();
+
+	InputHistory(const InputHistory&) = delete;
+	InputHistory& operator=(const InputHistory&) = delete;
+
+	// Load entries from path and append new ones to it; false if it cannot be written, in which
+	// case the history is kept in memory only
+	bool open(const std::string& path);
+
+	// Add an entry unless it is empty or repeats the newest one
+	void add(std::string_view entry);
+
+	size_t size() const { return entries.size(); }
+	const std::string& operator[](size_t index) const { return entries[index]; }
+
+  private:
+	size_t limit;
+	std::deque<std::string> entries;
+	int fd;
+
+	bool rewrite(const std::string& path);
+	void write(std::string_view entry);
+
+	static std::string escape(std::string_view entry);
+	static std::string unescape(std::string_view line);
+};
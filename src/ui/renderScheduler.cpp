@@ -0,0 +1,35 @@
+#include "renderScheduler.h"
+#include "../metrics/metrics.h"
+
+RenderScheduler::RenderScheduler(unsigned framesPerSecond)
+  : intervalNs(framesPerSecond > 0 ? 1000000000ull / framesPerSecond : 0)
+  , nextFrameNs(0) {}
+
+int RenderScheduler::pollTimeout(bool damaged) const {
+	if (!damaged) return -1;
+
+	uint64_t now = Metrics::nowNs();
+	if (now >= nextFrameNs) return 0;
+	return static_cast<int>((nextFrameNs - now + 999999) / 1000000); // Round up, never wake early
+}
+
+bool RenderScheduler::frameDue() const {
+	return Metrics::nowNs() >= nextFrameNs;
+}
+
+void RenderScheduler::frameDrawn(uint64_t startNs, uint64_t endNs) {
+	Metrics& metrics = Metrics::get();
+	uint64_t took = endNs - startNs;
+	metrics.frameNs.record(took);
+	metrics.frames.fetch_add(1, std::memory_order_relaxed);
+
+	// A frame longer than the budget takes the slots of the frames that could not be drawn meanwhile
+	if (intervalNs > 0 && took > intervalNs)
+		metrics.framesSkipped.fetch_add(took / intervalNs, std::memory_order_relaxed);
+
+	nextFrameNs = startNs + intervalNs;
+}
+
+void RenderScheduler::deferred() {
+	Metrics::get().updatesCoalesced.fetch_add(1, std::memory_order_relaxed);
+}
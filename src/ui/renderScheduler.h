@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+// Paces screen updates to a target frame rate. Damage reported between two frames is drawn
+// together by the next one, so a burst of network events costs at most one screen update per
+// frame interval however many events it carries.
+class RenderScheduler {
+  public:
+	// 0 draws as soon as anything changes
+	explicit RenderScheduler(unsigned framesPerSecond);
+
+	// How long poll() may sleep: -1 with nothing to draw, otherwise until the next frame is due
+	int pollTimeout(bool damaged) const;
+
+	bool frameDue() const;
+
+	// A frame was drawn between startNs and endNs (Metrics::nowNs())
+	void frameDrawn(uint64_t startNs, uint64_t endNs);
+
+	// Damage was left for a later frame
+	void deferred();
+
+  private:
+	uint64_t intervalNs;
+	uint64_t nextFrameNs;
+};
@@ -0,0 +1,221 @@
+#include "searchIndex.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+
+// Words are runs of ASCII letters and digits, with any non-ASCII (UTF-8) bytes kept inside them
+bool isWordByte(unsigned char c) {
+	return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+}
+
+void addLine(std::vector<uint32_t>& lines, uint32_t line) {
+	// A word repeated within a line is listed once
+	if (lines.empty() || lines.back() != line) lines.push_back(line);
+}
+
+bool twoDigits(const char* in, int& out) {
+	if (!std::isdigit(static_cast<unsigned char>(in[0])) || !std::isdigit(static_cast<unsigned char>(in[1])))
+		return false;
+	out = (in[0] - '0') * 10 + (in[1] - '0');
+	return true;
+}
+
+bool parseTime(std::string_view value, time_t& out) {
+	std::string text(value);
+	char* end;
+	long number = std::strtol(text.c_str(), &end, 10);
+	if (end == text.c_str() || number < 0) return false;
+
+	// Relative: 30m, 2h, 1d ago; the unit is checked first so a bare number never reads past the end
+	if ((*end == 'm' || *end == 'h' || *end == 'd') && end[1] == '\0') {
+		long unit = *end == 'm' ? 60 : *end == 'h' ? 3600 : 86400;
+		out = std::time(nullptr) - number * unit;
+		return true;
+	}
+
+	// Absolute: HH:MM[:SS] today, minutes and seconds as two digits each
+	if (*end != ':' || number > 23) return false;
+	time_t now = std::time(nullptr);
+	std::tm tm;
+	localtime_r(&now, &tm);
+	tm.tm_hour = static_cast<int>(number);
+	tm.tm_sec = 0;
+	if (!twoDigits(end + 1, tm.tm_min) || tm.tm_min > 59) return false;
+	end += 3;
+	if (*end == ':' && (!twoDigits(end + 1, tm.tm_sec) || tm.tm_sec > 59)) return false;
+	if (*end == ':') end += 3;
+	if (*end != '\0') return false;
+	out = std::mktime(&tm);
+	return true;
+}
+
+} // namespace
+
+bool SearchIndex::Query::parse(std::string_view text, Query& query, std::string& error) {
+	query = Query();
+
+	size_t pos = 0;
+	while (pos < text.size()) {
+		size_t start = text.find_first_not_of(' ', pos);
+		if (start == std::string_view::npos) break;
+		size_t end = text.find(' ', start);
+		if (end == std::string_view::npos) end = text.size();
+		std::string_view word = text.substr(start, end - start);
+		pos = end;
+
+		if (word.compare(0, 5, "from:") == 0) {
+			query.user = std::string(word.substr(5));
+			lowercase(query.user);
+		} else if (word.compare(0, 6, "after:") == 0) {
+			if (!parseTime(word.substr(6), query.after)) {
+				error = "Bad time: " + std::string(word);
+				return false;
+			}
+		} else if (word.compare(0, 7, "before:") == 0) {
+			if (!parseTime(word.substr(7), query.before)) {
+				error = "Bad time: " + std::string(word);
+				return false;
+			}
+		} else {
+			// Split the same way lines are, so "don't" looks for "don" and "t"
+			std::string term;
+			for (unsigned char c : word) {
+				if (isWordByte(c)) {
+					term += static_cast<char>(c);
+				} else if (!term.empty()) {
+					query.terms.push_back(std::move(term));
+					term.clear();
+				}
+			}
+			if (!term.empty()) query.terms.push_back(std::move(term));
+		}
+	}
+
+	for (std::string& term : query.terms)
+		lowercase(term);
+
+	if (query.terms.empty() && query.user.empty()) {
+		error = "Usage: /search [from:user] [after:HH:MM|30m] [before:HH:MM|1h] words...";
+		return false;
+	}
+	return true;
+}
+
+void SearchIndex::lowercase(std::string& text) {
+	for (char& c : text)
+		if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+}
+
+void SearchIndex::add(time_t time, std::string_view user, std::string_view text) {
+	// Relative to base; compaction keeps this below twice the lines retained, far from wrapping
+	uint32_t line = static_cast<uint32_t>(times.size());
+	times.push_back(time);
+
+	if (!user.empty()) {
+		token.assign(user);
+		lowercase(token);
+		uint32_t id = users.intern(token);
+		if (id == userLines.size()) userLines.emplace_back();
+		addLine(userLines[id], line);
+	}
+
+	// One pass over the text; only new words allocate
+	for (size_t i = 0; i < text.size();) {
+		if (!isWordByte(text[i])) {
+			++i;
+			continue;
+		}
+		size_t start = i;
+		while (i < text.size() && isWordByte(text[i]))
+			++i;
+
+		token.assign(text.data() + start, i - start);
+		lowercase(token);
+		uint32_t id = words.intern(token);
+		if (id == postings.size()) postings.emplace_back();
+		addLine(postings[id], line);
+	}
+}
+
+void SearchIndex::dropBefore(uint64_t line) {
+	dropped = std::max(dropped, std::min(line, base + times.size()));
+
+	// Amortized: each line is moved by at most one compaction
+	if (dropped - base > times.size() / 2) compact();
+}
+
+void SearchIndex::compact() {
+	uint32_t shift = static_cast<uint32_t>(dropped - base);
+	times.erase(times.begin(), times.begin() + shift);
+	times.shrink_to_fit();
+	compact(words, postings, shift);
+	compact(users, userLines, shift);
+	base = dropped;
+}
+
+void SearchIndex::compact(StringInterner& interner, std::vector<std::vector<uint32_t>>& index, uint32_t shift) {
+	// Rebuild the interner with only the keys that still have lines, so vocabulary is bounded too
+	StringInterner kept;
+	std::vector<std::vector<uint32_t>> keptIndex;
+	for (uint32_t id = 0; id < index.size(); ++id) {
+		std::vector<uint32_t>& lines = index[id];
+		lines.erase(lines.begin(), std::lower_bound(lines.begin(), lines.end(), shift));
+		if (lines.empty()) continue;
+		for (uint32_t& line : lines)
+			line -= shift;
+		lines.shrink_to_fit();
+		kept.intern(interner.lookup(id));
+		keptIndex.push_back(std::move(lines));
+	}
+	interner = std::move(kept);
+	index = std::move(keptIndex);
+}
+
+std::vector<uint64_t> SearchIndex::search(const Query& query, size_t limit) const {
+	std::vector<uint64_t> results;
+
+	// Every criterion as a sorted list of lines; a missing word or user matches nothing
+	std::vector<const std::vector<uint32_t>*> lists;
+	auto find = [&lists](const StringInterner& interner, const std::vector<std::vector<uint32_t>>& index,
+						 const std::string& key) {
+		uint32_t id;
+		if (!interner.find(key, id)) return false;
+		lists.push_back(&index[id]);
+		return true;
+	};
+	for (const std::string& term : query.terms)
+		if (!find(words, postings, term)) return results;
+	if (!query.user.empty() && !find(users, userLines, query.user)) return results;
+	if (lists.empty()) return results;
+
+	// Times are ascending, so the time range is a range of lines
+	uint32_t first = static_cast<uint32_t>(std::lower_bound(times.begin(), times.end(), query.after) - times.begin());
+	first = std::max(first, static_cast<uint32_t>(dropped - base));
+	uint32_t last = static_cast<uint32_t>(
+	  query.before == 0 ? times.size() : std::upper_bound(times.begin(), times.end(), query.before) - times.begin());
+
+	// Walk the shortest list from the newest line, probing the others
+	std::sort(lists.begin(), lists.end(), [](auto* a, auto* b) { return a->size() < b->size(); });
+	const std::vector<uint32_t>& shortest = *lists.front();
+	auto begin = std::lower_bound(shortest.begin(), shortest.end(), first);
+	auto it = std::lower_bound(begin, shortest.end(), last);
+	while (it != begin && results.size() < limit) {
+		uint32_t line = *--it;
+		bool all = true;
+		for (size_t i = 1; i < lists.size() && all; ++i)
+			all = std::binary_search(lists[i]->begin(), lists[i]->end(), line);
+		if (all) results.push_back(base + line);
+	}
+	return results;
+}
+
+size_t SearchIndex::memoryUsed() const {
+	size_t bytes = times.capacity() * sizeof(time_t) + words.bytesReserved() + users.bytesReserved();
+	for (const auto& lines : postings)
+		bytes += lines.capacity() * sizeof(uint32_t);
+	for (const auto& lines : userLines)
+		bytes += lines.capacity() * sizeof(uint32_t);
+	return bytes;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../util/stringInterner.h"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Inverted index over a sequence of chat lines, numbered 0, 1, 2... in the order they are added.
+// Each word maps to the ascending list of lines containing it, so a query only touches the
+// lines of its rarest criterion and checks the others by binary search.
+// The oldest lines can be forgotten with dropBefore(); the postings store line numbers relative
+// to the oldest line still held, and are compacted once the dropped lines outnumber the rest.
+class SearchIndex {
+  public:
+	struct Query {
+		std::vector<std::string> terms; // Lowercased words, all must match
+		std::string user;               // Lowercased author, empty for any
+		time_t after = 0;
+		time_t before = 0; // 0 for no upper bound
+
+		// "[from:user] [after:T] [before:T] words...", T is HH:MM[:SS] today or Nm/Nh/Nd ago
+		static bool parse(std::string_view text, Query& query, std::string& error);
+	};
+
+	// Lines must be added in order, each exactly once; user is empty for system lines
+	void add(time_t time, std::string_view user, std::string_view text);
+
+	// Lines held, including dropped ones not yet compacted away
+	size_t size() const { return times.size(); }
+
+	// Forget every line numbered below line; they no longer match any query
+	void dropBefore(uint64_t line);
+
+	// Matching lines, newest first, at most limit
+	std::vector<uint64_t> search(const Query& query, size_t limit) const;
+
+	size_t memoryUsed() const;
+
+  private:
+	StringInterner words;
+	std::vector<std::vector<uint32_t>> postings; // By word id
+	StringInterner users;
+	std::vector<std::vector<uint32_t>> userLines; // By user id
+	std::vector<time_t> times;                    // By line, ascending
+	std::string token;                            // Reused while tokenizing
+	uint64_t base = 0;                            // Number of times[0]
+	uint64_t dropped = 0;                         // Lines below this no longer match
+
+	void compact();
+	static void compact(StringInterner& interner, std::vector<std::vector<uint32_t>>& index, uint32_t shift);
+	static void lowercase(std::string& text);
+};
@@ -0,0 +1,174 @@
+#include "memorySurface.h"
+#include "../../util/displayText.h"
+#include <algorithm>
+#include <ncurses.h>
+
+MemoryScreen::MemoryScreen(int height, int width)
+  : rows(std::max(1, height))
+  , columns(std::max(1, width))
+  , staged(rows * columns)
+  , shown(rows * columns) {}
+
+void MemoryScreen::size(int& height, int& width) const {
+	height = rows;
+	width = columns;
+}
+
+std::unique_ptr<Surface> MemoryScreen::createSurface(int height, int width, int startY, int startX) {
+	return std::make_unique<MemorySurface>(*this, height, width, startY, startX);
+}
+
+void MemoryScreen::update() {
+	for (size_t i = 0; i < staged.size(); ++i)
+		if (repaintAll || staged[i] != shown[i]) {
+			shown[i] = staged[i];
+			changedCells++;
+		}
+	shownCursorY = stagedCursorY;
+	shownCursorX = stagedCursorX;
+	repaintAll = false;
+	updateCount++;
+}
+
+void MemoryScreen::repaint() {
+	std::fill(staged.begin(), staged.end(), Cell{});
+	repaintAll = true;
+}
+
+void MemoryScreen::resize(int height, int width) {
+	rows = std::max(1, height);
+	columns = std::max(1, width);
+	staged.assign(rows * columns, Cell{});
+	shown.assign(rows * columns, Cell{});
+	repaintAll = true;
+	pushKey(KEY_RESIZE, true);
+}
+
+void MemoryScreen::pushKey(wint_t key, bool isKeyCode) {
+	keys.emplace_back(key, isKeyCode);
+}
+
+std::vector<std::string> MemoryScreen::dump() const {
+	std::vector<std::string> lines(rows);
+	for (int y = 0; y < rows; ++y) {
+		for (int x = 0; x < columns; ++x)
+			if (shown[y * columns + x].ch != 0) DisplayText::appendUtf8(lines[y], shown[y * columns + x].ch);
+		lines[y].erase(lines[y].find_last_not_of(' ') + 1);
+	}
+	return lines;
+}
+
+bool MemoryScreen::isReverse(int y, int x) const {
+	if (y < 0 || y >= rows || x < 0 || x >= columns) return false;
+	return shown[y * columns + x].reverse;
+}
+
+MemorySurface::MemorySurface(MemoryScreen& screen, int height, int width, int startY, int startX)
+  : screen(screen)
+  , rows(std::max(1, height))
+  , columns(std::max(1, width))
+  , startY(startY)
+  , startX(startX)
+  , cells(rows * columns)
+  , scrollTop(0)
+  , scrollBottom(rows - 1) {}
+
+void MemorySurface::put(int y, int x, char32_t ch) {
+	if (y < 0 || y >= rows || x < 0 || x >= columns) return;
+	cells[y * columns + x] = { ch, reverse };
+}
+
+void MemorySurface::fill(int y, int x, int length, char32_t ch) {
+	for (int i = 0; i < length; ++i)
+		put(y, x + i, ch);
+}
+
+void MemorySurface::blank() {
+	std::fill(cells.begin(), cells.end(), Cell{});
+}
+
+void MemorySurface::drawBox() {
+	fill(0, 1, columns - 2, U'─');
+	fill(rows - 1, 1, columns - 2, U'─');
+	for (int y = 1; y < rows - 1; ++y) {
+		put(y, 0, U'│');
+		put(y, columns - 1, U'│');
+	}
+	put(0, 0, U'┌');
+	put(0, columns - 1, U'┐');
+	put(rows - 1, 0, U'└');
+	put(rows - 1, columns - 1, U'┘');
+}
+
+void MemorySurface::horizontalLine(int y, int x, int length) {
+	fill(y, x, length, U'─');
+}
+
+void MemorySurface::verticalLine(int y, int x, int length) {
+	for (int i = 0; i < length; ++i)
+		put(y + i, x, U'│');
+}
+
+void MemorySurface::clearCells(int y, int x, int length) {
+	fill(y, x, length, U' ');
+}
+
+void MemorySurface::print(int y, int x, std::string_view text) {
+	if (y < 0 || y >= rows) return;
+
+	size_t i = 0;
+	while (i < text.size() && x < columns) {
+		char32_t ch;
+		i += DisplayText::decode(text, i, ch);
+		int cellWidth = DisplayText::charWidth(ch);
+
+		// Combining characters are not kept
+		if (cellWidth == 0) continue;
+		if (x + cellWidth > columns) break;
+		put(y, x, ch);
+		if (cellWidth == 2) put(y, x + 1, 0);
+		x += cellWidth;
+	}
+}
+
+void MemorySurface::setScrollRegion(int top, int bottom) {
+	scrollTop = std::max(0, top);
+	scrollBottom = std::min(rows - 1, bottom);
+}
+
+void MemorySurface::scrollUp(int lines) {
+	int regionRows = scrollBottom - scrollTop + 1;
+	if (lines <= 0 || regionRows <= 0) return;
+	lines = std::min(lines, regionRows);
+
+	auto row = [this](int y) { return cells.begin() + y * columns; };
+	std::copy(row(scrollTop + lines), row(scrollBottom + 1), row(scrollTop));
+	std::fill(row(scrollBottom + 1 - lines), row(scrollBottom + 1), Cell{});
+}
+
+void MemorySurface::moveCursor(int y, int x) {
+	cursorY = std::clamp(y, 0, rows - 1);
+	cursorX = std::clamp(x, 0, columns - 1);
+}
+
+void MemorySurface::stage() {
+	// Clipped to the screen, which may have shrunk since this surface was created
+	for (int y = 0; y < rows && startY + y < screen.rows; ++y)
+		for (int x = 0; x < columns && startX + x < screen.columns; ++x)
+			screen.staged[(startY + y) * screen.columns + startX + x] = cells[y * columns + x];
+	screen.stagedCursorY = startY + cursorY;
+	screen.stagedCursorX = startX + cursorX;
+}
+
+void MemorySurface::present() {
+	stage();
+	screen.update();
+}
+
+bool MemorySurface::readKey(wint_t& key, bool& isKeyCode) {
+	if (screen.keys.empty()) return false;
+	key = screen.keys.front().first;
+	isKeyCode = screen.keys.front().second;
+	screen.keys.pop_front();
+	return true;
+}
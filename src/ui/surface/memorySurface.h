@@ -0,0 +1,104 @@
+#pragma once
+
+#include "surface.h"
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+class MemorySurface;
+
+// A screen with no terminal behind it: surfaces draw into cell grids, updates copy them into
+// the screen grid. Runs the UI headless, to time drawing or compare screens with expected text.
+// Widths come from the current locale, like ncurses'; zero-width characters are dropped.
+class MemoryScreen : public Screen {
+  public:
+	MemoryScreen(int height, int width);
+
+	void init() override {}
+	void cleanup() override {}
+	void size(int& height, int& width) const override;
+	std::unique_ptr<Surface> createSurface(int height, int width, int startY, int startX) override;
+	void update() override;
+	void repaint() override;
+
+	// Change the size as a terminal resize would; readKey() then reports KEY_RESIZE
+	void resize(int height, int width);
+
+	// Queue a key for readKey() on any surface
+	void pushKey(wint_t key, bool isKeyCode = false);
+
+	// The screen as of the last update, a UTF-8 string per row without trailing blanks
+	std::vector<std::string> dump() const;
+	bool isReverse(int y, int x) const;
+	int cursorY() const { return shownCursorY; }
+	int cursorX() const { return shownCursorX; }
+
+	// Cost counters since construction: updates, and cells a terminal would have had to rewrite
+	uint64_t updates() const { return updateCount; }
+	uint64_t cellsChanged() const { return changedCells; }
+
+  private:
+	friend class MemorySurface;
+
+	// ch 0 marks the right half of a wide character
+	struct Cell {
+		char32_t ch = U' ';
+		bool reverse = false;
+
+		bool operator==(const Cell& other) const { return ch == other.ch && reverse == other.reverse; }
+		bool operator!=(const Cell& other) const { return !(*this == other); }
+	};
+
+	int rows;
+	int columns;
+	std::vector<Cell> staged; // What the next update shows
+	std::vector<Cell> shown;
+	int stagedCursorY = 0, stagedCursorX = 0;
+	int shownCursorY = 0, shownCursorX = 0;
+	bool repaintAll = true;
+	std::deque<std::pair<wint_t, bool>> keys;
+
+	uint64_t updateCount = 0;
+	uint64_t changedCells = 0;
+};
+
+// One rectangle of a MemoryScreen
+class MemorySurface : public Surface {
+  public:
+	MemorySurface(MemoryScreen& screen, int height, int width, int startY, int startX);
+
+	int height() const override { return rows; }
+	int width() const override { return columns; }
+
+	void blank() override;
+	void drawBox() override;
+	void horizontalLine(int y, int x, int length) override;
+	void verticalLine(int y, int x, int length) override;
+	void clearCells(int y, int x, int length) override;
+	void print(int y, int x, std::string_view text) override;
+	void setReverse(bool on) override { reverse = on; }
+	void setScrollRegion(int top, int bottom) override;
+	void scrollUp(int lines) override;
+	void moveCursor(int y, int x) override;
+	void stage() override;
+	void present() override;
+	bool readKey(wint_t& key, bool& isKeyCode) override;
+
+  private:
+	using Cell = MemoryScreen::Cell;
+
+	MemoryScreen& screen;
+	int rows;
+	int columns;
+	int startY;
+	int startX;
+	std::vector<Cell> cells;
+	bool reverse = false;
+	int scrollTop, scrollBottom;
+	int cursorY = 0, cursorX = 0;
+
+	void put(int y, int x, char32_t ch);
+	void fill(int y, int x, int length, char32_t ch);
+};
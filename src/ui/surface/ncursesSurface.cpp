@@ -0,0 +1,126 @@
+#include "ncursesSurface.h"
+#include "../../util/displayText.h"
+#include <cstdio>
+
+NcursesSurface::NcursesSurface(int height, int width, int startY, int startX)
+  : win(newwin(height, width, startY, startX))
+  , rows(height)
+  , columns(width) {
+
+	if (!win) return;
+	keypad(win, TRUE);
+	nodelay(win, TRUE); // UI::run polls stdin, reads never block
+}
+
+NcursesSurface::~NcursesSurface() {
+	if (win) delwin(win);
+}
+
+void NcursesSurface::blank() {
+	if (win) werase(win);
+}
+
+void NcursesSurface::drawBox() {
+	if (win) box(win, 0, 0);
+}
+
+void NcursesSurface::horizontalLine(int y, int x, int length) {
+	if (win && length > 0) mvwhline(win, y, x, ACS_HLINE, length);
+}
+
+void NcursesSurface::verticalLine(int y, int x, int length) {
+	if (win && length > 0) mvwvline(win, y, x, ACS_VLINE, length);
+}
+
+void NcursesSurface::clearCells(int y, int x, int length) {
+	if (win && length > 0) mvwhline(win, y, x, ' ', length);
+}
+
+void NcursesSurface::print(int y, int x, std::string_view text) {
+	if (!win || x >= columns) return;
+	// Anything past the edge would wrap onto the next row
+	mvwaddnstr(win, y, x, text.data(), DisplayText::fit(text, columns - x));
+}
+
+void NcursesSurface::setReverse(bool on) {
+	if (!win) return;
+	if (on)
+		wattron(win, A_REVERSE);
+	else
+		wattroff(win, A_REVERSE);
+}
+
+void NcursesSurface::setScrollRegion(int top, int bottom) {
+	if (!win) return;
+	wsetscrreg(win, top, bottom);
+	idlok(win, TRUE); // Let the terminal scroll instead of repainting every row
+}
+
+void NcursesSurface::scrollUp(int lines) {
+	if (!win) return;
+	scrollok(win, TRUE);
+	wscrl(win, lines);
+	scrollok(win, FALSE); // Never scroll implicitly when writing the last row
+}
+
+void NcursesSurface::moveCursor(int y, int x) {
+	if (win) wmove(win, y, x);
+}
+
+void NcursesSurface::stage() {
+	if (win) wnoutrefresh(win);
+}
+
+void NcursesSurface::present() {
+	if (win) wrefresh(win);
+}
+
+bool NcursesSurface::readKey(wint_t& key, bool& isKeyCode) {
+	if (!win) return false;
+	int result = wget_wch(win, &key);
+	isKeyCode = result == KEY_CODE_YES;
+	return result != ERR;
+}
+
+void NcursesScreen::init() {
+	initscr();
+	cbreak();
+	noecho();
+	keypad(stdscr, TRUE);
+	start_color();
+	use_default_colors();
+	curs_set(1);           // Show cursor
+	nodelay(stdscr, TRUE); // Input is driven by poll() in UI::run
+
+	// Bracketed paste: the terminal wraps pasted text in these, so it is not taken for typing
+	define_key("\033[200~", Surface::keyPasteBegin);
+	define_key("\033[201~", Surface::keyPasteEnd);
+	std::fputs("\033[?2004h", stdout);
+	std::fflush(stdout);
+	initialized = true;
+}
+
+void NcursesScreen::cleanup() {
+	if (!initialized) return;
+	endwin();
+	std::fputs("\033[?2004l", stdout);
+	std::fflush(stdout);
+	initialized = false;
+}
+
+void NcursesScreen::size(int& height, int& width) const {
+	getmaxyx(stdscr, height, width);
+}
+
+std::unique_ptr<Surface> NcursesScreen::createSurface(int height, int width, int startY, int startX) {
+	return std::make_unique<NcursesSurface>(height, width, startY, startX);
+}
+
+void NcursesScreen::update() {
+	doupdate();
+}
+
+void NcursesScreen::repaint() {
+	clear();
+	refresh();
+}
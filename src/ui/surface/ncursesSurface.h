@@ -0,0 +1,50 @@
+#pragma once
+
+#include "surface.h"
+#include <ncurses.h>
+
+// A surface backed by an ncurses window
+class NcursesSurface : public Surface {
+  public:
+	NcursesSurface(int height, int width, int startY, int startX);
+	~NcursesSurface() override;
+
+	NcursesSurface(const NcursesSurface&) = delete;
+	NcursesSurface& operator=(const NcursesSurface&) = delete;
+
+	int height() const override { return rows; }
+	int width() const override { return columns; }
+
+	void blank() override;
+	void drawBox() override;
+	void horizontalLine(int y, int x, int length) override;
+	void verticalLine(int y, int x, int length) override;
+	void clearCells(int y, int x, int length) override;
+	void print(int y, int x, std::string_view text) override;
+	void setReverse(bool on) override;
+	void setScrollRegion(int top, int bottom) override;
+	void scrollUp(int lines) override;
+	void moveCursor(int y, int x) override;
+	void stage() override;
+	void present() override;
+	bool readKey(wint_t& key, bool& isKeyCode) override;
+
+  private:
+	WINDOW* win;
+	int rows;
+	int columns;
+};
+
+// The real terminal, through ncurses' stdscr
+class NcursesScreen : public Screen {
+  public:
+	void init() override;
+	void cleanup() override;
+	void size(int& height, int& width) const override;
+	std::unique_ptr<Surface> createSurface(int height, int width, int startY, int startX) override;
+	void update() override;
+	void repaint() override;
+
+  private:
+	bool initialized = false;
+};
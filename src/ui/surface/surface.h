@@ -0,0 +1,75 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <wchar.h>
+
+// A rectangle of character cells a UI element draws on. Coordinates are relative to it, and
+// nothing drawn is visible until the surface is staged and the screen updated. Key codes are
+// ncurses' (KEY_UP, KEY_RESIZE...) whatever the backend.
+class Surface {
+  public:
+	// Key codes past ncurses' own for the start and end of a bracketed paste
+	static constexpr wint_t keyPasteBegin = 01000;
+	static constexpr wint_t keyPasteEnd = 01001;
+
+	virtual ~Surface() = default;
+
+	virtual int height() const = 0;
+	virtual int width() const = 0;
+
+	// Blank every cell (not erase(), which ncurses may define as a macro)
+	virtual void blank() = 0;
+
+	// Line border around the edge
+	virtual void drawBox() = 0;
+
+	// Border lines of length cells, matching drawBox()
+	virtual void horizontalLine(int y, int x, int length) = 0;
+	virtual void verticalLine(int y, int x, int length) = 0;
+
+	// Blank length cells of a row
+	virtual void clearCells(int y, int x, int length) = 0;
+
+	// UTF-8 text within row y, cut at the right edge
+	virtual void print(int y, int x, std::string_view text) = 0;
+
+	// Draw following text in reverse video
+	virtual void setReverse(bool on) = 0;
+
+	// Rows top..bottom (inclusive) move up by lines when scrolled; rows scrolled in are blank
+	virtual void setScrollRegion(int top, int bottom) = 0;
+	virtual void scrollUp(int lines) = 0;
+
+	// Where the terminal cursor is left when this surface is presented
+	virtual void moveCursor(int y, int x) = 0;
+
+	// Queue the changes for the next Screen::update()
+	virtual void stage() = 0;
+
+	// Stage and update the screen at once
+	virtual void present() = 0;
+
+	// Next buffered key without waiting; false when there is none. isKeyCode tells function keys
+	// (KEY_*) from characters.
+	virtual bool readKey(wint_t& key, bool& isKeyCode) = 0;
+};
+
+// The terminal the surfaces are laid out on
+class Screen {
+  public:
+	virtual ~Screen() = default;
+
+	virtual void init() = 0;
+	virtual void cleanup() = 0;
+
+	virtual void size(int& height, int& width) const = 0;
+
+	virtual std::unique_ptr<Surface> createSurface(int height, int width, int startY, int startX) = 0;
+
+	// Show everything staged since the last update
+	virtual void update() = 0;
+
+	// Repaint from scratch on the next update, e.g. after a resize
+	virtual void repaint() = 0;
+};
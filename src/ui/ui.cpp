@@ -1,85 +1,185 @@
 #include "ui.h"
+#include "../metrics/metrics.h"
+#include "renderScheduler.h"
+#include "surface/ncursesSurface.h"
 #include <algorithm>
-#include <ctime>
-#include <iomanip>
-#include <sstream>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <stdexcept>
+#include <unistd.h>
+#include <utility>
+
+#define CTRL_KEY(c) ((c) & 0x1f)
+
+namespace {
+
+const std::string composeHint = "Compose: Enter adds a line, Ctrl+D sends, Ctrl+T goes back";
+
+} // namespace
 
 UI::UI()
-  : uiManager(std::make_unique<UIManager>())
-  , statusMessage("Welcome to Chat") {}
+  : UI(std::make_unique<NcursesScreen>()) {}
+
+UI::UI(std::unique_ptr<Screen> screen)
+  : screen(std::move(screen))
+  , uiManager(std::make_unique<UIManager>(*this->screen))
+  , statusMessage("Welcome to Chat")
+  , frameRate(60) {}
 
 UI::~UI() {
 	cleanup();
 }
 
 void UI::init() {
-	// Initialize ncurses and UI components
+	// Initialize the terminal and UI components
 	uiManager->init();
 
 	// Set initial status
 	showStatus(statusMessage);
+
+	if (!inputHistoryFile.empty() && !uiManager->getInputElement()->openHistory(inputHistoryFile))
+		showStatus("Cannot write input history to " + inputHistoryFile);
 }
 
-std::string UI::handleInput() {
+bool UI::handleInput(std::string& submitted) {
 	auto* inputElement = uiManager->getInputElement();
 	wint_t ch;
-	int result_get = wget_wch(inputElement->getWindow(), &ch);
-	std::string result;
+	bool isKeyCode;
+	if (!inputElement->getSurface().readKey(ch, isKeyCode)) return false;
+
+	auto* chatElement = uiManager->getChatElement();
+	bool enter = ch == KEY_ENTER || ch == '\n' || ch == '\r';
+	bool tab = isKeyCode ? ch == KEY_BTAB : ch == '\t';
 
-	if (result_get == ERR) return result;
+	// Tab completes the word before the cursor, again for the next match; other keys end the cycle
+	if (tab && !inputElement->isPasting()) {
+		completer.cycle(*inputElement, isKeyCode ? -1 : 1);
+		return true;
+	}
+	completer.reset();
+
+	// A paste goes into the input whole, line breaks included
+	if (inputElement->isPasting() || (isKeyCode && ch == Surface::keyPasteBegin)) {
+		bool composing = inputElement->isComposing();
+		inputElement->processInput(ch, isKeyCode);
+		if (!composing && inputElement->isComposing()) showStatus(composeHint);
+		return true;
+	}
 
-	if (ch == KEY_ENTER || ch == '\n' || ch == '\r') {
+	// While search results are listed, Enter (on an empty input line), Escape and Up/Down belong to them
+	if (chatElement->isShowingResults() &&
+		((!isKeyCode && ((enter && inputElement->isEmpty()) || ch == 27)) ||
+		 (isKeyCode && (ch == KEY_UP || ch == KEY_DOWN)))) {
+		chatElement->handleInput(isKeyCode ? ch : enter ? '\n' : 27);
+		return true;
+	}
+
+	if (enter && !inputElement->isComposing()) {
 		// Submit current input
-		result = inputElement->getInput();
-		inputElement->clearInput();
-		return result;
+		submitted = inputElement->submit();
+		return true;
 	}
 
-	if (result_get == KEY_CODE_YES) {
+	if (isKeyCode) {
 		if (ch == KEY_RESIZE) {
 			// Handle terminal resize
 			handleResize();
-		} else if (ch == KEY_UP || ch == KEY_DOWN) {
+		} else if (ch >= KEY_F(1) && ch <= KEY_F(10)) {
+			// F1..F10 switch straight to a room tab
+			submitted = "/switch " + std::to_string(ch - KEY_F(0));
+		} else if (ch == KEY_PPAGE || ch == KEY_NPAGE) {
 			// Direct navigation keys to chat element for scrolling
-			uiManager->getChatElement()->handleInput(ch);
+			chatElement->handleInput(ch);
+		} else if (ch == KEY_SR || ch == KEY_SF) {
+			// Shift+Up/Down scroll the chat a line at a time; plain Up/Down walk the input history
+			chatElement->handleInput(ch == KEY_SR ? KEY_UP : KEY_DOWN);
+		} else if (ch == KEY_SPREVIOUS || ch == KEY_SNEXT) {
+			// Shift+Page Up/Down scroll the user list
+			int page = std::max(1, uiManager->getUserListElement()->getHeight() - 3);
+			uiManager->getUserListElement()->scrollBy(ch == KEY_SPREVIOUS ? -page : page);
+		} else if ((ch == KEY_HOME || ch == KEY_END) && inputElement->isEmpty()) {
+			// Home/End move the cursor while typing and jump through the history otherwise
+			chatElement->handleInput(ch);
 		} else {
 			// Let input element handle other special keys
 			inputElement->processInput(ch, true); // It's a special key
 		}
+	} else if (ch == CTRL_KEY('n') || ch == CTRL_KEY('p')) {
+		// Cycle through room tabs
+		submitted = ch == CTRL_KEY('n') ? "/switch +1" : "/switch -1";
+	} else if (ch == CTRL_KEY('t')) {
+		// Compose mode: Enter adds a line, Ctrl+D sends
+		inputElement->setComposing(!inputElement->isComposing());
+		showStatus(inputElement->isComposing() ? composeHint : "Compose off: Enter sends");
+	} else if (ch == CTRL_KEY('d') && inputElement->isComposing()) {
+		submitted = inputElement->submit();
 	} else {
 		// Regular character input
 		inputElement->processInput(ch, false); // It's a regular character
 	}
 
-	return result;
+	return true;
+}
+
+void UI::setCommands(const PrefixTrie& commands) {
+	completer.setCommands(&commands);
+}
+
+void UI::setRooms(const std::vector<std::string>& rooms) {
+	completer.setRooms(rooms);
 }
 
 void UI::handleResize() {
 	uiManager->handleResize();
 }
 
-void UI::run(std::function<void(const std::string&)> messageHandler) {
+void UI::run(std::function<void(const std::string&)> messageHandler, std::function<void()> eventPump, int wakeFd) {
 	bool running = true;
+	pollfd fds[2] = { { STDIN_FILENO, POLLIN, 0 }, { wakeFd, POLLIN, 0 } };
+	nfds_t fdCount = wakeFd >= 0 ? 2 : 1;
+	RenderScheduler scheduler(frameRate);
+
+	// Draw anything queued before the loop started
+	if (eventPump) eventPump();
+	uiManager->refreshElements();
 
 	while (running) {
 		try {
-			std::string input = handleInput();
-
-			if (!input.empty()) {
-				if (input == "/exit") {
+			// Sleep until a key arrives, the network signals new data, a signal (SIGWINCH) interrupts
+			// or, with something left to draw, the next frame is due
+			fds[0].revents = fds[1].revents = 0;
+			if (poll(fds, fdCount, scheduler.pollTimeout(uiManager->hasDamage())) < 0 && errno != EINTR)
+				throw std::runtime_error("poll failed: " + std::string(std::strerror(errno)));
+
+			// Consume every key the screen can deliver without blocking
+			std::string input;
+			while (running && handleInput(input)) {
+				if (input.empty()) continue;
+
+				if (input == "/exit")
 					running = false;
-					continue;
-				}
-
-				// Process input via callback
-				messageHandler(input);
+				else
+					messageHandler(input); // Process input via callback
+				input.clear();
 			}
 
-			// Update elements that need redrawing
-			uiManager->refreshElements();
-
-			// Small delay to reduce CPU usage
-			napms(10);
+			// Typed keys are echoed at once, outside the frame budget; the input may have grown a line
+			uiManager->fitInput();
+			uiManager->refreshInput();
+
+			// Apply events received from the network thread
+			if (eventPump && (fdCount == 1 || (fds[1].revents & POLLIN))) eventPump();
+
+			// Everything else is drawn by the next frame
+			if (!uiManager->hasDamage()) continue;
+			if (scheduler.frameDue()) {
+				uint64_t start = Metrics::nowNs();
+				uiManager->refreshElements();
+				scheduler.frameDrawn(start, Metrics::nowNs());
+			} else {
+				scheduler.deferred();
+			}
 		} catch (const std::exception& e) {
 			showStatus("Error: " + std::string(e.what()));
 			addSystemMessage("Error occurred: " + std::string(e.what()));
@@ -87,38 +187,54 @@ void UI::run(std::function<void(const std::string&)> messageHandler) {
 	}
 }
 
-void UI::addMessage(const std::string& username, const std::string& message) {
-	// Get current time
-	auto now = std::time(nullptr);
-	auto tm = *std::localtime(&now);
-	std::ostringstream oss;
-	oss << std::put_time(&tm, "[%H:%M:%S] ");
+void UI::addMessage(std::string_view username, std::string_view message) {
+	auto* chatElement = uiManager->getChatElement();
+	chatElement->getHistory().addMessage(username, message);
+	chatElement->onHistoryAppended();
+}
 
-	std::string formattedMessage = oss.str() + username + ": " + message;
-	uiManager->getChatElement()->addMessage(formattedMessage);
+void UI::addSystemMessage(std::string_view message) {
+	auto* chatElement = uiManager->getChatElement();
+	chatElement->getHistory().addSystemMessage(message);
+	chatElement->onHistoryAppended();
+
+	// EventBus removed - direct calls should be used if notification is needed
 }
 
-void UI::addSystemMessage(const std::string& message) {
-	// Get current time
-	auto now = std::time(nullptr);
-	auto tm = *std::localtime(&now);
-	std::ostringstream oss;
-	oss << std::put_time(&tm, "[%H:%M:%S] ");
+void UI::showHistory(ChatHistory* history) {
+	uiManager->getChatElement()->setHistory(history);
+}
 
-	std::string formattedMessage = oss.str() + "* " + message;
-	uiManager->getChatElement()->addMessage(formattedMessage);
+void UI::showSearchResults(const std::vector<int64_t>& ids, const std::string& title) {
+	uiManager->getChatElement()->showResults(ids, title);
+}
 
-	// EventBus removed - direct calls should be used if notification is needed
+void UI::historyAppended(const std::string&, ChatHistory&, size_t count, bool shown) {
+	if (shown) uiManager->getChatElement()->onHistoryAppended(count);
+}
+
+void UI::updateTabs(const std::vector<ChatElement::Tab>& tabs) {
+	uiManager->getChatElement()->setTabs(tabs);
+}
+
+void UI::showUsers(UserList* users) {
+	uiManager->getUserListElement()->setUsers(users);
+	completer.setUsers(users);
+}
+
+void UI::usersChanged(const std::string&, const UserList&, bool shown) {
+	if (!shown) return;
+	completer.reset(); // Positions of the matches may have moved
+	uiManager->getUserListElement()->onUsersChanged();
 }
 
-void UI::updateUsers(const std::vector<std::string>& users) {
-	uiManager->getUserListElement()->updateUsers(users);
+void UI::filterUsers(const std::string& prefix) {
+	uiManager->getUserListElement()->setFilter(prefix);
 }
 
 void UI::showStatus(const std::string& status) {
 	statusMessage = status;
 	uiManager->getStatusElement()->setStatus(status);
-	uiManager->refreshElements();
 }
 
 bool UI::isOnBottom() const {
@@ -1,49 +1,90 @@
 #pragma once
 
+#include "../frontend.h"
+#include "completer.h"
+#include "surface/surface.h"
 #include "uiManager.h"
 #include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
-class UI {
+class UI : public Frontend {
   public:
+	// Draws on the terminal through ncurses
 	UI();
+	// Draws on another screen, e.g. a MemoryScreen to run without a terminal
+	explicit UI(std::unique_ptr<Screen> screen);
 	~UI();
 
 	// Initialize the UI
-	void init();
+	void init() override;
 
-	// Main UI loop
-	void run(std::function<void(const std::string&)> messageHandler);
+	// Names Tab completes: commands and the last room list
+	void setCommands(const PrefixTrie& commands) override;
+	void setRooms(const std::vector<std::string>& rooms) override;
 
-	// Add a message to the chat window
-	void addMessage(const std::string& username, const std::string& message);
+	// Keep sent lines in this file across runs (empty: in memory only); call before init()
+	void setInputHistory(const std::string& path) { inputHistoryFile = path; }
 
-	// Add a system message (like user joined/left)
-	void addSystemMessage(const std::string& message);
+	// Cap screen updates at this many per second (0: draw every change at once); call before run()
+	void setFrameRate(unsigned framesPerSecond) { frameRate = framesPerSecond; }
 
-	// Update the user list
-	void updateUsers(const std::vector<std::string>& users);
+	// Main UI loop. Blocks in poll() on stdin and wakeFd; eventPump applies queued network
+	// events whenever wakeFd becomes readable (or every iteration if wakeFd is -1)
+	void run(std::function<void(const std::string&)> messageHandler, std::function<void()> eventPump,
+			 int wakeFd = -1) override;
+
+	// Add a message to the shown chat history
+	void addMessage(std::string_view username, std::string_view message);
+
+	// Add a system message (like user joined/left) to the shown chat history
+	void addSystemMessage(std::string_view message) override;
+
+	// Switch the chat window to another room's history
+	void showHistory(ChatHistory* history) override;
+
+	// List lines of the shown history (ids from ChatHistory::search) in the chat window
+	void showSearchResults(const std::vector<int64_t>& ids, const std::string& title) override;
+
+	// Lines were appended to a room's history; only the shown one is redrawn
+	void historyAppended(const std::string& room, ChatHistory& history, size_t count, bool shown) override;
+
+	// Update the room tab bar
+	void updateTabs(const std::vector<ChatElement::Tab>& tabs) override;
+
+	// Show a room's members in the user list (nullptr when not in a room)
+	void showUsers(UserList* users) override;
+
+	// A room's member list changed; only the shown one is redrawn
+	void usersChanged(const std::string& room, const UserList& users, bool shown) override;
+
+	// Only list members whose name starts with prefix (empty lists everyone)
+	void filterUsers(const std::string& prefix) override;
 
 	// Show an error or notification in the status bar
-	void showStatus(const std::string& status);
+	void showStatus(const std::string& status) override;
 
 	// Check if chat is scrolled to the bottom
 	bool isOnBottom() const;
 
 	// Update the room name in the chat window
-	void updateRoomName(const std::string& roomName);
+	void updateRoomName(const std::string& roomName) override;
 
 	// Clean up resources and exit
 	void cleanup();
 
   private:
+	std::unique_ptr<Screen> screen;
 	std::unique_ptr<UIManager> uiManager;
 	std::string statusMessage;
+	unsigned frameRate;
+	std::string inputHistoryFile;
+	Completer completer;
 
-	// Input handling
-	std::string handleInput();
+	// Input handling; returns false once no more keys are buffered
+	bool handleInput(std::string& submitted);
 
 	// Window management
 	void handleResize();
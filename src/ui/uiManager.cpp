@@ -1,23 +1,17 @@
 #include "uiManager.h"
+#include "../metrics/metrics.h"
 #include <algorithm>
-#include <ncurses.h>
 
-UIManager::UIManager() {}
+UIManager::UIManager(Screen& screen)
+  : screen(screen) {}
 
 UIManager::~UIManager() {
 	cleanup();
 }
 
 void UIManager::init() {
-	// Initialize ncurses
-	initscr();
-	cbreak();
-	noecho();
-	keypad(stdscr, TRUE);
-	start_color();
-	use_default_colors();
-	curs_set(1); // Show cursor
-	timeout(100);
+	// Initialize the terminal
+	screen.init();
 
 	// Create windows
 	initWindows();
@@ -30,23 +24,23 @@ void UIManager::initWindows() {
 void UIManager::setupWindows(bool initialSetup) {
 	// Get terminal dimensions
 	int maxY, maxX;
-	getmaxyx(stdscr, maxY, maxX);
+	screen.size(maxY, maxX);
 
 	// Calculate dimensions
 	userListWidth = std::max(20, maxX / 5);
 	chatWidth = maxX - userListWidth;
-	userListHeight = maxY - 3;
-	chatHeight = maxY - 3;
-	inputHeight = 1;
+	inputHeight = initialSetup ? 1 : inputRows(maxY);
+	userListHeight = maxY - 2 - inputHeight;
+	chatHeight = maxY - 2 - inputHeight;
 	inputWidth = maxX;
 	statusHeight = 1;
 
 	if (initialSetup) {
 		// Create UI elements
-		chatElement = std::make_unique<ChatElement>(chatHeight, chatWidth, 0, 0);
-		userListElement = std::make_unique<UserListElement>(userListHeight, userListWidth, 0, chatWidth);
-		inputElement = std::make_unique<InputElement>(inputHeight, inputWidth, maxY - 2, 0);
-		statusElement = std::make_unique<StatusElement>(statusHeight, maxX, maxY - 1, 0);
+		chatElement = std::make_unique<ChatElement>(screen, chatHeight, chatWidth, 0, 0);
+		userListElement = std::make_unique<UserListElement>(screen, userListHeight, userListWidth, 0, chatWidth);
+		inputElement = std::make_unique<InputElement>(screen, inputHeight, inputWidth, maxY - 1 - inputHeight, 0);
+		statusElement = std::make_unique<StatusElement>(screen, statusHeight, maxX, maxY - 1, 0);
 
 		// Populate elements list
 		elements.clear();
@@ -55,14 +49,14 @@ void UIManager::setupWindows(bool initialSetup) {
 		elements.push_back(inputElement.get());
 		elements.push_back(statusElement.get());
 
-		// Set initial user list content
-		std::vector<std::string> initialUserList;
-		userListElement->updateUsers(initialUserList);
+		Metrics& metrics = Metrics::get();
+		drawTimes = { &metrics.drawTime("chat"), &metrics.drawTime("users"), &metrics.drawTime("input"),
+					  &metrics.drawTime("status") };
 	} else {
 		// Resize all UI elements
 		chatElement->resize(chatHeight, chatWidth, 0, 0);
 		userListElement->resize(userListHeight, userListWidth, 0, chatWidth);
-		inputElement->resize(inputHeight, inputWidth, maxY - 2, 0);
+		inputElement->resize(inputHeight, inputWidth, maxY - 1 - inputHeight, 0);
 		statusElement->resize(statusHeight, maxX, maxY - 1, 0);
 	}
 
@@ -73,36 +67,68 @@ void UIManager::setupWindows(bool initialSetup) {
 	}
 
 	// Set input focus
-	wmove(inputElement->getWindow(), 0, inputElement->getInput().length() + 2);
-	wrefresh(inputElement->getWindow());
+	inputElement->refresh();
 }
 
 void UIManager::handleResize() {
-	clear();
-	refresh();
+	screen.repaint();
 	setupWindows(false);
 }
 
+int UIManager::inputRows(int screenHeight) const {
+	// The chat keeps at least three rows however many lines are being composed
+	return std::clamp(inputElement->desiredHeight(), 1, std::max(1, screenHeight - 5));
+}
+
+void UIManager::fitInput() {
+	int maxY, maxX;
+	screen.size(maxY, maxX);
+	// Laid out again from a blank screen, as the spacer row above the input moves with it
+	if (inputRows(maxY) != inputHeight) handleResize();
+}
+
 void UIManager::refreshElements() {
 	// Update elements that need redrawing using double-buffering
-	for (auto* element : elements) {
+	bool drawn = false;
+	for (size_t i = 0; i < elements.size(); ++i) {
+		UIElement* element = elements[i];
 		if (element && element->getNeedRedraw()) {
+			uint64_t start = Metrics::nowNs();
 			element->draw();
-			wnoutrefresh(element->getWindow());
+			drawTimes[i]->record(Metrics::nowNs() - start);
+			element->getSurface().stage();
+			drawn = true;
 		}
 	}
-	doupdate();
+	screen.update();
+
+	if (drawn) Metrics::get().redraws.fetch_add(1, std::memory_order_relaxed);
+	Metrics::get().screenUpdated();
 
 	// Make sure the input element's cursor is properly positioned
 	inputElement->refresh();
 }
 
+bool UIManager::hasDamage() const {
+	return std::any_of(elements.begin(), elements.end(), [](UIElement* element) { return element->getNeedRedraw(); });
+}
+
+void UIManager::refreshInput() {
+	// Other surfaces' pending changes are not on screen until they are staged
+	if (!inputElement->getNeedRedraw()) return;
+	uint64_t start = Metrics::nowNs();
+	inputElement->draw();
+	drawTimes[2]->record(Metrics::nowNs() - start);
+	inputElement->refresh();
+}
+
 void UIManager::cleanup() {
 	// Elements will clean up their windows in destructors
 	elements.clear();
+	drawTimes.clear();
 	chatElement.reset();
 	inputElement.reset();
 	userListElement.reset();
 	statusElement.reset();
-	endwin();
+	screen.cleanup();
 }
\ No newline at end of file
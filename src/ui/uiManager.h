@@ -1,16 +1,19 @@
 #pragma once
 
+#include "../metrics/latencyHistogram.h"
 #include "elements/chatElement.h"
 #include "elements/inputElement.h"
 #include "elements/statusElement.h"
 #include "elements/userListElement.h"
+#include "surface/surface.h"
 #include <functional>
 #include <memory>
 #include <vector>
 
 class UIManager {
   public:
-	UIManager();
+	// Lays the elements out on screen, which must outlive the manager
+	explicit UIManager(Screen& screen);
 	~UIManager();
 
 	void init();
@@ -25,10 +28,21 @@ class UIManager {
 	// Resize handler
 	void handleResize();
 
-	// Refresh all elements that need redrawing
+	// Give the input element the rows it wants, e.g. when a line is added while composing
+	void fitInput();
+
+	// Refresh all elements that need redrawing, with a single screen update
 	void refreshElements();
 
+	// Any element waiting to be redrawn
+	bool hasDamage() const;
+
+	// Draw just the input line, e.g. to echo a key without waiting for the next frame
+	void refreshInput();
+
   private:
+	Screen& screen;
+
 	// UI elements
 	std::unique_ptr<ChatElement> chatElement;
 	std::unique_ptr<InputElement> inputElement;
@@ -37,6 +51,7 @@ class UIManager {
 
 	// List of all elements for easier iteration
 	std::vector<UIElement*> elements;
+	std::vector<LatencyHistogram*> drawTimes; // Parallel to elements
 
 	// Window dimensions and positions
 	int chatHeight, chatWidth;
@@ -47,4 +62,5 @@ class UIManager {
 	// Initialize windows
 	void initWindows();
 	void setupWindows(bool initialSetup);
+	int inputRows(int screenHeight) const;
 };
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "userList.h"
+#include <algorithm>
+
+namespace {
+
+// Departed names kept interned beyond twice the members, so churn in a small room compacts rarely
+const size_t namesSlack = 64;
+
+char fold(char c) {
+	return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+} // namespace
+
+int UserList::compareFolded(std::string_view a, std::string_view b) {
+	size_t length = std::min(a.size(), b.size());
+	for (size_t i = 0; i < length; ++i) {
+		char x = fold(a[i]), y = fold(b[i]);
+		if (x != y) return static_cast<unsigned char>(x) < static_cast<unsigned char>(y) ? -1 : 1;
+	}
+	if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+	return 0;
+}
+
+int UserList::compare(std::string_view a, std::string_view b) {
+	int folded = compareFolded(a, b);
+	return folded != 0 ? folded : a.compare(b);
+}
+
+size_t UserList::position(uint32_t id) const {
+	std::string_view name = names.lookup(id);
+	return std::lower_bound(members.begin(), members.end(), name,
+							[this](uint32_t member, std::string_view key) {
+								return compare(names.lookup(member), key) < 0;
+							}) -
+		   members.begin();
+}
+
+void UserList::changedAt(size_t position) {
+	changedFrom = std::min(changedFrom, position);
+	changes++;
+}
+
+void UserList::see(std::string_view name) {
+	uint32_t id = names.intern(name);
+	if (id == seenIn.size()) {
+		seenIn.push_back(0);
+		isMember.push_back(false);
+	}
+	if (seenIn[id] == generation) return; // Listed twice
+	seenIn[id] = generation;
+	seenMembers++;
+
+	// Joined since the last list
+	if (!isMember[id]) {
+		size_t at = position(id);
+		members.insert(members.begin() + at, id);
+		isMember[id] = true;
+		changedAt(at);
+	}
+}
+
+bool UserList::finishAssign() {
+	// Members not seen in this list left; usually none, so the compaction pass is skipped
+	if (seenMembers == members.size()) return changes > 0;
+
+	size_t out = 0;
+	for (size_t in = 0; in < members.size(); ++in) {
+		uint32_t id = members[in];
+		if (seenIn[id] != generation) {
+			isMember[id] = false;
+			changedAt(out);
+			continue;
+		}
+		members[out++] = id;
+	}
+	members.resize(out);
+
+	// Names of departed members stay interned; drop them once they outnumber the members
+	if (names.size() > 2 * members.size() + namesSlack) compactNames();
+	return true;
+}
+
+void UserList::compactNames() {
+	// Re-intern the members in order; their sorted order is unchanged
+	StringInterner kept;
+	for (uint32_t& id : members)
+		id = kept.intern(names.lookup(id));
+	names = std::move(kept);
+	seenIn.assign(members.size(), generation);
+	isMember.assign(members.size(), true);
+}
+
+void UserList::prefixRange(std::string_view prefix, size_t& first, size_t& last) const {
+	auto startsBefore = [this, prefix](uint32_t member) {
+		std::string_view name = names.lookup(member);
+		return compareFolded(name.substr(0, prefix.size()), prefix) < 0;
+	};
+	auto startsWithOrBefore = [this, prefix](uint32_t member) {
+		std::string_view name = names.lookup(member);
+		return compareFolded(name.substr(0, prefix.size()), prefix) <= 0;
+	};
+	first = std::partition_point(members.begin(), members.end(), startsBefore) - members.begin();
+	last = std::partition_point(members.begin() + first, members.end(), startsWithOrBefore) - members.begin();
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "../util/stringInterner.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Members of one room, kept sorted (case-insensitively) for UserListElement.
+// A new member list from the server is diffed against the current one: every name is looked
+// up once, and only joins and leaves touch the sorted order. The element redraws rows from the
+// first changed position on. Names of members who left are forgotten once they outnumber the
+// members, so a busy room's churn does not grow the list.
+class UserList {
+  public:
+	// Replace the members with names (any range of string-like values); false if nothing changed
+	template <typename Range>
+	bool assign(const Range& names);
+
+	size_t size() const { return members.size(); }
+	std::string_view operator[](size_t position) const { return names.lookup(members[position]); }
+
+	// Positions [first, last) of the members whose name starts with prefix, case-insensitively
+	void prefixRange(std::string_view prefix, size_t& first, size_t& last) const;
+
+	// Lowest position changed since the last clearChanged(), SIZE_MAX if none
+	size_t firstChanged() const { return changedFrom; }
+	void clearChanged() { changedFrom = SIZE_MAX; }
+
+  private:
+	StringInterner names;
+	std::vector<uint32_t> members;  // Interned names, sorted
+	std::vector<uint32_t> seenIn;   // By name id: the assign() that last saw it
+	std::vector<bool> isMember;     // By name id
+	uint32_t generation = 0;
+	size_t seenMembers = 0; // Current assign(): listed names that are members
+	size_t changes = 0;     // Current assign(): joins and leaves
+	size_t changedFrom = SIZE_MAX;
+
+	void see(std::string_view name);
+	bool finishAssign();
+	void compactNames();
+	size_t position(uint32_t id) const;
+	void changedAt(size_t position);
+
+	// Case-insensitive order, ties broken by bytes
+	static int compareFolded(std::string_view a, std::string_view b);
+	static int compare(std::string_view a, std::string_view b);
+};
+
+template <typename Range>
+bool UserList::assign(const Range& newNames) {
+	generation++;
+	seenMembers = changes = 0;
+	for (const auto& name : newNames)
+		see(std::string_view(name));
+	return finishAssign();
+}
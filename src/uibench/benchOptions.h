@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+
+struct BenchOptions {
+	// Size of the in-memory terminal
+	int height = 40;
+	int width = 120;
+
+	// Lines already in the room before measuring, and their message length
+	size_t historyLines = 10000;
+	size_t messageSize = 80;
+
+	// Room members in the user list
+	size_t users = 200;
+
+	// Frames drawn per scenario
+	size_t frames = 1000;
+
+	// Print the screen after each scenario
+	bool dump = false;
+};
@@ -0,0 +1,70 @@
+#include "uiBenchmark.h"
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+static void printUsage(const char* program) {
+	std::cout << "Usage: " << program << " [options]\n"
+			  << "  --width=N                  Columns of the in-memory terminal (default 120)\n"
+			  << "  --height=N                 Rows of the in-memory terminal (default 40)\n"
+			  << "  --lines=N                  Lines of history before measuring (default 10000)\n"
+			  << "  --size=N                   Message size in bytes (default 80)\n"
+			  << "  --users=N                  Room members (default 200)\n"
+			  << "  --frames=N                 Frames drawn per scenario (default 1000)\n"
+			  << "  --dump                     Print the screen after each scenario\n"
+			  << "  --help                     Show this help\n";
+}
+
+// Returns the value of "--name=value" if arg matches name, nullptr otherwise
+static const char* optionValue(const char* arg, const char* name) {
+	size_t len = std::strlen(name);
+	if (std::strncmp(arg, name, len) != 0 || arg[len] != '=') return nullptr;
+	return arg + len + 1;
+}
+
+static bool parseOptions(int argc, char** argv, BenchOptions& options) {
+	for (int i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+		const char* value;
+
+		if (std::strcmp(arg, "--help") == 0) {
+			printUsage(argv[0]);
+			std::exit(0);
+		} else if ((value = optionValue(arg, "--width"))) {
+			options.width = std::atoi(value);
+			if (options.width < 30) return false;
+		} else if ((value = optionValue(arg, "--height"))) {
+			options.height = std::atoi(value);
+			if (options.height < 6) return false;
+		} else if ((value = optionValue(arg, "--lines"))) {
+			options.historyLines = std::strtoul(value, nullptr, 10);
+		} else if ((value = optionValue(arg, "--size"))) {
+			options.messageSize = std::strtoul(value, nullptr, 10);
+		} else if ((value = optionValue(arg, "--users"))) {
+			options.users = std::strtoul(value, nullptr, 10);
+			if (options.users == 0) return false;
+		} else if ((value = optionValue(arg, "--frames"))) {
+			options.frames = std::strtoul(value, nullptr, 10);
+		} else if (std::strcmp(arg, "--dump") == 0) {
+			options.dump = true;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv) {
+	std::setlocale(LC_ALL, "");
+
+	BenchOptions options;
+	if (!parseOptions(argc, argv, options)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	UIBenchmark benchmark(options);
+	benchmark.run();
+	return 0;
+}
@@ -0,0 +1,157 @@
+#include "uiBenchmark.h"
+#include "../metrics/metrics.h"
+#include <iomanip>
+#include <iostream>
+#include <ncurses.h>
+#include <sstream>
+
+static std::string formatNs(uint64_t ns) {
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(1) << ns / 1000.0 << "us";
+	return out.str();
+}
+
+UIBenchmark::UIBenchmark(const BenchOptions& options)
+  : options(options)
+  , screen(options.height, options.width)
+  , manager(screen)
+  , nextLine(0) {
+
+	manager.init();
+	appendLines(options.historyLines);
+	manager.getChatElement()->setHistory(&history);
+	manager.getChatElement()->setRoomName("bench");
+
+	for (size_t i = 0; i < options.users; ++i)
+		memberNames.push_back((i % 3 == 0 ? "User" : "user") + std::to_string(i * 7919 % 100000));
+	users.assign(memberNames);
+	manager.getUserListElement()->setUsers(&users);
+
+	manager.getStatusElement()->setStatus("Headless UI benchmark");
+	manager.refreshElements();
+}
+
+void UIBenchmark::run() {
+	std::cout << "Screen " << options.width << "x" << options.height << ", " << options.historyLines
+			  << " lines of history, " << options.users << " members, " << options.frames << " frames per scenario\n";
+
+	ChatElement* chat = manager.getChatElement();
+	InputElement* input = manager.getInputElement();
+
+	scenario("append", [&](size_t) { appendLines(1); });
+
+	scenario("burst", [&](size_t) { appendLines(50); });
+
+	scenario("scroll", [&](size_t frame) {
+		// Page up through the history, then back down
+		if (frame % 20 < 10)
+			chat->scrollPageUp();
+		else
+			chat->scrollPageDown();
+	});
+	chat->scrollToBottom();
+
+	scenario("users", [&](size_t frame) {
+		// One member leaves or comes back each frame
+		std::vector<std::string> members = memberNames;
+		if (frame % 2 == 0) members.erase(members.begin() + (frame / 2 * 31) % members.size());
+		if (users.assign(members)) manager.getUserListElement()->onUsersChanged();
+	});
+
+	scenario("typing", [&](size_t frame) {
+		if (frame % 40 == 39)
+			input->clearInput();
+		else
+			input->processInput(L'a' + frame % 26, false);
+	});
+
+	// Tab through the members matching a prefix; the lookup is timed too
+	completer.setUsers(&users);
+	input->clearInput();
+	for (char c : std::string("user1"))
+		input->processInput(c, false);
+	scenario("complete", [&](size_t) { completer.cycle(*input, 1); }, true);
+	input->clearInput();
+	completer.reset();
+
+	// Edit in the middle of a long pasted draft; the edit is timed too
+	input->processInput(Surface::keyPasteBegin, true);
+	for (size_t line = 0; line < 1000; ++line)
+		for (char c : message(line) + "\n")
+			input->processInput(static_cast<unsigned char>(c), false);
+	input->processInput(Surface::keyPasteEnd, true);
+	manager.fitInput();
+	for (int i = 0; i < 500; ++i)
+		input->processInput(KEY_UP, true);
+	scenario(
+		"editing",
+		[&](size_t frame) {
+			if (frame % 2 == 0)
+				input->processInput(L'a' + frame % 26, false);
+			else
+				input->processInput(KEY_BACKSPACE, true);
+		},
+		true);
+	input->submit();
+	manager.fitInput();
+
+	// Resizing redraws everything right away
+	scenario(
+		"resize",
+		[&](size_t frame) {
+			screen.resize(options.height - static_cast<int>(frame % 2), options.width - static_cast<int>(frame % 2) * 10);
+			manager.handleResize();
+		},
+		true);
+	screen.resize(options.height, options.width);
+	manager.handleResize();
+}
+
+void UIBenchmark::scenario(const char* name, const std::function<void(size_t frame)>& change, bool timeChange) {
+	LatencyHistogram frameTimes;
+	uint64_t cellsBefore = screen.cellsChanged();
+	uint64_t totalNs = 0;
+
+	for (size_t frame = 0; frame < options.frames; ++frame) {
+		uint64_t start = Metrics::nowNs();
+		change(frame);
+		if (!timeChange) start = Metrics::nowNs();
+		manager.refreshElements();
+		uint64_t elapsed = Metrics::nowNs() - start;
+		frameTimes.record(elapsed);
+		totalNs += elapsed;
+	}
+
+	LatencyHistogram::Snapshot snapshot = frameTimes.snapshot();
+	double frames = std::max<size_t>(1, options.frames);
+	std::cout << std::left << std::setw(8) << name << " p50 " << std::setw(9) << formatNs(snapshot.percentile(0.5))
+			  << " p99 " << std::setw(9) << formatNs(snapshot.percentile(0.99)) << " max " << std::setw(9)
+			  << formatNs(snapshot.max) << " mean " << std::setw(9) << formatNs(totalNs / frames) << " cells/frame "
+			  << std::fixed << std::setprecision(0) << (screen.cellsChanged() - cellsBefore) / frames << "\n";
+
+	// Keys a resize queued are not read by anyone here
+	wint_t key;
+	bool isKeyCode;
+	while (manager.getInputElement()->getSurface().readKey(key, isKeyCode)) {}
+
+	if (!options.dump) return;
+	std::cout << "--- " << name << " ---\n";
+	for (const std::string& line : screen.dump())
+		std::cout << line << "\n";
+}
+
+void UIBenchmark::appendLines(size_t count) {
+	for (size_t i = 0; i < count; ++i, ++nextLine)
+		history.addMessage("user" + std::to_string(nextLine % 50), message(nextLine));
+	manager.getChatElement()->onHistoryAppended(count);
+}
+
+std::string UIBenchmark::message(size_t number) const {
+	// Words of varied length so wrapping has breaks to choose from
+	static const char* const words[] = { "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit" };
+	std::string text = "#" + std::to_string(number);
+	for (size_t i = 0; text.size() < options.messageSize; ++i)
+		text += std::string(" ") + words[(number + i * 3) % 8];
+	text.resize(options.messageSize);
+	return text;
+}
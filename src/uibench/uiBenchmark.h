@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../metrics/latencyHistogram.h"
+#include "../ui/chatHistory.h"
+#include "../ui/completer.h"
+#include "../ui/surface/memorySurface.h"
+#include "../ui/uiManager.h"
+#include "../ui/userList.h"
+#include "benchOptions.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+// Draws the client's UI on a MemoryScreen and reports the cost of each frame for typical
+// workloads: new lines at the bottom, bursts, scrolling, member churn, typing, Tab completion,
+// editing a long draft and resizes. No terminal is involved, so results are repeatable and can
+// run in CI.
+class UIBenchmark {
+  public:
+	explicit UIBenchmark(const BenchOptions& options);
+
+	void run();
+
+  private:
+	BenchOptions options;
+	MemoryScreen screen;
+	UIManager manager;
+	ChatHistory history;
+	UserList users;
+	Completer completer;
+	std::vector<std::string> memberNames;
+	size_t nextLine;
+
+	// Runs change then draws a frame, options.frames times; timeChange counts the change as drawing
+	void scenario(const char* name, const std::function<void(size_t frame)>& change, bool timeChange = false);
+
+	void appendLines(size_t count);
+	std::string message(size_t number) const;
+};
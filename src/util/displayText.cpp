@@ -0,0 +1,291 @@
+#include "displayText.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <cwchar>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr char32_t replacement = 0xFFFD;
+
+// Widths of code points below this are cached, 2 bits each: 0 not measured yet, otherwise width + 1.
+// Covers every script and the emoji planes in 32 KiB.
+constexpr char32_t cachedCodePoints = 0x20000;
+std::atomic<uint32_t> widthCache[cachedCodePoints / 16];
+
+// Bidirectional overrides and isolates reorder the text around them on terminals that honour them
+bool isBidiControl(char32_t ch) {
+	return (ch >= 0x202A && ch <= 0x202E) || (ch >= 0x2066 && ch <= 0x2069);
+}
+
+// End of a control string (OSC, DCS...) starting at i: after BEL or ST, or the end of the text
+size_t skipControlString(std::string_view text, size_t i) {
+	for (; i < text.size(); ++i) {
+		if (text[i] == '\a') return i + 1;
+		if (text[i] == '\x1B' && i + 1 < text.size() && text[i + 1] == '\\') return i + 2;
+		if (text[i] == '\xC2' && i + 1 < text.size() && text[i + 1] == '\x9C') return i + 2; // U+009C
+	}
+	return i;
+}
+
+// End of a CSI sequence whose parameters start at i
+size_t skipCsi(std::string_view text, size_t i) {
+	while (i < text.size() && text[i] >= 0x30 && text[i] <= 0x3F)
+		i++;
+	while (i < text.size() && text[i] >= 0x20 && text[i] <= 0x2F)
+		i++;
+	if (i < text.size() && text[i] >= 0x40 && text[i] <= 0x7E) i++;
+	return i;
+}
+
+// End of the escape sequence whose introducer (ESC, or a C1 code point) ends at i; kind is the
+// byte that follows ESC in the 7-bit form ('[' for CSI...)
+size_t skipSequence(std::string_view text, size_t i, char kind) {
+	switch (kind) {
+		case '[': return skipCsi(text, i);
+		case ']':
+		case 'P':
+		case 'X':
+		case '^':
+		case '_': return skipControlString(text, i);
+		default: return i;
+	}
+}
+
+// End of the escape sequence starting with the ESC at i
+size_t skipEscape(std::string_view text, size_t i) {
+	i++;
+	if (i == text.size()) return i;
+
+	char kind = text[i];
+	if (kind == '[' || kind == ']' || kind == 'P' || kind == 'X' || kind == '^' || kind == '_')
+		return skipSequence(text, i + 1, kind);
+
+	// nF sequences (ESC ( B...) have intermediates before the final byte
+	while (i < text.size() && text[i] >= 0x20 && text[i] <= 0x2F)
+		i++;
+	if (i < text.size() && text[i] >= 0x30 && text[i] <= 0x7E) i++;
+	return i;
+}
+
+int measure(char32_t ch) {
+	int width = wcwidth(static_cast<wchar_t>(ch));
+	return width < 0 ? 1 : std::min(width, 2);
+}
+
+} // namespace
+
+void DisplayText::appendUtf8(std::string& out, char32_t ch) {
+	if (ch < 0x80) {
+		out += static_cast<char>(ch);
+	} else if (ch < 0x800) {
+		out += static_cast<char>(0xC0 | (ch >> 6));
+		out += static_cast<char>(0x80 | (ch & 0x3F));
+	} else if (ch < 0x10000) {
+		out += static_cast<char>(0xE0 | (ch >> 12));
+		out += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+		out += static_cast<char>(0x80 | (ch & 0x3F));
+	} else {
+		out += static_cast<char>(0xF0 | (ch >> 18));
+		out += static_cast<char>(0x80 | ((ch >> 12) & 0x3F));
+		out += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+		out += static_cast<char>(0x80 | (ch & 0x3F));
+	}
+}
+
+size_t DisplayText::asciiPrefix(std::string_view text) {
+	const char* data = text.data();
+	size_t size = text.size();
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	// Signed compare: bytes >= 0x80 are negative, so "< 0x20" also catches everything non-ASCII
+	const __m128i space = _mm_set1_epi8(0x20);
+	const __m128i del = _mm_set1_epi8(0x7F);
+	for (; i + 16 <= size; i += 16) {
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmplt_epi8(bytes, space), _mm_cmpeq_epi8(bytes, del)));
+		if (mask != 0) return i + __builtin_ctz(mask);
+	}
+#else
+	// Eight bytes at a time: any byte >= 0x7F or < 0x20 stops the fast loop
+	const uint64_t ones = 0x0101010101010101ULL, highs = 0x8080808080808080ULL;
+	for (; i + 8 <= size; i += 8) {
+		uint64_t word;
+		std::memcpy(&word, data + i, 8);
+		uint64_t belowSpace = (word - ones * 0x20) & ~word;
+		uint64_t atLeastDel = word + ones * 0x01;
+		if (((belowSpace | atLeastDel | word) & highs) != 0) break;
+	}
+#endif
+
+	while (i < size && data[i] >= 0x20 && data[i] < 0x7F)
+		i++;
+	return i;
+}
+
+size_t DisplayText::decode(std::string_view text, size_t i, char32_t& ch) {
+	unsigned char lead = text[i];
+	if (lead < 0x80) {
+		ch = lead;
+		return 1;
+	}
+
+	size_t length;
+	char32_t smallest;
+	if (lead >= 0xC2 && lead <= 0xDF) {
+		length = 2;
+		smallest = 0x80;
+		ch = lead & 0x1F;
+	} else if (lead >= 0xE0 && lead <= 0xEF) {
+		length = 3;
+		smallest = 0x800;
+		ch = lead & 0x0F;
+	} else if (lead >= 0xF0 && lead <= 0xF4) {
+		length = 4;
+		smallest = 0x10000;
+		ch = lead & 0x07;
+	} else {
+		ch = replacement;
+		return 1;
+	}
+
+	if (i + length > text.size()) {
+		ch = replacement;
+		return 1;
+	}
+	for (size_t k = 1; k < length; ++k) {
+		unsigned char byte = text[i + k];
+		if ((byte & 0xC0) != 0x80) {
+			ch = replacement;
+			return 1;
+		}
+		ch = ch << 6 | (byte & 0x3F);
+	}
+
+	// Overlong forms, surrogates and code points past Unicode are invalid too
+	if (ch < smallest || ch > 0x10FFFF || (ch >= 0xD800 && ch <= 0xDFFF)) {
+		ch = replacement;
+		return 1;
+	}
+	return length;
+}
+
+int DisplayText::charWidth(char32_t ch) {
+	if (ch >= 0x20 && ch < 0x7F) return 1;
+	if (ch >= cachedCodePoints) return measure(ch);
+
+	// Racing threads store the same bits, so relaxed ordering is enough
+	std::atomic<uint32_t>& word = widthCache[ch / 16];
+	unsigned shift = ch % 16 * 2;
+	uint32_t entry = (word.load(std::memory_order_relaxed) >> shift) & 3;
+	if (entry != 0) return entry - 1;
+
+	int width = measure(ch);
+	word.fetch_or(static_cast<uint32_t>(width + 1) << shift, std::memory_order_relaxed);
+	return width;
+}
+
+size_t DisplayText::nextSlow(std::string_view text, size_t i, int& columns) {
+	char32_t ch;
+	size_t length = decode(text, i, ch);
+	columns = charWidth(ch);
+	return length;
+}
+
+size_t DisplayText::width(std::string_view text) {
+	size_t columns = 0;
+	size_t i = 0;
+	while (i < text.size()) {
+		size_t run = asciiPrefix(text.substr(i));
+		columns += run;
+		i += run;
+		if (i == text.size()) break;
+
+		int charColumns;
+		i += nextSlow(text, i, charColumns);
+		columns += charColumns;
+	}
+	return columns;
+}
+
+size_t DisplayText::fit(std::string_view text, size_t columns) {
+	size_t i = std::min(asciiPrefix(text), columns);
+	size_t used = i;
+	while (i < text.size()) {
+		int charColumns;
+		size_t length = next(text, i, charColumns);
+		if (used + charColumns > columns) break;
+		used += charColumns;
+		i += length;
+	}
+	return i;
+}
+
+bool DisplayText::isClean(std::string_view text) {
+	size_t i = 0;
+	while (i < text.size()) {
+		i += asciiPrefix(text.substr(i));
+		if (i == text.size()) break;
+		if (static_cast<unsigned char>(text[i]) < 0x80) return false; // Control character
+
+		char32_t ch;
+		size_t length = decode(text, i, ch);
+		if ((ch == replacement && length == 1) || (ch >= 0x80 && ch <= 0x9F) || isBidiControl(ch)) return false;
+		i += length;
+	}
+	return true;
+}
+
+std::string_view DisplayText::sanitize(std::string_view text, std::string& buffer) {
+	// Nothing is copied until something has to change
+	size_t i = asciiPrefix(text);
+	if (i == text.size()) return text;
+
+	bool changed = false;
+	size_t cleanFrom = 0; // Start of the run of text waiting to be copied unchanged
+	while (i < text.size()) {
+		unsigned char c = text[i];
+		size_t end = i + 1;
+		char32_t substitute = 0; // Nothing
+
+		if (c >= 0x20 && c < 0x7F) {
+			i += asciiPrefix(text.substr(i));
+			continue;
+		} else if (c >= 0x80) {
+			char32_t ch;
+			size_t length = decode(text, i, ch);
+			end = i + length;
+			if (ch == replacement && length == 1) {
+				substitute = replacement;
+			} else if (ch >= 0x80 && ch <= 0x9F) {
+				// C1 controls; the 8-bit CSI, OSC... introduce a whole sequence
+				end = skipSequence(text, end, static_cast<char>(ch - 0x40));
+			} else if (!isBidiControl(ch)) {
+				i = end;
+				continue;
+			}
+		} else if (c == 0x1B) {
+			end = skipEscape(text, i);
+		} else if (c == '\t' || c == '\n' || c == '\r') {
+			if (c == '\r' && end < text.size() && text[end] == '\n') end++;
+			substitute = ' ';
+		} else {
+			substitute = c == 0x7F ? 0x2421 : 0x2400 + c; // Control pictures: NUL is U+2400...
+		}
+
+		if (!changed) buffer.clear();
+		buffer.append(text.data() + cleanFrom, i - cleanFrom);
+		if (substitute != 0) appendUtf8(buffer, substitute);
+		i = cleanFrom = end;
+		changed = true;
+	}
+
+	if (!changed) return text;
+	buffer.append(text.data() + cleanFrom, text.size() - cleanFrom);
+	return buffer;
+}
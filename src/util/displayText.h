@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Text from the network made safe for the terminal, and measured in screen columns.
+// Printable ASCII, by far the common case, is scanned 16 bytes at a time; widths of other
+// characters come from wcwidth() once per code point and are cached.
+class DisplayText {
+  public:
+	// Text with escape sequences removed, other control characters shown as symbols (U+2400...),
+	// tabs and line breaks turned into spaces and invalid UTF-8 replaced by U+FFFD.
+	// Returns text itself when nothing needed changing, otherwise a view of buffer.
+	static std::string_view sanitize(std::string_view text, std::string& buffer);
+
+	// Sanitizing would leave text as it is
+	static bool isClean(std::string_view text);
+
+	// Screen columns of text
+	static size_t width(std::string_view text);
+
+	// Bytes at the start of text that fit in columns screen columns
+	static size_t fit(std::string_view text, size_t columns);
+
+	// Length in bytes of the character at text[i], and its width in columns
+	static size_t next(std::string_view text, size_t i, int& columns) {
+		unsigned char c = text[i];
+		if (c >= 0x20 && c < 0x7F) {
+			columns = 1;
+			return 1;
+		}
+		return nextSlow(text, i, columns);
+	}
+
+	// Decode the character at text[i]: its length in bytes, or 1 with U+FFFD for an invalid byte
+	static size_t decode(std::string_view text, size_t i, char32_t& ch);
+
+	// Columns of a code point; unprintable ones take one, as the replacement glyph shown for them
+	static int charWidth(char32_t ch);
+
+	// Leading bytes of text that are printable ASCII
+	static size_t asciiPrefix(std::string_view text);
+
+	// Append the UTF-8 encoding of a code point
+	static void appendUtf8(std::string& out, char32_t ch);
+
+  private:
+	static size_t nextSlow(std::string_view text, size_t i, int& columns);
+};
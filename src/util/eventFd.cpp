@@ -0,0 +1,30 @@
+#include "eventFd.h"
+#include <cstdint>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+EventFd::EventFd()
+  : eventFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+  , pending(false) {
+	if (eventFd < 0) throw std::runtime_error("Failed to create eventfd");
+}
+
+EventFd::~EventFd() {
+	close(eventFd);
+}
+
+void EventFd::notify() {
+	if (pending.exchange(true)) return;
+
+	uint64_t one = 1;
+	ssize_t written = write(eventFd, &one, sizeof(one));
+	(void)written; // Only fails if the counter would overflow, which still leaves it readable
+}
+
+void EventFd::clear() {
+	uint64_t value;
+	ssize_t bytes = read(eventFd, &value, sizeof(value));
+	(void)bytes; // EAGAIN just means nothing was pending
+	pending.store(false);
+}
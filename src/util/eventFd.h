@@ -0,0 +1,26 @@
+#pragma once
+
+#include <atomic>
+
+// Wakeup descriptor for poll(): any thread may notify, the polling thread clears.
+// Repeated notifications before clear() cost a single write.
+class EventFd {
+  public:
+	EventFd();
+	~EventFd();
+
+	EventFd(const EventFd&) = delete;
+	EventFd& operator=(const EventFd&) = delete;
+
+	// Make the descriptor readable (thread-safe)
+	void notify();
+
+	// Reset the descriptor; call before consuming the data it signals
+	void clear();
+
+	int fd() const { return eventFd; }
+
+  private:
+	int eventFd;
+	std::atomic<bool> pending;
+};
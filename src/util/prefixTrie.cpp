@@ -0,0 +1,121 @@
+#include "prefixTrie.h"
+
+uint32_t PrefixTrie::child(uint32_t node, unsigned char byte) const {
+	for (uint32_t next = nodes[node].firstChild; next != none; next = nodes[next].nextSibling) {
+		if (nodes[next].byte == byte) return next;
+		if (nodes[next].byte > byte) break;
+	}
+	return none;
+}
+
+uint32_t PrefixTrie::locate(std::string_view prefix) const {
+	if (nodes.empty()) return none;
+	uint32_t node = 0;
+	for (size_t i = 0; i < prefix.size() && node != none; ++i)
+		node = child(node, prefix[i]);
+	return node;
+}
+
+uint32_t PrefixTrie::addChild(uint32_t node, unsigned char byte) {
+	// Find the sibling to link after, keeping byte order
+	uint32_t previous = none;
+	uint32_t next = nodes[node].firstChild;
+	while (next != none && nodes[next].byte < byte) {
+		previous = next;
+		next = nodes[next].nextSibling;
+	}
+	if (next != none && nodes[next].byte == byte) return next;
+
+	uint32_t added;
+	if (!freeNodes.empty()) {
+		added = freeNodes.back();
+		freeNodes.pop_back();
+		nodes[added] = Node();
+	} else {
+		added = static_cast<uint32_t>(nodes.size());
+		nodes.emplace_back();
+	}
+	nodes[added].byte = byte;
+	nodes[added].nextSibling = next;
+	if (previous == none)
+		nodes[node].firstChild = added;
+	else
+		nodes[previous].nextSibling = added;
+	return added;
+}
+
+void PrefixTrie::insert(std::string_view word, uint32_t value) {
+	if (nodes.empty()) nodes.emplace_back();
+	bool added = find(word) == none;
+
+	uint32_t node = 0;
+	if (added) nodes[0].words++;
+	for (char c : word) {
+		node = addChild(node, c);
+		if (added) nodes[node].words++;
+	}
+	nodes[node].value = value;
+}
+
+bool PrefixTrie::erase(std::string_view word) {
+	if (find(word) == none) return false;
+
+	// Nodes left without words are unlinked, along with the rest of the path below them
+	uint32_t node = 0;
+	nodes[0].words--;
+	for (char c : word) {
+		uint32_t parent = node;
+		node = child(parent, c);
+		if (--nodes[node].words > 0) continue;
+
+		if (nodes[parent].firstChild == node) {
+			nodes[parent].firstChild = nodes[node].nextSibling;
+		} else {
+			uint32_t previous = nodes[parent].firstChild;
+			while (nodes[previous].nextSibling != node)
+				previous = nodes[previous].nextSibling;
+			nodes[previous].nextSibling = nodes[node].nextSibling;
+		}
+		for (; node != none; node = nodes[node].firstChild)
+			freeNodes.push_back(node);
+		return true;
+	}
+	nodes[node].value = none;
+	return true;
+}
+
+uint32_t PrefixTrie::find(std::string_view word) const {
+	uint32_t node = locate(word);
+	return node == none ? none : nodes[node].value;
+}
+
+size_t PrefixTrie::count(std::string_view prefix) const {
+	uint32_t node = locate(prefix);
+	return node == none ? 0 : nodes[node].words;
+}
+
+bool PrefixTrie::nth(std::string_view prefix, size_t index, std::string& word) const {
+	uint32_t node = locate(prefix);
+	if (node == none || index >= nodes[node].words) return false;
+
+	// Skip whole subtrees until the one holding the word
+	word.assign(prefix);
+	while (true) {
+		if (nodes[node].value != none) {
+			if (index == 0) return true;
+			index--;
+		}
+		uint32_t next = nodes[node].firstChild;
+		while (index >= nodes[next].words) {
+			index -= nodes[next].words;
+			next = nodes[next].nextSibling;
+		}
+		word += static_cast<char>(nodes[next].byte);
+		node = next;
+	}
+}
+
+void PrefixTrie::clear() {
+	nodes.clear();
+	freeNodes.clear();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Set of strings, each with a value, looked up exactly or by prefix. Every node counts the
+// words at or below it, so the n-th word with a prefix (in byte order) is reached by walking a
+// single path, without listing the others. Nodes freed by erase() are reused by insert().
+class PrefixTrie {
+  public:
+	static constexpr uint32_t none = UINT32_MAX;
+
+	// Add word, or give it a new value if it is already there (value must not be none)
+	void insert(std::string_view word, uint32_t value = 0);
+
+	// Remove word; false if it was not there
+	bool erase(std::string_view word);
+
+	// Value of word, none if absent
+	uint32_t find(std::string_view word) const;
+
+	// Words starting with prefix
+	size_t count(std::string_view prefix) const;
+
+	// The index-th word (in byte order) starting with prefix; false past the last
+	bool nth(std::string_view prefix, size_t index, std::string& word) const;
+
+	size_t size() const { return nodes.empty() ? 0 : nodes[0].words; }
+	void clear();
+
+  private:
+	struct Node {
+		uint32_t firstChild = none; // Children are linked in byte order
+		uint32_t nextSibling = none;
+		uint32_t words = 0;    // Words ending here or below
+		uint32_t value = none; // none unless a word ends here
+		unsigned char byte = 0;
+	};
+
+	std::vector<Node> nodes; // nodes[0] is the root, the empty prefix
+	std::vector<uint32_t> freeNodes;
+
+	uint32_t child(uint32_t node, unsigned char byte) const;
+	uint32_t locate(std::string_view prefix) const; // none if no word has the prefix
+	uint32_t addChild(uint32_t node, unsigned char byte);
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+// What push() does when the ring is full
+enum class OverflowPolicy {
+	DropNewest, // Reject the new item and count it as dropped
+	Block       // Yield until the consumer frees a slot or the ring is closed
+};
+
+// Bounded lock-free ring for exactly one producer thread and one consumer thread.
+// Capacity is rounded up to a power of two.
+template <typename T>
+class SpscRing {
+  public:
+	explicit SpscRing(size_t capacity, OverflowPolicy policy = OverflowPolicy::DropNewest)
+	  : slots(std::make_unique<T[]>(roundUp(capacity)))
+	  , mask(roundUp(capacity) - 1)
+	  , policy(policy) {}
+
+	SpscRing(const SpscRing&) = delete;
+	SpscRing& operator=(const SpscRing&) = delete;
+
+	// Producer side, in place: fill the returned slot, then commitPush(). Returns nullptr if the
+	// item has to be dropped. An uncommitted slot is simply reused by the next beginPush().
+	T* beginPush() {
+		size_t t = tail.load(std::memory_order_relaxed);
+		while (t - head.load(std::memory_order_acquire) > mask) {
+			if (policy == OverflowPolicy::DropNewest || closed.load(std::memory_order_relaxed)) {
+				droppedCount.fetch_add(1, std::memory_order_relaxed);
+				return nullptr;
+			}
+			std::this_thread::yield();
+		}
+		return &slots[t & mask];
+	}
+
+	void commitPush() {
+		size_t t = tail.load(std::memory_order_relaxed) + 1;
+		tail.store(t, std::memory_order_release);
+
+		size_t depth = t - head.load(std::memory_order_relaxed);
+		if (depth > highWaterMark.load(std::memory_order_relaxed))
+			highWaterMark.store(depth, std::memory_order_relaxed);
+	}
+
+	// Producer side. Returns false if the item was dropped.
+	bool push(T&& item) {
+		T* slot = beginPush();
+		if (!slot) return false;
+
+		*slot = std::move(item);
+		commitPush();
+		return true;
+	}
+
+	// Consumer side, in place: read front(), then popFront(). Returns nullptr if the ring is empty.
+	// The slot keeps its contents (and capacity) for the producer to overwrite.
+	T* front() {
+		size_t h = head.load(std::memory_order_relaxed);
+		if (h == tail.load(std::memory_order_acquire)) return nullptr;
+		return &slots[h & mask];
+	}
+
+	void popFront(size_t count = 1) {
+		head.store(head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+	}
+
+	// Consumer side, batched: items ready now, and the i-th of them (0 = front) for i < available().
+	// Lets the consumer look ahead through a batch before popping all of it with popFront(count).
+	size_t available() const {
+		return tail.load(std::memory_order_acquire) - head.load(std::memory_order_relaxed);
+	}
+	T* peek(size_t i) { return &slots[(head.load(std::memory_order_relaxed) + i) & mask]; }
+
+	// Consumer side. Returns false if the ring is empty.
+	bool pop(T& out) {
+		T* slot = front();
+		if (!slot) return false;
+
+		out = std::move(*slot);
+		popFront();
+		return true;
+	}
+
+	// Wake a producer stuck in Block mode; further overflowing pushes are dropped
+	void close() { closed.store(true, std::memory_order_relaxed); }
+
+	// Counters (safe to read from any thread, approximate while in flight)
+	size_t depth() const {
+		size_t h = head.load(std::memory_order_acquire); // Read head first so tail >= head
+		return tail.load(std::memory_order_acquire) - h;
+	}
+	size_t capacity() const { return mask + 1; }
+	size_t highWater() const { return highWaterMark.load(std::memory_order_relaxed); }
+	uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+	OverflowPolicy overflowPolicy() const { return policy; }
+
+  private:
+	static size_t roundUp(size_t n) {
+		size_t size = 2;
+		while (size < n)
+			size <<= 1;
+		return size;
+	}
+
+	std::unique_ptr<T[]> slots;
+	const size_t mask;
+	const OverflowPolicy policy;
+
+	// Keep producer and consumer indices on separate cache lines
+	alignas(64) std::atomic<size_t> head{ 0 };
+	alignas(64) std::atomic<size_t> tail{ 0 };
+	alignas(64) std::atomic<size_t> highWaterMark{ 0 };
+	std::atomic<uint64_t> droppedCount{ 0 };
+	std::atomic<bool> closed{ false };
+};
@@ -0,0 +1,34 @@
+#include "stringArena.h"
+#include <cstring>
+
+StringArena::StringArena(size_t chunkSize)
+  : chunkSize(chunkSize)
+  , cursor(nullptr)
+  , remaining(0)
+  , used(0)
+  , reserved(0) {}
+
+std::string_view StringArena::store(std::string_view value) {
+	if (value.empty()) return std::string_view();
+
+	if (value.size() > remaining) {
+		// Oversized strings get a chunk of their own; the current chunk stays open for small ones
+		size_t size = value.size() > chunkSize / 4 ? value.size() : chunkSize;
+		chunks.push_back(std::make_unique<char[]>(size));
+		reserved += size;
+		if (size == value.size()) {
+			std::memcpy(chunks.back().get(), value.data(), value.size());
+			used += value.size();
+			return std::string_view(chunks.back().get(), value.size());
+		}
+		cursor = chunks.back().get();
+		remaining = size;
+	}
+
+	std::memcpy(cursor, value.data(), value.size());
+	std::string_view stored(cursor, value.size());
+	cursor += value.size();
+	remaining -= value.size();
+	used += value.size();
+	return stored;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Append-only storage for many small strings. Strings are copied into large chunks, so a stored
+// string costs no allocation of its own and its view stays valid for the arena's lifetime.
+class StringArena {
+  public:
+	explicit StringArena(size_t chunkSize = 64 * 1024);
+
+	StringArena(StringArena&&) = default;
+	StringArena& operator=(StringArena&&) = default;
+
+	std::string_view store(std::string_view value);
+
+	size_t bytesUsed() const { return used; }
+	size_t bytesReserved() const { return reserved; }
+
+  private:
+	size_t chunkSize;
+	std::vector<std::unique_ptr<char[]>> chunks;
+	char* cursor;
+	size_t remaining;
+	size_t used;
+	size_t reserved;
+};
@@ -0,0 +1,19 @@
+#include "stringInterner.h"
+
+uint32_t StringInterner::intern(std::string_view value) {
+	auto it = ids.find(value);
+	if (it != ids.end()) return it->second;
+
+	uint32_t id = static_cast<uint32_t>(strings.size());
+	std::string_view stored = arena.store(value);
+	strings.push_back(stored);
+	ids.emplace(stored, id);
+	return id;
+}
+
+bool StringInterner::find(std::string_view value, uint32_t& id) const {
+	auto it = ids.find(value);
+	if (it == ids.end()) return false;
+	id = it->second;
+	return true;
+}
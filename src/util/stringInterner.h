@@ -0,0 +1,22 @@
+#pragma once
+
+#include "stringArena.h"
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Maps each distinct string to a small id, storing it once
+class StringInterner {
+  public:
+	uint32_t intern(std::string_view value);
+	bool find(std::string_view value, uint32_t& id) const;
+	std::string_view lookup(uint32_t id) const { return strings[id]; }
+	size_t size() const { return strings.size(); }
+	size_t bytesReserved() const { return arena.bytesReserved(); }
+
+  private:
+	StringArena arena{ 4096 };
+	std::vector<std::string_view> strings;
+	std::unordered_map<std::string_view, uint32_t> ids; // Keys point into arena
+};